@@ -244,15 +244,16 @@ bool SoundEngine::Internal_LoadSoundFromPack(const std::string& name)
 	if (m_Files.find(name) == m_Files.end())
 	{
 		TPackFile soundFile;
-		if (!CPackManager::Instance().GetFile(name, soundFile))
+		TPackFileView soundView;
+		if (!CPackManager::Instance().GetFileView(name, soundView, soundFile))
 		{
 			TraceError("Internal_LoadSoundFromPack: SoundEngine: Failed to register file '%s' - not found.", name.c_str());
 			return false;
 		}
 
 		auto& buffer = m_Files[name];
-		buffer.resize(soundFile.size());
-		memcpy(buffer.data(), soundFile.data(), soundFile.size());
+		buffer.resize(soundView.size());
+		memcpy(buffer.data(), soundView.data(), soundView.size());
 	}
 	return true;
 }
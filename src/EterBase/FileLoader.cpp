@@ -1,6 +1,11 @@
 #include "StdAfx.h"
 #include "FileLoader.h"
 #include <assert.h>
+#include <bit>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 CMemoryTextFileLoader::CMemoryTextFileLoader()
 {
@@ -10,173 +15,195 @@ CMemoryTextFileLoader::~CMemoryTextFileLoader()
 {
 }
 
-bool CMemoryTextFileLoader::SplitLineByTab(DWORD dwLine, CTokenVector* pstTokenVector)
+// first '\r' or '\n' in [begin, end), 16 bytes per step where SSE2 is available
+static const char * FindLineBreak(const char * c_pcBegin, const char * c_pcEnd)
 {
-	pstTokenVector->reserve(10);
-	pstTokenVector->clear();
+	const char * pc = c_pcBegin;
 
-	const std::string & c_rstLine = GetLineString(dwLine);
-	const int c_iLineLength = c_rstLine.length();
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+	const __m128i c_kLF = _mm_set1_epi8('\n');
+	const __m128i c_kCR = _mm_set1_epi8('\r');
 
-	if (0 == c_iLineLength)
-		return false;
+	for (; c_pcEnd - pc >= 16; pc += 16)
+	{
+		__m128i kChunk = _mm_loadu_si128((const __m128i *) pc);
+		int iMask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(kChunk, c_kLF), _mm_cmpeq_epi8(kChunk, c_kCR)));
 
-	int basePos = 0;
+		if (iMask)
+			return pc + std::countr_zero((unsigned int) iMask);
+	}
+#endif
+
+	for (; pc < c_pcEnd; ++pc)
+	{
+		if ('\n' == *pc || '\r' == *pc)
+			return pc;
+	}
+
+	return c_pcEnd;
+}
+
+void CMemoryTextFileLoader::__SplitTokensByTab(std::string_view stLine, CTokenViewVector * pstTokenVector)
+{
+	pstTokenVector->clear();
+
+	const size_t c_uLineLength = stLine.length();
+	size_t basePos = 0;
 
 	do
 	{
-		int beginPos = c_rstLine.find_first_of("\t", basePos);
+		size_t beginPos = stLine.find('\t', basePos);
 
-		pstTokenVector->push_back(c_rstLine.substr(basePos, beginPos-basePos));
+		pstTokenVector->push_back(stLine.substr(basePos, beginPos - basePos));
 
-		basePos = beginPos+1;
-	} while (basePos < c_iLineLength && basePos > 0);
+		if (std::string_view::npos == beginPos)
+			break;
 
-	return true;
+		basePos = beginPos + 1;
+	} while (basePos < c_uLineLength);
 }
 
-int CMemoryTextFileLoader::SplitLine2(DWORD dwLine, CTokenVector* pstTokenVector, const char * c_szDelimeter)
+int CMemoryTextFileLoader::__SplitTokens(std::string_view stLine, CTokenViewVector * pstTokenVector, const char * c_szDelimeter)
 {
-	pstTokenVector->reserve(10);
 	pstTokenVector->clear();
 
-	std::string stToken;
-	const std::string & c_rstLine = GetLineString(dwLine);
-
-	DWORD basePos = 0;
+	size_t basePos = 0;
 
 	do
 	{
-		int beginPos = c_rstLine.find_first_not_of(c_szDelimeter, basePos);
+		size_t beginPos = stLine.find_first_not_of(c_szDelimeter, basePos);
 
-		if (beginPos < 0)
+		if (std::string_view::npos == beginPos)
 			return -1;
 
-		int endPos;
+		size_t endPos;
 
-		if (c_rstLine[beginPos] == '"')
+		if (stLine[beginPos] == '"')
 		{
 			++beginPos;
-			endPos = c_rstLine.find_first_of("\"", beginPos);
+			endPos = stLine.find('"', beginPos);
 
-			if (endPos < 0)
+			if (std::string_view::npos == endPos)
 				return -2;
 
 			basePos = endPos + 1;
 		}
 		else
 		{
-			endPos = c_rstLine.find_first_of(c_szDelimeter, beginPos);
+			endPos = stLine.find_first_of(c_szDelimeter, beginPos);
 			basePos = endPos;
 		}
 
-		pstTokenVector->push_back(c_rstLine.substr(beginPos, endPos - beginPos));
+		pstTokenVector->push_back(stLine.substr(beginPos, endPos - beginPos));
 
 		// 추가 코드. 맨뒤에 탭이 있는 경우를 체크한다. - [levites]
-		if (int(c_rstLine.find_first_not_of(c_szDelimeter, basePos)) < 0)
+		if (std::string_view::npos == stLine.find_first_not_of(c_szDelimeter, basePos))
 			break;
-	} while (basePos < c_rstLine.length());
+	} while (basePos < stLine.length());
 
 	return 0;
 }
 
-bool CMemoryTextFileLoader::SplitLine(DWORD dwLine, CTokenVector* pstTokenVector, const char * c_szDelimeter)
+void CMemoryTextFileLoader::__CopyTokens(const CTokenViewVector & c_rkVct_stToken, CTokenVector * pstTokenVector)
 {
 	pstTokenVector->reserve(10);
 	pstTokenVector->clear();
 
-	std::string stToken;
-	const std::string & c_rstLine = GetLineString(dwLine);
+	for (std::string_view stToken : c_rkVct_stToken)
+		pstTokenVector->emplace_back(stToken);
+}
 
-	DWORD basePos = 0;
+bool CMemoryTextFileLoader::SplitLineByTab(DWORD dwLine, CTokenViewVector* pstTokenVector)
+{
+	pstTokenVector->clear();
 
-	do
-	{
-		int beginPos = c_rstLine.find_first_not_of(c_szDelimeter, basePos);
-		if (beginPos < 0)
-			return false;
+	std::string_view stLine = GetLineView(dwLine);
+	if (stLine.empty())
+		return false;
 
-		int endPos;
+	__SplitTokensByTab(stLine, pstTokenVector);
+	return true;
+}
 
-		if (c_rstLine[beginPos] == '"')
-		{
-			++beginPos;
-			endPos = c_rstLine.find_first_of("\"", beginPos);
+int CMemoryTextFileLoader::SplitLine2(DWORD dwLine, CTokenViewVector* pstTokenVector, const char * c_szDelimeter)
+{
+	return __SplitTokens(GetLineView(dwLine), pstTokenVector, c_szDelimeter);
+}
 
-			if (endPos < 0)
-				return false;
-			
-			basePos = endPos + 1;
-		}
-		else
-		{
-			endPos = c_rstLine.find_first_of(c_szDelimeter, beginPos);
-			basePos = endPos;
-		}
+bool CMemoryTextFileLoader::SplitLine(DWORD dwLine, CTokenViewVector* pstTokenVector, const char * c_szDelimeter)
+{
+	return 0 == __SplitTokens(GetLineView(dwLine), pstTokenVector, c_szDelimeter);
+}
 
-		pstTokenVector->push_back(c_rstLine.substr(beginPos, endPos - beginPos));
+bool CMemoryTextFileLoader::SplitLineByTab(DWORD dwLine, CTokenVector* pstTokenVector)
+{
+	bool bRet = SplitLineByTab(dwLine, &m_kVct_stToken);
+	__CopyTokens(m_kVct_stToken, pstTokenVector);
+	return bRet;
+}
 
-		// 추가 코드. 맨뒤에 탭이 있는 경우를 체크한다. - [levites]
-		if (int(c_rstLine.find_first_not_of(c_szDelimeter, basePos)) < 0)
-			break;
-	} while (basePos < c_rstLine.length());
+int CMemoryTextFileLoader::SplitLine2(DWORD dwLine, CTokenVector* pstTokenVector, const char * c_szDelimeter)
+{
+	int iRet = SplitLine2(dwLine, &m_kVct_stToken, c_szDelimeter);
+	__CopyTokens(m_kVct_stToken, pstTokenVector);
+	return iRet;
+}
 
-	return true;
+bool CMemoryTextFileLoader::SplitLine(DWORD dwLine, CTokenVector* pstTokenVector, const char * c_szDelimeter)
+{
+	bool bRet = SplitLine(dwLine, &m_kVct_stToken, c_szDelimeter);
+	__CopyTokens(m_kVct_stToken, pstTokenVector);
+	return bRet;
 }
 
 DWORD CMemoryTextFileLoader::GetLineCount()
 {
-	return m_stLineVector.size();
+	return m_kVct_stLine.size();
 }
 
 bool CMemoryTextFileLoader::CheckLineIndex(DWORD dwLine)
 {
-	if (dwLine >= m_stLineVector.size())
+	if (dwLine >= m_kVct_stLine.size())
 		return false;
 
 	return true;
 }
 
-const std::string & CMemoryTextFileLoader::GetLineString(DWORD dwLine)
+std::string_view CMemoryTextFileLoader::GetLineView(DWORD dwLine)
 {
 	assert(CheckLineIndex(dwLine));
-	return m_stLineVector[dwLine];
+	return m_kVct_stLine[dwLine];
+}
+
+const std::string & CMemoryTextFileLoader::GetLineString(DWORD dwLine)
+{
+	m_stLine.assign(GetLineView(dwLine));
+	return m_stLine;
 }
 
 void CMemoryTextFileLoader::Bind(int bufSize, const void* c_pvBuf)
 {
-	m_stLineVector.reserve(128);
-	m_stLineVector.clear();
+	m_kVct_stLine.reserve(128);
+	m_kVct_stLine.clear();
 
-	const char * c_pcBuf = (const char *)c_pvBuf;
-	std::string stLine;
-	int pos = 0;
+	m_stBuffer.assign((const char *) c_pvBuf, bufSize);
 
-	while (pos < bufSize)
+	const char * c_pcEnd = m_stBuffer.data() + m_stBuffer.size();
+	const char * c_pcLine = m_stBuffer.data();
+
+	while (true)
 	{
-		const char c = c_pcBuf[pos++];
+		const char * c_pcBreak = FindLineBreak(c_pcLine, c_pcEnd);
+		m_kVct_stLine.push_back(std::string_view(c_pcLine, c_pcBreak - c_pcLine));
 
-		if ('\n' == c || '\r' == c)
-		{
-			if (pos < bufSize)
-				if ('\n' == c_pcBuf[pos] || '\r' == c_pcBuf[pos])
-					++pos;
+		if (c_pcBreak == c_pcEnd)
+			break;
 
-			m_stLineVector.push_back(stLine);
-			stLine = "";
-		}
-		else if (c < 0)
-		{
-			stLine.append(c_pcBuf + (pos-1), 2);
-			++pos;
-		}
-		else
-		{
-			stLine += c;
-		}
+		// any pair of line break characters ("\r\n", "\n\n", ...) counts as a single break
+		c_pcLine = c_pcBreak + 1;
+		if (c_pcLine < c_pcEnd && ('\n' == *c_pcLine || '\r' == *c_pcLine))
+			++c_pcLine;
 	}
-
-	m_stLineVector.push_back(stLine);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////
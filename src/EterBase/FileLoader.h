@@ -14,16 +14,33 @@ class CMemoryTextFileLoader
 		CMemoryTextFileLoader();
 		virtual ~CMemoryTextFileLoader();
 
+		// Copies the text once and indexes its lines, lines and tokens are views into that copy.
 		void				Bind(int bufSize, const void* c_pvBuf);
 		DWORD				GetLineCount();
 		bool				CheckLineIndex(DWORD dwLine);
 		bool				SplitLine(DWORD dwLine, CTokenVector * pstTokenVector, const char * c_szDelimeter = " \t");
 		int					SplitLine2(DWORD dwLine, CTokenVector * pstTokenVector, const char * c_szDelimeter = " \t");
 		bool				SplitLineByTab(DWORD dwLine, CTokenVector* pstTokenVector);
+
+		// Same splitting without a string per token, the views stay valid until the next Bind.
+		bool				SplitLine(DWORD dwLine, CTokenViewVector * pstTokenVector, const char * c_szDelimeter = " \t");
+		int					SplitLine2(DWORD dwLine, CTokenViewVector * pstTokenVector, const char * c_szDelimeter = " \t");
+		bool				SplitLineByTab(DWORD dwLine, CTokenViewVector* pstTokenVector);
+
+		// The reference is only valid until the next GetLineString call.
 		const std::string &	GetLineString(DWORD dwLine);
+		std::string_view	GetLineView(DWORD dwLine);
+
+	protected:
+		static int			__SplitTokens(std::string_view stLine, CTokenViewVector * pstTokenVector, const char * c_szDelimeter);
+		static void			__SplitTokensByTab(std::string_view stLine, CTokenViewVector * pstTokenVector);
+		static void			__CopyTokens(const CTokenViewVector & c_rkVct_stToken, CTokenVector * pstTokenVector);
 
 	protected:
-		std::vector<std::string> m_stLineVector;
+		std::string			m_stBuffer;
+		CTokenViewVector	m_kVct_stLine;
+		CTokenViewVector	m_kVct_stToken;	// scratch for the CTokenVector overloads
+		std::string			m_stLine;		// backing store of GetLineString
 };
 
 class CMemoryFileLoader
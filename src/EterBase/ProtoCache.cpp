@@ -0,0 +1,245 @@
+#include "StdAfx.h"
+#include "ProtoCache.h"
+#include "CRC32.h"
+#include "Utils.h"
+#include "Debug.h"
+
+#include <filesystem>
+
+#include <hmac.h>
+#include <sha.h>
+#include <misc.h>
+#include <modes.h>
+#include <osrng.h>
+#include <camellia.h>
+
+static const DWORD c_dwProtoCacheFourCC = MAKEFOURCC('M', 'P', 'C', 'H');
+static const DWORD c_dwProtoCacheVersion = 3;
+
+CProtoCache::CProtoCache() : m_pbRows(NULL), m_dwCount(0), m_dwStride(0)
+{
+}
+
+CProtoCache::~CProtoCache()
+{
+	Destroy();
+}
+
+void CProtoCache::Destroy()
+{
+	m_vecRows.clear();
+	m_vecRows.shrink_to_fit();
+
+	m_pbRows = NULL;
+	m_dwCount = 0;
+	m_dwStride = 0;
+}
+
+bool CProtoCache::Load(const char * c_szSourceName, const void * c_pvSource, DWORD dwSourceSize, DWORD dwStride, const DWORD c_adwKey[4], const TDecodeFunction & c_rfnDecode)
+{
+	Destroy();
+
+	if (dwStride < sizeof(DWORD))
+		return false;
+
+	THeader kHeader;
+	memset(&kHeader, 0, sizeof(kHeader));
+	kHeader.dwFourCC = c_dwProtoCacheFourCC;
+	kHeader.dwVersion = c_dwProtoCacheVersion;
+	kHeader.dwSourceSize = dwSourceSize;
+	kHeader.dwSourceCRC = GetCRC32((const char *) c_pvSource, dwSourceSize);
+	kHeader.dwStride = dwStride;
+	kHeader.dwCount = 0;
+
+	std::string stCacheFileName = __GetCacheFileName(c_szSourceName);
+
+	if (__ReadCacheFile(stCacheFileName, kHeader, c_adwKey))
+		return true;
+
+	std::vector<BYTE> vecRows;
+	if (!c_rfnDecode((const BYTE *) c_pvSource, dwSourceSize, vecRows) || vecRows.size() % dwStride)
+		return false;
+
+	kHeader.dwCount = vecRows.size() / dwStride;
+
+	// stable, of the rows sharing a vnum the first stays first
+	std::vector<DWORD> vecOrder(kHeader.dwCount);
+	for (DWORD i = 0; i < kHeader.dwCount; ++i)
+		vecOrder[i] = i;
+
+	std::stable_sort(vecOrder.begin(), vecOrder.end(), [&vecRows, dwStride](DWORD a, DWORD b)
+	{
+		return __GetVnum(&vecRows[a * dwStride]) < __GetVnum(&vecRows[b * dwStride]);
+	});
+
+	m_vecRows.resize(vecRows.size());
+	for (DWORD i = 0; i < kHeader.dwCount; ++i)
+		memcpy(&m_vecRows[i * dwStride], &vecRows[vecOrder[i] * dwStride], dwStride);
+
+	m_pbRows = m_vecRows.data();
+	m_dwCount = kHeader.dwCount;
+	m_dwStride = dwStride;
+
+	// a cache file that can't be written only costs the next run the decode, this one has its rows
+	__WriteCacheFile(stCacheFileName, kHeader, c_adwKey, m_vecRows);
+	return true;
+}
+
+const void * CProtoCache::Find(DWORD dwVnum) const
+{
+	DWORD dwLow = 0;
+	DWORD dwHigh = m_dwCount;
+
+	while (dwLow < dwHigh)
+	{
+		DWORD dwMiddle = dwLow + (dwHigh - dwLow) / 2;
+
+		if (__GetVnum(m_pbRows + dwMiddle * m_dwStride) < dwVnum)
+			dwLow = dwMiddle + 1;
+		else
+			dwHigh = dwMiddle;
+	}
+
+	if (dwLow == m_dwCount || __GetVnum(m_pbRows + dwLow * m_dwStride) != dwVnum)
+		return NULL;
+
+	return m_pbRows + dwLow * m_dwStride;
+}
+
+std::string CProtoCache::__GetCacheFileName(const char * c_szSourceName)
+{
+	// locale/de/item_proto -> cache/locale_de_item_proto.bin
+	std::string stFileName = "cache/";
+
+	for (const char * pc = c_szSourceName; *pc; ++pc)
+		stFileName += ('/' == *pc || '\\' == *pc || ':' == *pc) ? '_' : *pc;
+
+	stFileName += ".bin";
+	return stFileName;
+}
+
+DWORD CProtoCache::__GetVnum(const BYTE * c_pbRow)
+{
+	DWORD dwVnum;
+	memcpy(&dwVnum, c_pbRow, sizeof(DWORD));
+	return dwVnum;
+}
+
+void CProtoCache::__DeriveKey(const DWORD c_adwKey[4], const char * c_szPurpose, BYTE * pbKey)
+{
+	CryptoPP::HMAC<CryptoPP::SHA256> kHMAC((const BYTE *) c_adwKey, sizeof(DWORD) * 4);
+	kHMAC.CalculateDigest(pbKey, (const BYTE *) c_szPurpose, strlen(c_szPurpose));
+}
+
+void CProtoCache::__Seal(const DWORD c_adwKey[4], const THeader & c_rkHeader, const BYTE * c_pbRows, BYTE * pbSeal)
+{
+	BYTE abyKey[CryptoPP::SHA256::DIGESTSIZE];
+	__DeriveKey(c_adwKey, "proto cache seal", abyKey);
+
+	CryptoPP::HMAC<CryptoPP::SHA256> kHMAC(abyKey, sizeof(abyKey));
+	kHMAC.Update((const BYTE *) &c_rkHeader, offsetof(THeader, abySeal));
+	kHMAC.Update(c_pbRows, (size_t) c_rkHeader.dwCount * c_rkHeader.dwStride);
+	kHMAC.Final(pbSeal);
+}
+
+void CProtoCache::__Crypt(const DWORD c_adwKey[4], const THeader & c_rkHeader, BYTE * pbRows)
+{
+	BYTE abyKey[CryptoPP::SHA256::DIGESTSIZE];
+	__DeriveKey(c_adwKey, "proto cache rows", abyKey);
+
+	CryptoPP::CTR_Mode<CryptoPP::Camellia>::Encryption kCipher;
+	kCipher.SetKeyWithIV(abyKey, sizeof(abyKey), c_rkHeader.abyIV, sizeof(c_rkHeader.abyIV));
+	kCipher.ProcessData(pbRows, pbRows, (size_t) c_rkHeader.dwCount * c_rkHeader.dwStride);
+}
+
+bool CProtoCache::__ReadCacheFile(const std::string & c_rstFileName, const THeader & c_rkHeader, const DWORD c_adwKey[4])
+{
+	FILE * fp = fopen(c_rstFileName.c_str(), "rb");
+	if (!fp)
+		return false;
+
+	std::error_code ec;
+	uint64_t ullFileSize = std::filesystem::file_size(c_rstFileName, ec);
+
+	THeader kHeader;
+	std::vector<BYTE> vecRows;
+
+	bool bRead = !ec && fread(&kHeader, sizeof(THeader), 1, fp) == 1;
+
+	// a different source (patched proto) or client (changed struct) leaves a stale file behind, it's replaced
+	if (bRead && (kHeader.dwFourCC != c_rkHeader.dwFourCC ||
+		kHeader.dwVersion != c_rkHeader.dwVersion ||
+		kHeader.dwSourceSize != c_rkHeader.dwSourceSize ||
+		kHeader.dwSourceCRC != c_rkHeader.dwSourceCRC ||
+		kHeader.dwStride != c_rkHeader.dwStride ||
+		ullFileSize != sizeof(THeader) + (uint64_t) kHeader.dwCount * kHeader.dwStride))
+		bRead = false;
+
+	if (bRead)
+	{
+		vecRows.resize((size_t) kHeader.dwCount * kHeader.dwStride);
+		bRead = vecRows.empty() || fread(vecRows.data(), vecRows.size(), 1, fp) == 1;
+	}
+
+	fclose(fp);
+
+	if (!bRead)
+		return false;
+
+	// the rows are used as they are, so a file edited on disk must not get through
+	BYTE abySeal[sizeof(kHeader.abySeal)];
+	__Seal(c_adwKey, kHeader, vecRows.data(), abySeal);
+
+	if (!CryptoPP::VerifyBufsEqual(abySeal, kHeader.abySeal, sizeof(abySeal)))
+	{
+		TraceError("CProtoCache: %s failed its integrity check, rebuilding it from the source", c_rstFileName.c_str());
+		return false;
+	}
+
+	__Crypt(c_adwKey, kHeader, vecRows.data());
+
+	m_vecRows = std::move(vecRows);
+	m_pbRows = m_vecRows.data();
+	m_dwCount = kHeader.dwCount;
+	m_dwStride = kHeader.dwStride;
+	return true;
+}
+
+bool CProtoCache::__WriteCacheFile(const std::string & c_rstFileName, THeader & rkHeader, const DWORD c_adwKey[4], const std::vector<BYTE> & c_rvecRows)
+{
+	MyCreateDirectory(c_rstFileName.c_str());
+
+	// encrypt-then-seal, the decrypted rows never reach the disk
+	CryptoPP::AutoSeededRandomPool kRandom;
+	kRandom.GenerateBlock(rkHeader.abyIV, sizeof(rkHeader.abyIV));
+
+	std::vector<BYTE> vecEncrypted(c_rvecRows);
+	__Crypt(c_adwKey, rkHeader, vecEncrypted.data());
+	__Seal(c_adwKey, rkHeader, vecEncrypted.data(), rkHeader.abySeal);
+
+	// written aside and moved over, a client killed halfway never leaves a torn cache file
+	std::string stTempFileName = c_rstFileName + ".tmp";
+
+	FILE * fp = fopen(stTempFileName.c_str(), "wb");
+	if (!fp)
+		return false;
+
+	bool bWritten = fwrite(&rkHeader, sizeof(THeader), 1, fp) == 1 &&
+		(vecEncrypted.empty() || fwrite(vecEncrypted.data(), vecEncrypted.size(), 1, fp) == 1);
+
+	if (fclose(fp) != 0)
+		bWritten = false;
+
+	std::error_code ec;
+	if (bWritten)
+		std::filesystem::rename(stTempFileName, c_rstFileName, ec);
+
+	if (!bWritten || ec)
+	{
+		TraceError("CProtoCache: cannot write %s", c_rstFileName.c_str());
+		std::filesystem::remove(stTempFileName, ec);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <windows.h>
+#include <vector>
+#include <functional>
+
+// Rows of a proto file (item_proto, mob_proto) in the form the client uses them: decompressed, of a fixed
+// stride and sorted by the vnum in their first DWORD. The first load writes them to a file under "cache/",
+// tagged with the size and CRC32 of the packed source and sealed with an HMAC keyed by the proto's key, so
+// an edited cache file is thrown away instead of trusted. Later loads of the same source map that file, check
+// the seal and hand the rows out in place, no decryption, no decompression and no copy.
+class CProtoCache
+{
+	public:
+		// Decodes the packed source into rows of the stride passed to Load, appended to rvecRows.
+		typedef std::function<bool (const BYTE * c_pbSource, DWORD dwSourceSize, std::vector<BYTE> & rvecRows)> TDecodeFunction;
+
+	public:
+		CProtoCache();
+		~CProtoCache();
+
+		void			Destroy();
+
+		// c_adwKey is the key the source is packed with, it also encrypts and seals the cache file
+		bool			Load(const char * c_szSourceName, const void * c_pvSource, DWORD dwSourceSize, DWORD dwStride, const DWORD c_adwKey[4], const TDecodeFunction & c_rfnDecode);
+
+		DWORD			GetCount() const	{ return m_dwCount;	}
+		const void *	GetRow(DWORD dwIndex) const	{ return m_pbRows + dwIndex * m_dwStride;	}
+		// binary search, the first of the rows with that vnum
+		const void *	Find(DWORD dwVnum) const;
+
+	protected:
+		#pragma pack(push, 4)
+		typedef struct SHeader
+		{
+			DWORD	dwFourCC;
+			DWORD	dwVersion;
+			DWORD	dwSourceSize;
+			DWORD	dwSourceCRC;
+			DWORD	dwStride;
+			DWORD	dwCount;
+			BYTE	abyIV[16];		// Camellia CTR, new for every write of the file
+			BYTE	abySeal[32];	// HMAC-SHA256 of the header up to here and the encrypted rows
+		} THeader;
+		#pragma pack(pop)
+
+		static std::string	__GetCacheFileName(const char * c_szSourceName);
+		static DWORD		__GetVnum(const BYTE * c_pbRow);
+		// c_szPurpose keeps the cipher and the seal key apart, neither is the proto key itself
+		static void			__DeriveKey(const DWORD c_adwKey[4], const char * c_szPurpose, BYTE * pbKey);
+		static void			__Seal(const DWORD c_adwKey[4], const THeader & c_rkHeader, const BYTE * c_pbRows, BYTE * pbSeal);
+		static void			__Crypt(const DWORD c_adwKey[4], const THeader & c_rkHeader, BYTE * pbRows);
+
+		bool			__ReadCacheFile(const std::string & c_rstFileName, const THeader & c_rkHeader, const DWORD c_adwKey[4]);
+		bool			__WriteCacheFile(const std::string & c_rstFileName, THeader & rkHeader, const DWORD c_adwKey[4], const std::vector<BYTE> & c_rvecRows);
+
+	protected:
+		std::vector<BYTE>	m_vecRows;
+		const BYTE *		m_pbRows;
+		DWORD				m_dwCount;
+		DWORD				m_dwStride;
+};
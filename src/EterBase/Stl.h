@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <stack>
 #include <deque>
@@ -346,6 +347,7 @@ class stl_circle_pool
 };
 
 typedef std::vector<std::string> CTokenVector;
+typedef std::vector<std::string_view> CTokenViewVector;	// tokens pointing into the text they were split from
 typedef std::map<std::string, std::string> CTokenMap;
 typedef std::map<std::string, CTokenVector> CTokenVectorMap;
 
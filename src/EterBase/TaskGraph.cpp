@@ -0,0 +1,315 @@
+#include "StdAfx.h"
+#include "TaskGraph.h"
+#include "Timer.h"
+#include "Debug.h"
+#include "TimeProfiler.h"
+
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+struct CTaskGraph::SRunState
+{
+	std::mutex				kMutex;
+	std::condition_variable	kCondition;
+
+	std::deque<DWORD>		kDeq_dwReady;			// any thread
+	std::deque<DWORD>		kDeq_dwReadyMain;		// the calling thread only
+	DWORD					dwRemainCount;
+};
+
+CTaskGraph::CTaskGraph() : m_pkRunState(NULL), m_ullRunStart(0), m_ullRunTime(0), m_uWorkerCount(0)
+{
+}
+
+CTaskGraph::~CTaskGraph()
+{
+}
+
+DWORD CTaskGraph::AddTask(const char * c_szName, const TTaskFunction & c_rfnTask, bool bMainThread)
+{
+	TTask kTask;
+	kTask.stName = c_szName;
+	kTask.fnTask = c_rfnTask;
+	kTask.bMainThread = bMainThread;
+	kTask.dwWaitCount = 0;
+	kTask.bDependencyFailed = false;
+	kTask.eState = STATE_WAITING;
+	kTask.ullBegin = 0;
+	kTask.ullEnd = 0;
+	kTask.uThread = 0;
+
+	m_kVct_kTask.push_back(kTask);
+	return m_kVct_kTask.size() - 1;
+}
+
+void CTaskGraph::AddDependency(DWORD dwTask, DWORD dwDependsOn)
+{
+	if (dwTask >= m_kVct_kTask.size() || dwDependsOn >= m_kVct_kTask.size())
+	{
+		TraceError("CTaskGraph::AddDependency(%u, %u) - no such task", dwTask, dwDependsOn);
+		return;
+	}
+
+	m_kVct_kTask[dwTask].kVct_dwDependency.push_back(dwDependsOn);
+	m_kVct_kTask[dwTask].dwWaitCount++;
+	m_kVct_kTask[dwDependsOn].kVct_dwDependent.push_back(dwTask);
+}
+
+bool CTaskGraph::__HasCycle() const
+{
+	std::vector<DWORD> kVct_dwWaitCount(m_kVct_kTask.size());
+	std::vector<DWORD> kVct_dwReady;
+
+	for (DWORD i = 0; i < m_kVct_kTask.size(); ++i)
+	{
+		kVct_dwWaitCount[i] = m_kVct_kTask[i].dwWaitCount;
+		if (!kVct_dwWaitCount[i])
+			kVct_dwReady.push_back(i);
+	}
+
+	DWORD dwVisitCount = 0;
+	while (!kVct_dwReady.empty())
+	{
+		DWORD dwTask = kVct_dwReady.back();
+		kVct_dwReady.pop_back();
+		++dwVisitCount;
+
+		for (DWORD dwDependent : m_kVct_kTask[dwTask].kVct_dwDependent)
+		{
+			if (!--kVct_dwWaitCount[dwDependent])
+				kVct_dwReady.push_back(dwDependent);
+		}
+	}
+
+	return dwVisitCount != m_kVct_kTask.size();
+}
+
+bool CTaskGraph::Run(UINT uWorkerCount)
+{
+	if (__HasCycle())
+	{
+		TraceError("CTaskGraph::Run - the dependencies form a cycle");
+		return false;
+	}
+
+	// more threads than tasks that may leave the calling thread would only sleep
+	UINT uFreeTaskCount = 0;
+	for (const TTask & c_rkTask : m_kVct_kTask)
+	{
+		if (!c_rkTask.bMainThread)
+			++uFreeTaskCount;
+	}
+
+	m_uWorkerCount = std::min(uWorkerCount, uFreeTaskCount);
+
+	SRunState kRunState;
+	kRunState.dwRemainCount = m_kVct_kTask.size();
+
+	for (DWORD i = 0; i < m_kVct_kTask.size(); ++i)
+	{
+		TTask & rkTask = m_kVct_kTask[i];
+		if (rkTask.dwWaitCount)
+			continue;
+
+		rkTask.eState = STATE_READY;
+		(rkTask.bMainThread ? kRunState.kDeq_dwReadyMain : kRunState.kDeq_dwReady).push_back(i);
+	}
+
+	m_pkRunState = &kRunState;
+	m_ullRunStart = ELTimer_GetUSec();
+
+	std::vector<std::thread> kVct_kWorker;
+	for (UINT i = 1; i <= m_uWorkerCount; ++i)
+		kVct_kWorker.emplace_back(&CTaskGraph::__WorkerLoop, this, i);
+
+	__WorkerLoop(0);
+
+	for (std::thread & rkWorker : kVct_kWorker)
+		rkWorker.join();
+
+	m_ullRunTime = ELTimer_GetUSec() - m_ullRunStart;
+	m_pkRunState = NULL;
+
+	for (const TTask & c_rkTask : m_kVct_kTask)
+	{
+		if (STATE_DONE != c_rkTask.eState)
+			return false;
+	}
+
+	return true;
+}
+
+bool CTaskGraph::__PopReadyTask(UINT uThread, DWORD * pdwTask)
+{
+	SRunState & rkRunState = *m_pkRunState;
+
+	// the calling thread prefers its own tasks, nobody else can take them
+	if (0 == uThread && !rkRunState.kDeq_dwReadyMain.empty())
+	{
+		*pdwTask = rkRunState.kDeq_dwReadyMain.front();
+		rkRunState.kDeq_dwReadyMain.pop_front();
+		return true;
+	}
+
+	if (!rkRunState.kDeq_dwReady.empty())
+	{
+		*pdwTask = rkRunState.kDeq_dwReady.front();
+		rkRunState.kDeq_dwReady.pop_front();
+		return true;
+	}
+
+	return false;
+}
+
+void CTaskGraph::__WorkerLoop(UINT uThread)
+{
+	SRunState & rkRunState = *m_pkRunState;
+
+	if (uThread)
+	{
+		char szThreadName[32];
+		_snprintf(szThreadName, sizeof(szThreadName), "CTaskGraph worker %u", uThread);
+		CTimeProfiler::SetThreadName(szThreadName);
+	}
+
+	while (true)
+	{
+		DWORD dwTask;
+
+		{
+			std::unique_lock<std::mutex> kLock(rkRunState.kMutex);
+			rkRunState.kCondition.wait(kLock, [&]()
+			{
+				return !rkRunState.dwRemainCount || __PopReadyTask(uThread, &dwTask);
+			});
+
+			if (!rkRunState.dwRemainCount)
+				return;
+
+			m_kVct_kTask[dwTask].eState = STATE_RUNNING;
+		}
+
+		TTask & rkTask = m_kVct_kTask[dwTask];
+		rkTask.uThread = uThread;
+		rkTask.ullBegin = ELTimer_GetUSec() - m_ullRunStart;
+
+		bool bSucceeded = false;
+		if (!rkTask.bDependencyFailed)
+		{
+			TIME_PROFILE_SCOPE(rkTask.stName.c_str());
+			bSucceeded = rkTask.fnTask();
+		}
+
+		rkTask.ullEnd = ELTimer_GetUSec() - m_ullRunStart;
+
+		__FinishTask(dwTask, bSucceeded);
+	}
+}
+
+void CTaskGraph::__FinishTask(DWORD dwTask, bool bSucceeded)
+{
+	SRunState & rkRunState = *m_pkRunState;
+
+	{
+		std::lock_guard<std::mutex> kLock(rkRunState.kMutex);
+
+		TTask & rkTask = m_kVct_kTask[dwTask];
+		if (rkTask.bDependencyFailed)
+			rkTask.eState = STATE_SKIPPED;
+		else
+			rkTask.eState = bSucceeded ? STATE_DONE : STATE_FAILED;
+
+		for (DWORD dwDependent : rkTask.kVct_dwDependent)
+		{
+			TTask & rkDependent = m_kVct_kTask[dwDependent];
+			if (STATE_DONE != rkTask.eState)
+				rkDependent.bDependencyFailed = true;
+
+			if (--rkDependent.dwWaitCount)
+				continue;
+
+			rkDependent.eState = STATE_READY;
+			(rkDependent.bMainThread ? rkRunState.kDeq_dwReadyMain : rkRunState.kDeq_dwReady).push_back(dwDependent);
+		}
+
+		--rkRunState.dwRemainCount;
+	}
+
+	rkRunState.kCondition.notify_all();
+}
+
+void CTaskGraph::TraceTimeline(const char * c_szTitle) const
+{
+	ULONGLONG ullWorkTime = 0;
+	for (const TTask & c_rkTask : m_kVct_kTask)
+		ullWorkTime += c_rkTask.ullEnd - c_rkTask.ullBegin;
+
+	Tracenf("%s: %u tasks on %u threads, %.1f ms wall, %.1f ms of work",
+		c_szTitle, (UINT) m_kVct_kTask.size(), m_uWorkerCount + 1, m_ullRunTime / 1000.0, ullWorkTime / 1000.0);
+
+	static const char * sc_aszState[] = { "waiting", "ready", "running", "done", "FAILED", "skipped" };
+
+	for (const TTask & c_rkTask : m_kVct_kTask)
+	{
+		Tracenf("  %-20s start %8.1f ms  took %8.1f ms  thread %u  %s",
+			c_rkTask.stName.c_str(), c_rkTask.ullBegin / 1000.0, (c_rkTask.ullEnd - c_rkTask.ullBegin) / 1000.0,
+			c_rkTask.uThread, sc_aszState[c_rkTask.eState]);
+	}
+
+	// the critical path is the dependency chain of the largest summed duration, only shortening
+	// one of its tasks can shorten the whole run
+	std::vector<DWORD> kVct_dwOrder;
+	std::vector<DWORD> kVct_dwWaitCount(m_kVct_kTask.size());
+
+	for (DWORD i = 0; i < m_kVct_kTask.size(); ++i)
+	{
+		kVct_dwWaitCount[i] = m_kVct_kTask[i].kVct_dwDependency.size();
+		if (!kVct_dwWaitCount[i])
+			kVct_dwOrder.push_back(i);
+	}
+
+	for (DWORD i = 0; i < kVct_dwOrder.size(); ++i)
+	{
+		for (DWORD dwDependent : m_kVct_kTask[kVct_dwOrder[i]].kVct_dwDependent)
+		{
+			if (!--kVct_dwWaitCount[dwDependent])
+				kVct_dwOrder.push_back(dwDependent);
+		}
+	}
+
+	if (kVct_dwOrder.size() != m_kVct_kTask.size())
+		return;
+
+	std::vector<ULONGLONG> kVct_ullPathTime(m_kVct_kTask.size(), 0);
+	std::vector<DWORD> kVct_dwPrevious(m_kVct_kTask.size(), (DWORD) -1);
+	DWORD dwLast = (DWORD) -1;
+
+	for (DWORD dwTask : kVct_dwOrder)
+	{
+		const TTask & c_rkTask = m_kVct_kTask[dwTask];
+
+		for (DWORD dwDependency : c_rkTask.kVct_dwDependency)
+		{
+			if (kVct_ullPathTime[dwDependency] >= kVct_ullPathTime[dwTask])
+			{
+				kVct_ullPathTime[dwTask] = kVct_ullPathTime[dwDependency];
+				kVct_dwPrevious[dwTask] = dwDependency;
+			}
+		}
+
+		kVct_ullPathTime[dwTask] += c_rkTask.ullEnd - c_rkTask.ullBegin;
+
+		if ((DWORD) -1 == dwLast || kVct_ullPathTime[dwTask] > kVct_ullPathTime[dwLast])
+			dwLast = dwTask;
+	}
+
+	if ((DWORD) -1 == dwLast)
+		return;
+
+	std::string stPath;
+	for (DWORD dwTask = dwLast; (DWORD) -1 != dwTask; dwTask = kVct_dwPrevious[dwTask])
+		stPath = m_kVct_kTask[dwTask].stName + (stPath.empty() ? "" : " > ") + stPath;
+
+	Tracenf("  critical path %.1f ms: %s", kVct_ullPathTime[dwLast] / 1000.0, stPath.c_str());
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <windows.h>
+#include <string>
+#include <vector>
+#include <functional>
+
+// A one-shot set of named tasks and the tasks each one waits for. Run executes every task once its dependencies
+// are done, independent ones side by side on a few worker threads. Tasks marked main thread only (anything
+// touching CResourceManager or Python) run on the thread calling Run, which works on the others meanwhile too.
+// The start and end of every task are kept, TraceTimeline prints them together with the critical path.
+class CTaskGraph
+{
+	public:
+		// false marks the task failed, the tasks depending on it are then skipped
+		typedef std::function<bool ()> TTaskFunction;
+
+	public:
+		CTaskGraph();
+		~CTaskGraph();
+
+		DWORD			AddTask(const char * c_szName, const TTaskFunction & c_rfnTask, bool bMainThread = false);
+		void			AddDependency(DWORD dwTask, DWORD dwDependsOn);
+
+		// uWorkerCount threads besides the calling one, false when a task failed or was skipped
+		bool			Run(UINT uWorkerCount);
+
+		void			TraceTimeline(const char * c_szTitle) const;
+
+	protected:
+		enum EState
+		{
+			STATE_WAITING,
+			STATE_READY,
+			STATE_RUNNING,
+			STATE_DONE,
+			STATE_FAILED,
+			STATE_SKIPPED,
+		};
+
+		typedef struct STask
+		{
+			std::string			stName;
+			TTaskFunction		fnTask;
+			bool				bMainThread;
+
+			std::vector<DWORD>	kVct_dwDependency;
+			std::vector<DWORD>	kVct_dwDependent;
+			DWORD				dwWaitCount;
+			bool				bDependencyFailed;
+
+			EState				eState;
+			ULONGLONG			ullBegin;		// us since Run started
+			ULONGLONG			ullEnd;
+			UINT				uThread;		// 0 is the calling thread
+		} TTask;
+
+		bool			__HasCycle() const;
+		void			__WorkerLoop(UINT uThread);
+		bool			__PopReadyTask(UINT uThread, DWORD * pdwTask);
+		void			__FinishTask(DWORD dwTask, bool bSucceeded);
+
+	protected:
+		std::vector<TTask>	m_kVct_kTask;
+
+		struct SRunState;
+		SRunState *			m_pkRunState;	// only while Run is executing
+
+		ULONGLONG			m_ullRunStart;
+		ULONGLONG			m_ullRunTime;
+		UINT				m_uWorkerCount;
+};
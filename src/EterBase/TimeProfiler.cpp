@@ -0,0 +1,251 @@
+#include "StdAfx.h"
+#include "TimeProfiler.h"
+#include "Timer.h"
+#include "Debug.h"
+#include "Utils.h"
+
+#include <mutex>
+#include <atomic>
+
+typedef struct SProfileSpan
+{
+	std::string	stName;
+	std::string	stDetail;
+	DWORD		dwThreadID;
+	UINT		uDepth;
+	ULONGLONG	ullBegin;	// us since Start
+	ULONGLONG	ullEnd;
+} TProfileSpan;
+
+struct SProfileState
+{
+	std::mutex									kMutex;
+	std::atomic<bool>							bRecording = false;
+	ULONGLONG									ullStart = 0;
+
+	std::vector<TProfileSpan>					kVct_kSpan;			// closed ones
+	std::map<DWORD, std::vector<TProfileSpan> >	kMap_kVct_kOpenSpan;	// per thread, innermost last
+	std::map<DWORD, std::string>				kMap_stThreadName;
+};
+
+// spans may be begun by static objects and threads of any library, the state can't depend on an instance
+static SProfileState & __GetProfileState()
+{
+	static SProfileState s_kState;
+	return s_kState;
+}
+
+void CTimeProfiler::Start()
+{
+	SProfileState & rkState = __GetProfileState();
+	std::lock_guard<std::mutex> kLock(rkState.kMutex);
+
+	rkState.kVct_kSpan.clear();
+	rkState.kMap_kVct_kOpenSpan.clear();
+	rkState.ullStart = ELTimer_GetUSec();
+	rkState.bRecording = true;
+}
+
+void CTimeProfiler::Stop()
+{
+	SProfileState & rkState = __GetProfileState();
+	std::lock_guard<std::mutex> kLock(rkState.kMutex);
+
+	if (!rkState.bRecording)
+		return;
+
+	rkState.bRecording = false;
+
+	ULONGLONG ullNow = ELTimer_GetUSec() - rkState.ullStart;
+
+	for (auto & rkPair : rkState.kMap_kVct_kOpenSpan)
+	{
+		for (TProfileSpan & rkSpan : rkPair.second)
+		{
+			rkSpan.ullEnd = ullNow;
+			rkState.kVct_kSpan.push_back(rkSpan);
+		}
+	}
+
+	rkState.kMap_kVct_kOpenSpan.clear();
+}
+
+bool CTimeProfiler::IsRecording()
+{
+	return __GetProfileState().bRecording;
+}
+
+void CTimeProfiler::Begin(const char * c_szName, const char * c_szDetail)
+{
+	SProfileState & rkState = __GetProfileState();
+	if (!rkState.bRecording)
+		return;
+
+	DWORD dwThreadID = GetCurrentThreadId();
+
+	std::lock_guard<std::mutex> kLock(rkState.kMutex);
+	std::vector<TProfileSpan> & rkVct_kOpenSpan = rkState.kMap_kVct_kOpenSpan[dwThreadID];
+
+	TProfileSpan kSpan;
+	kSpan.stName = c_szName;
+	if (c_szDetail)
+		kSpan.stDetail = c_szDetail;
+	kSpan.dwThreadID = dwThreadID;
+	kSpan.uDepth = rkVct_kOpenSpan.size();
+	kSpan.ullBegin = ELTimer_GetUSec() - rkState.ullStart;
+	kSpan.ullEnd = kSpan.ullBegin;
+
+	rkVct_kOpenSpan.push_back(kSpan);
+}
+
+void CTimeProfiler::End()
+{
+	SProfileState & rkState = __GetProfileState();
+	DWORD dwThreadID = GetCurrentThreadId();
+
+	std::lock_guard<std::mutex> kLock(rkState.kMutex);
+
+	// nothing is open when Stop came in between, the span was closed there
+	auto it = rkState.kMap_kVct_kOpenSpan.find(dwThreadID);
+	if (rkState.kMap_kVct_kOpenSpan.end() == it || it->second.empty())
+		return;
+
+	TProfileSpan & rkSpan = it->second.back();
+	rkSpan.ullEnd = ELTimer_GetUSec() - rkState.ullStart;
+
+	rkState.kVct_kSpan.push_back(std::move(rkSpan));
+	it->second.pop_back();
+}
+
+void CTimeProfiler::SetThreadName(const char * c_szName)
+{
+	SProfileState & rkState = __GetProfileState();
+	std::lock_guard<std::mutex> kLock(rkState.kMutex);
+
+	rkState.kMap_stThreadName[GetCurrentThreadId()] = c_szName;
+}
+
+static void __WriteJSONString(FILE * fp, const std::string & c_rstText)
+{
+	fputc('"', fp);
+
+	for (unsigned char c : c_rstText)
+	{
+		if ('"' == c || '\\' == c)
+			fprintf(fp, "\\%c", c);
+		else if (c < 0x20)
+			fprintf(fp, "\\u%04x", c);
+		else
+			fputc(c, fp);
+	}
+
+	fputc('"', fp);
+}
+
+bool CTimeProfiler::SaveChromeTrace(const char * c_szFileName)
+{
+	SProfileState & rkState = __GetProfileState();
+
+	std::vector<TProfileSpan> kVct_kSpan;
+	std::map<DWORD, std::string> kMap_stThreadName;
+	{
+		std::lock_guard<std::mutex> kLock(rkState.kMutex);
+		kVct_kSpan = rkState.kVct_kSpan;
+		kMap_stThreadName = rkState.kMap_stThreadName;
+	}
+
+	std::stable_sort(kVct_kSpan.begin(), kVct_kSpan.end(), [](const TProfileSpan & a, const TProfileSpan & b)
+	{
+		return a.ullBegin < b.ullBegin;
+	});
+
+	MyCreateDirectory(c_szFileName);
+
+	FILE * fp = fopen(c_szFileName, "w");
+	if (!fp)
+	{
+		TraceError("CTimeProfiler::SaveChromeTrace - cannot open %s", c_szFileName);
+		return false;
+	}
+
+	fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	bool bFirst = true;
+
+	for (const auto & c_rkPair : kMap_stThreadName)
+	{
+		fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", bFirst ? "" : ",\n", c_rkPair.first);
+		__WriteJSONString(fp, c_rkPair.second);
+		fprintf(fp, "}}");
+		bFirst = false;
+	}
+
+	for (const TProfileSpan & c_rkSpan : kVct_kSpan)
+	{
+		fprintf(fp, "%s{\"name\":", bFirst ? "" : ",\n");
+		__WriteJSONString(fp, c_rkSpan.stName);
+		fprintf(fp, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu,\"dur\":%llu",
+			c_rkSpan.dwThreadID, c_rkSpan.ullBegin, c_rkSpan.ullEnd - c_rkSpan.ullBegin);
+
+		if (!c_rkSpan.stDetail.empty())
+		{
+			fprintf(fp, ",\"args\":{\"detail\":");
+			__WriteJSONString(fp, c_rkSpan.stDetail);
+			fprintf(fp, "}");
+		}
+
+		fprintf(fp, "}");
+		bFirst = false;
+	}
+
+	fprintf(fp, "\n]}\n");
+
+	bool bWritten = !ferror(fp);
+	if (fclose(fp) != 0)
+		bWritten = false;
+
+	if (!bWritten)
+		TraceError("CTimeProfiler::SaveChromeTrace - cannot write %s", c_szFileName);
+
+	return bWritten;
+}
+
+void CTimeProfiler::TraceSummary(DWORD dwMinMSec, UINT uMaxDepth)
+{
+	SProfileState & rkState = __GetProfileState();
+
+	std::vector<TProfileSpan> kVct_kSpan;
+	std::map<DWORD, std::string> kMap_stThreadName;
+	{
+		std::lock_guard<std::mutex> kLock(rkState.kMutex);
+		kVct_kSpan = rkState.kVct_kSpan;
+		kMap_stThreadName = rkState.kMap_stThreadName;
+	}
+
+	// thread by thread, each in the order of its spans, so the indentation reads as a call tree
+	std::stable_sort(kVct_kSpan.begin(), kVct_kSpan.end(), [](const TProfileSpan & a, const TProfileSpan & b)
+	{
+		if (a.dwThreadID != b.dwThreadID)
+			return a.dwThreadID < b.dwThreadID;
+		return a.ullBegin < b.ullBegin;
+	});
+
+	DWORD dwThreadID = 0;
+
+	for (const TProfileSpan & c_rkSpan : kVct_kSpan)
+	{
+		if (c_rkSpan.uDepth > uMaxDepth || c_rkSpan.ullEnd - c_rkSpan.ullBegin < dwMinMSec * 1000ull)
+			continue;
+
+		if (c_rkSpan.dwThreadID != dwThreadID)
+		{
+			dwThreadID = c_rkSpan.dwThreadID;
+
+			auto it = kMap_stThreadName.find(dwThreadID);
+			Tracenf("thread %u %s", dwThreadID, kMap_stThreadName.end() != it ? it->second.c_str() : "");
+		}
+
+		Tracenf("%*s%-32s %9.1f ms at %9.1f ms %s", 2 + c_rkSpan.uDepth * 2, "", c_rkSpan.stName.c_str(),
+			(c_rkSpan.ullEnd - c_rkSpan.ullBegin) / 1000.0, c_rkSpan.ullBegin / 1000.0, c_rkSpan.stDetail.c_str());
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <windows.h>
+
+// Records named, nested spans of time with the performance counter, from any thread, between Start and Stop.
+// Meant for one-off sequences such as the boot of the client, every span is kept until the process ends.
+// SaveChromeTrace writes them as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+class CTimeProfiler
+{
+	public:
+		static void		Start();
+		// spans still open are closed at this moment, spans begun later are ignored
+		static void		Stop();
+		static bool		IsRecording();
+
+		// c_szDetail (a file name, coordinates) goes to the event's args
+		static void		Begin(const char * c_szName, const char * c_szDetail = NULL);
+		static void		End();
+
+		static void		SetThreadName(const char * c_szName);
+
+		static bool		SaveChromeTrace(const char * c_szFileName);
+		// the spans of at least dwMinMSec up to dwMaxDepth levels deep, indented per level
+		static void		TraceSummary(DWORD dwMinMSec, UINT uMaxDepth);
+};
+
+class CTimeProfileScope
+{
+	public:
+		CTimeProfileScope(const char * c_szName, const char * c_szDetail = NULL) : m_bActive(CTimeProfiler::IsRecording())
+		{
+			if (m_bActive)
+				CTimeProfiler::Begin(c_szName, c_szDetail);
+		}
+
+		~CTimeProfileScope()
+		{
+			if (m_bActive)
+				CTimeProfiler::End();
+		}
+
+	protected:
+		bool	m_bActive;
+};
+
+#define TIME_PROFILE_SCOPE_NAME2(line)	__kTimeProfileScope##line
+#define TIME_PROFILE_SCOPE_NAME(line)	TIME_PROFILE_SCOPE_NAME2(line)
+#define TIME_PROFILE_SCOPE(...)			CTimeProfileScope TIME_PROFILE_SCOPE_NAME(__LINE__)(__VA_ARGS__)
@@ -33,6 +33,22 @@ DWORD ELTimer_GetMSec()
 	return timeGetTime() - gs_dwBaseTime; //(liTickCount.QuadPart*1000  / gs_liTickCountPerSec.QuadPart)-gs_dwBaseTime;		
 }
 
+ULONGLONG ELTimer_GetUSec()
+{
+	static const LONGLONG s_llTickCountPerSec = []()
+	{
+		LARGE_INTEGER liFrequency;
+		QueryPerformanceFrequency(&liFrequency);
+		return liFrequency.QuadPart;
+	}();
+
+	LARGE_INTEGER liTickCount;
+	QueryPerformanceCounter(&liTickCount);
+
+	// split up, the tick count times a million would overflow after a few days of uptime
+	return (liTickCount.QuadPart / s_llTickCountPerSec) * 1000000 + (liTickCount.QuadPart % s_llTickCountPerSec) * 1000000 / s_llTickCountPerSec;
+}
+
 VOID	ELTimer_SetServerMSec(DWORD dwServerTime)
 {
 	NANOBEGIN
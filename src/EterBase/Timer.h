@@ -33,6 +33,8 @@ class CTimer : public CSingleton<CTimer>
 BOOL	ELTimer_Init();
 
 DWORD	ELTimer_GetMSec();
+// performance counter in microseconds, for measuring short spans (callable from any thread)
+ULONGLONG	ELTimer_GetUSec();
 
 VOID	ELTimer_SetServerMSec(DWORD dwServerTime);
 DWORD	ELTimer_GetServerMSec();
@@ -1,5 +1,6 @@
 #include "StdAfx.h"
 #include <stdlib.h>
+#include <mutex>
 
 #include "lzo.h"
 #include "tea.h"
@@ -7,6 +8,7 @@
 
 #define dbg_printf
 
+// CLZObjects are used from the loader threads too (the item and mob protos load in parallel), so the free list is locked
 static class LZOFreeMemoryMgr
 {
 public:
@@ -28,13 +30,16 @@ public:
 		assert(capacity > 0);
 		if (capacity < REUSING_CAPACITY)
 		{
-			if (!m_freeVector.empty())
 			{
-				BYTE* freeMem = m_freeVector.back();
-				m_freeVector.pop_back();
-
-				dbg_printf("lzo.reuse_alloc\t%p(%d) free\n", freeMem, capacity);
-				return freeMem;
+				std::lock_guard<std::mutex> kLock(m_kMutex);
+				if (!m_freeVector.empty())
+				{
+					BYTE* freeMem = m_freeVector.back();
+					m_freeVector.pop_back();
+
+					dbg_printf("lzo.reuse_alloc\t%p(%d) free\n", freeMem, capacity);
+					return freeMem;
+				}
 			}
 			BYTE* newMem = new BYTE[REUSING_CAPACITY];
 			dbg_printf("lzo.reuse_alloc\t%p(%d) real\n", newMem, capacity);
@@ -51,6 +56,7 @@ public:
 		if (capacity < REUSING_CAPACITY)
 		{
 			dbg_printf("lzo.reuse_free\t%p(%d)\n", ptr, capacity);
+			std::lock_guard<std::mutex> kLock(m_kMutex);
 			m_freeVector.push_back(ptr);
 			return;
 		}
@@ -59,6 +65,7 @@ public:
 		delete [] ptr;
 	}
 private:
+	std::mutex m_kMutex;
 	std::vector<BYTE*> m_freeVector;
 } gs_freeMemMgr;
 
@@ -300,6 +300,11 @@ int CGrannyModel::GetIdxCount()
 	return m_idxCount;
 }
 
+size_t CGrannyModel::GetVertexBufferSize() const
+{
+	return m_pntVtxBuf.GetBufferSize() + m_idxBuf.GetIndexCount() * sizeof(WORD);
+}
+
 bool CGrannyModel::CreateDeviceObjects()
 {
 	if (m_rigidVtxCount > 0)
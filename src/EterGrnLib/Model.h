@@ -33,6 +33,7 @@ class CGrannyModel : public CReferenceObject
 		void DeformPNTVertices(void* dstBaseVertices, D3DXMATRIX* boneMatrices, const std::vector<granny_mesh_binding*>& c_rvct_pgrnMeshBinding) const;
 
 		int GetIdxCount();
+		size_t GetVertexBufferSize() const;
 		int GetMeshCount() const;
 		CGrannyMesh * GetMeshPointer(int iMesh);
 		granny_model * GetGrannyModelPointer();
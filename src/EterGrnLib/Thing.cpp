@@ -57,6 +57,15 @@ bool CGraphicThing::OnIsType(TType type)
 	return CResource::OnIsType(type);
 }
 
+// the granny file keeps its own copy of the data, the rigid meshes live in vertex and index buffers on top
+void CGraphicThing::OnGetMemorySize(int iFileSize, size_t * auSize) const
+{
+	CResource::OnGetMemorySize(iFileSize, auSize);
+
+	for (int m = 0; m_models && m < GetModelCount(); ++m)
+		auSize[MEMORY_VERTEX_BUFFER] += m_models[m].GetVertexBufferSize();
+}
+
 bool CGraphicThing::CreateDeviceObjects()
 {
 	if (!m_pgrnFileInfo)
@@ -154,6 +163,62 @@ int CGraphicThing::GetMotionCount() const
 	return (m_pgrnFileInfo->AnimationCount);
 }
 
+// the granny file read and fixed up on a loader thread, models and their vertex buffers are made in OnFinalize
+class CDecodedGrannyFile : public CResource::CDecodedData
+{
+	public:
+		CDecodedGrannyFile(granny_file * pgrnFile, granny_file_info * pgrnFileInfo) : m_pgrnFile(pgrnFile), m_pgrnFileInfo(pgrnFileInfo)
+		{
+		}
+
+		virtual ~CDecodedGrannyFile()
+		{
+			if (m_pgrnFile)
+				GrannyFreeFile(m_pgrnFile);
+		}
+
+	public:
+		granny_file *		m_pgrnFile;
+		granny_file_info *	m_pgrnFileInfo;	// points into m_pgrnFile
+};
+
+CResource::CDecodedData * CGraphicThing::OnDecode(int iSize, const void * c_pvBuf) const
+{
+	if (!c_pvBuf)
+		return NULL;
+
+	granny_file * pgrnFile = GrannyReadEntireFileFromMemory(iSize, (void *) c_pvBuf);
+
+	if (!pgrnFile)
+		return NULL;
+
+	// may convert an older file layout, part of the work worth keeping off the main thread
+	granny_file_info * pgrnFileInfo = GrannyGetFileInfo(pgrnFile);
+
+	return new CDecodedGrannyFile(pgrnFile, pgrnFileInfo);
+}
+
+bool CGraphicThing::OnFinalize(CDecodedData * pData, int iSize, const void * c_pvBuf)
+{
+	if (!pData)
+		return OnLoad(iSize, c_pvBuf);
+
+	CDecodedGrannyFile * pDecoded = static_cast<CDecodedGrannyFile *>(pData);
+
+	// taken over, freed in OnClear from now on
+	m_pgrnFile = pDecoded->m_pgrnFile;
+	pDecoded->m_pgrnFile = NULL;
+
+	m_pgrnFileInfo = pDecoded->m_pgrnFileInfo;
+
+	if (!m_pgrnFileInfo)
+		return false;
+
+	LoadModels();
+	LoadMotions();
+	return true;
+}
+
 bool CGraphicThing::OnLoad(int iSize, const void * c_pvBuf)
 {
 	if (!c_pvBuf)
@@ -34,9 +34,12 @@ class CGraphicThing : public CResource
 
 	protected:
 		bool					OnLoad(int iSize, const void* c_pvBuf);
+		CDecodedData *			OnDecode(int iSize, const void* c_pvBuf) const;
+		bool					OnFinalize(CDecodedData * pData, int iSize, const void* c_pvBuf);
 		void					OnClear();
 		bool					OnIsEmpty() const;
 		bool					OnIsType(TType type);
+		void					OnGetMemorySize(int iFileSize, size_t * auSize) const;
 
 	protected:
 		granny_file *			m_pgrnFile;
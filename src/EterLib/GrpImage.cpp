@@ -61,6 +61,62 @@ const RECT& CGraphicImage::GetRectReference() const
 	return m_rect;
 }
 
+// pixels stb_image decoded on a loader thread, DDS and what only D3DX reads is left to OnLoad
+class CDecodedImage : public CResource::CDecodedData
+{
+	public:
+		CDecodedImage(BYTE * pbPixels, int iWidth, int iHeight, bool bAlpha) :
+			m_pbPixels(pbPixels), m_iWidth(iWidth), m_iHeight(iHeight), m_bAlpha(bAlpha)
+		{
+		}
+
+		virtual ~CDecodedImage()
+		{
+			CGraphicImageTexture::FreeSTB(m_pbPixels);
+		}
+
+	public:
+		BYTE *	m_pbPixels;
+		int		m_iWidth;
+		int		m_iHeight;
+		bool	m_bAlpha;
+};
+
+CResource::CDecodedData * CGraphicImage::OnDecode(int iSize, const void * c_pvBuf) const
+{
+	if (!c_pvBuf)
+		return NULL;
+
+	int iWidth, iHeight;
+	bool bAlpha;
+	BYTE * pbPixels = CGraphicImageTexture::DecodeSTB(iSize, c_pvBuf, &iWidth, &iHeight, &bAlpha);
+
+	if (!pbPixels)
+		return NULL;
+
+	return new CDecodedImage(pbPixels, iWidth, iHeight, bAlpha);
+}
+
+bool CGraphicImage::OnFinalize(CDecodedData * pData, int iSize, const void * c_pvBuf)
+{
+	if (!pData)
+		return OnLoad(iSize, c_pvBuf);
+
+	CDecodedImage * pImage = static_cast<CDecodedImage *>(pData);
+
+	m_imageTexture.SetFileName(CResource::GetFileName());
+
+	// the device may refuse the texture, D3DX has its own ways of getting it in
+	if (!m_imageTexture.CreateFromPixels(pImage->m_iWidth, pImage->m_iHeight, pImage->m_bAlpha, pImage->m_pbPixels))
+		return OnLoad(iSize, c_pvBuf);
+
+	m_rect.left = 0;
+	m_rect.top = 0;
+	m_rect.right = m_imageTexture.GetWidth();
+	m_rect.bottom = m_imageTexture.GetHeight();
+	return true;
+}
+
 bool CGraphicImage::OnLoad(int iSize, const void * c_pvBuf)
 {
 	if (!c_pvBuf)
@@ -86,6 +142,12 @@ void CGraphicImage::OnClear()
 	memset(&m_rect, 0, sizeof(m_rect));
 }
 
+// only the texture stays around, the file is dropped once it is uploaded
+void CGraphicImage::OnGetMemorySize(int iFileSize, size_t * auSize) const
+{
+	auSize[MEMORY_TEXTURE] = m_imageTexture.GetMemorySize();
+}
+
 bool CGraphicImage::OnIsEmpty() const
 {
 	return m_imageTexture.IsEmpty();
@@ -53,10 +53,11 @@ bool CGraphicImageTexture::CreateDeviceObjects()
 	else
 	{
 		TPackFile	mappedFile;
-		if (!CPackManager::Instance().GetFile(m_stFileName, mappedFile))
+		TPackFileView	view;
+		if (!CPackManager::Instance().GetFileView(m_stFileName, view, mappedFile))
 			return false;
 
-		return CreateFromMemoryFile(mappedFile.size(), mappedFile.data(), m_d3dFmt, m_dwFilter);
+		return CreateFromMemoryFile(view.size(), view.data(), m_d3dFmt, m_dwFilter);
 	}
 
 	m_bEmpty = false;
@@ -104,38 +105,71 @@ bool CGraphicImageTexture::CreateFromDDSTexture(UINT bufSize, const void* c_pvBu
 	return true;
 }
 
-bool CGraphicImageTexture::CreateFromSTB(UINT bufSize, const void* c_pvBuf)
+BYTE* CGraphicImageTexture::DecodeSTB(UINT bufSize, const void* c_pvBuf, int* piWidth, int* piHeight, bool* pbAlpha)
 {
 	int width, height, channels;
 	unsigned char* data = stbi_load_from_memory((stbi_uc*)c_pvBuf, bufSize, &width, &height, &channels, 4); // force RGBA
-	if (data) {
-		LPDIRECT3DTEXTURE9 texture;
-		if (SUCCEEDED(ms_lpd3dDevice->CreateTexture(width, height, 1, 0, channels == 4 ? D3DFMT_A8R8G8B8 : D3DFMT_X8R8G8B8, D3DPOOL_DEFAULT, &texture, nullptr))) {
-			D3DLOCKED_RECT rect;
-			if (SUCCEEDED(texture->LockRect(0, &rect, nullptr, 0))) {
-				uint8_t* dstData = (uint8_t*)rect.pBits;
-				uint8_t* srcData = (uint8_t*)data;
-				for (size_t i = 0; i < width * height; ++i, dstData += 4, srcData += 4) {
-					dstData[0] = srcData[2];
-					dstData[1] = srcData[1];
-					dstData[2] = srcData[0];
-					dstData[3] = srcData[3];
-				}
+	if (!data) {
+		return NULL;
+	}
 
-				texture->UnlockRect(0);
-				m_width = width;
-				m_height = height;
-				m_bEmpty = false;
-				m_lpd3dTexture = texture;
-			}
-			else {
-				texture->Release();
-			}
-		}
-		stbi_image_free(data);
+	// RGBA to BGRA in place
+	uint8_t* pixel = (uint8_t*)data;
+	for (size_t i = 0; i < (size_t)width * height; ++i, pixel += 4) {
+		std::swap(pixel[0], pixel[2]);
+	}
+
+	*piWidth = width;
+	*piHeight = height;
+	*pbAlpha = channels == 4;
+	return data;
+}
+
+void CGraphicImageTexture::FreeSTB(BYTE* pbPixels)
+{
+	stbi_image_free(pbPixels);
+}
+
+bool CGraphicImageTexture::CreateFromPixels(int width, int height, bool bAlpha, const BYTE* c_pbPixels)
+{
+	assert(ms_lpd3dDevice != NULL);
+	assert(m_lpd3dTexture == NULL);
+
+	LPDIRECT3DTEXTURE9 texture;
+	if (FAILED(ms_lpd3dDevice->CreateTexture(width, height, 1, 0, bAlpha ? D3DFMT_A8R8G8B8 : D3DFMT_X8R8G8B8, D3DPOOL_DEFAULT, &texture, nullptr))) {
+		return false;
+	}
+
+	D3DLOCKED_RECT rect;
+	if (FAILED(texture->LockRect(0, &rect, nullptr, 0))) {
+		texture->Release();
+		return false;
+	}
+
+	for (int y = 0; y < height; ++y) {
+		memcpy((uint8_t*)rect.pBits + y * rect.Pitch, c_pbPixels + y * width * 4, width * 4);
+	}
+
+	texture->UnlockRect(0);
+	m_width = width;
+	m_height = height;
+	m_bEmpty = false;
+	m_lpd3dTexture = texture;
+	return true;
+}
+
+bool CGraphicImageTexture::CreateFromSTB(UINT bufSize, const void* c_pvBuf)
+{
+	int width, height;
+	bool bAlpha;
+	BYTE* pixels = DecodeSTB(bufSize, c_pvBuf, &width, &height, &bAlpha);
+	if (!pixels) {
+		return false;
 	}
 
-	return !m_bEmpty;
+	bool ret = CreateFromPixels(width, height, bAlpha, pixels);
+	FreeSTB(pixels);
+	return ret;
 }
 
 bool CGraphicImageTexture::CreateFromMemoryFile(UINT bufSize, const void * c_pvBuf, D3DFORMAT d3dFmt, DWORD dwFilter)
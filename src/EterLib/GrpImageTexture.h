@@ -18,6 +18,12 @@ class CGraphicImageTexture : public CGraphicTexture
 		bool		CreateFromMemoryFile(UINT bufSize, const void* c_pvBuf, D3DFORMAT d3dFmt, DWORD dwFilter = D3DX_FILTER_LINEAR);
 		bool		CreateFromDDSTexture(UINT bufSize, const void* c_pvBuf);
 		bool		CreateFromSTB(UINT bufSize, const void* c_pvBuf);
+		bool		CreateFromPixels(int width, int height, bool bAlpha, const BYTE* c_pbPixels);
+
+		// The CPU half of CreateFromSTB, safe on any thread: decodes to rows in the byte order of D3DFMT_A8R8G8B8
+		// for CreateFromPixels, NULL if stb_image can't read the file. Free the pixels with FreeSTB.
+		static BYTE *	DecodeSTB(UINT bufSize, const void* c_pvBuf, int* piWidth, int* piHeight, bool* pbAlpha);
+		static void		FreeSTB(BYTE* pbPixels);
 
 		void		SetFileName(const char * c_szFileName);
 		
@@ -171,12 +171,12 @@ void CGraphicMarkInstance::SetPosition(float fx, float fy)
 	m_v2Position.y = fy;
 }
 
-void CGraphicMarkInstance::Load()
+void CGraphicMarkInstance::Load(bool bLooseFile)
 {
 	if (GetImageFileName().empty())
 		return;
 
-	CResource * pResource = CResourceManager::Instance().GetResourcePointer(GetImageFileName().c_str());
+	CResource * pResource = CResourceManager::Instance().GetResourcePointer(GetImageFileName().c_str(), bLooseFile);
 
 	if (!pResource)
 	{
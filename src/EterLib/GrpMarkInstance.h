@@ -26,7 +26,8 @@ class CGraphicMarkInstance
 		void SetIndex(UINT uIndex);
 		void SetScale(float fScale);
 
-		void Load();
+		// bLooseFile reads the image from the disk instead of the packs, see CResource::SetLooseFile
+		void Load(bool bLooseFile = false);
 		bool IsEmpty() const;
 
 		int GetWidth();
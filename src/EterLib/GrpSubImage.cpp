@@ -62,6 +62,12 @@ void CGraphicSubImage::SetSearchPath(const char * c_szFileName)
 	strncpy(m_SearchPath, c_szFileName, sizeof(m_SearchPath)-1);
 }
 
+CResource::CDecodedData * CGraphicSubImage::OnDecode(int /*iSize*/, const void* /*c_pvBuf*/) const
+{
+	// a few lines of text naming the image, nothing worth doing on a loader thread
+	return NULL;
+}
+
 bool CGraphicSubImage::OnLoad(int iSize, const void* c_pvBuf)
 {
 	if (!c_pvBuf)
@@ -138,6 +144,12 @@ void CGraphicSubImage::OnClear()
 	memset(&m_rect, 0, sizeof(m_rect));
 }
 
+// the texture belongs to the image this refers to and is counted there
+void CGraphicSubImage::OnGetMemorySize(int iFileSize, size_t * auSize) const
+{
+	CResource::OnGetMemorySize(iFileSize, auSize);
+}
+
 bool CGraphicSubImage::OnIsEmpty() const
 {
 	if (!m_roImage.IsNull())		
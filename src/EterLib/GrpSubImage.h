@@ -29,9 +29,11 @@ class CGraphicSubImage : public CGraphicImage
 		void SetImagePointer(CGraphicImage* pImage);
 
 		bool OnLoad(int iSize, const void* c_pvBuf);
+		CDecodedData * OnDecode(int iSize, const void* c_pvBuf) const;
 		void OnClear();		
 		bool OnIsEmpty() const;
 		bool OnIsType(TType type);
+		void OnGetMemorySize(int iFileSize, size_t * auSize) const;
 		
 	protected:
 		CGraphicImage::TRef m_roImage;
@@ -57,3 +57,50 @@ CGraphicTexture::CGraphicTexture()
 CGraphicTexture::~CGraphicTexture()	
 {
 }
+
+// bytes of all mip levels, as far as the format tells
+size_t CGraphicTexture::GetMemorySize() const
+{
+	if (!m_lpd3dTexture)
+		return 0;
+
+	size_t uSize = 0;
+	for (DWORD i = 0; i < m_lpd3dTexture->GetLevelCount(); ++i)
+	{
+		D3DSURFACE_DESC kDesc;
+		if (FAILED(m_lpd3dTexture->GetLevelDesc(i, &kDesc)))
+			break;
+
+		switch (kDesc.Format)
+		{
+			case D3DFMT_DXT1:
+				uSize += size_t((kDesc.Width + 3) / 4) * ((kDesc.Height + 3) / 4) * 8;
+				break;
+
+			case D3DFMT_DXT2:
+			case D3DFMT_DXT3:
+			case D3DFMT_DXT4:
+			case D3DFMT_DXT5:
+				uSize += size_t((kDesc.Width + 3) / 4) * ((kDesc.Height + 3) / 4) * 16;
+				break;
+
+			case D3DFMT_R5G6B5:
+			case D3DFMT_X1R5G5B5:
+			case D3DFMT_A1R5G5B5:
+			case D3DFMT_A4R4G4B4:
+				uSize += size_t(kDesc.Width) * kDesc.Height * 2;
+				break;
+
+			case D3DFMT_A8:
+			case D3DFMT_L8:
+				uSize += size_t(kDesc.Width) * kDesc.Height;
+				break;
+
+			default:
+				uSize += size_t(kDesc.Width) * kDesc.Height * 4;
+				break;
+		}
+	}
+
+	return uSize;
+}
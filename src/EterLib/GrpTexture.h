@@ -12,6 +12,7 @@ class CGraphicTexture : public CGraphicBase
 
 		void SetTextureStage(int stage) const;
 		LPDIRECT3DTEXTURE9 GetD3DTexture() const;
+		size_t GetMemorySize() const;
 
 		void DestroyDeviceObjects();
 		
@@ -0,0 +1,103 @@
+#include "StdAfx.h"
+#include "NetDispatchBudget.h"
+#include "EterBase/Timer.h"
+
+CNetworkDispatchBudget::CNetworkDispatchBudget() : m_dwBaseUSec(DEFAULT_BASE_USEC), m_dwMaxUSec(DEFAULT_MAX_USEC)
+{
+	Reset();
+}
+
+CNetworkDispatchBudget::~CNetworkDispatchBudget()
+{
+}
+
+void CNetworkDispatchBudget::SetBudget(DWORD dwBaseUSec, DWORD dwMaxUSec)
+{
+	m_dwBaseUSec = dwBaseUSec;
+	m_dwMaxUSec = std::max(dwBaseUSec, dwMaxUSec);
+}
+
+void CNetworkDispatchBudget::Reset()
+{
+	m_ullFrameBegin = 0;
+	m_dwFrameBudget = m_dwBaseUSec;
+	m_dwFramePacketCount = 0;
+	m_isFrameCut = false;
+	m_ullBehindSince = 0;
+
+	memset(&m_kStat, 0, sizeof(m_kStat));
+}
+
+void CNetworkDispatchBudget::BeginFrame(DWORD dwBacklogSize)
+{
+	m_ullFrameBegin = ELTimer_GetUSec();
+	m_dwFramePacketCount = 0;
+	m_isFrameCut = false;
+
+	if (m_ullBehindSince && m_ullFrameBegin - m_ullBehindSince >= CATCHUP_LATENCY_MSEC * 1000ull)
+	{
+		m_dwFrameBudget = m_dwMaxUSec;
+		return;
+	}
+
+	ULONGLONG ullBudget = m_dwBaseUSec + (ULONGLONG) m_dwBaseUSec * (dwBacklogSize / CATCHUP_STEP_SIZE);
+	m_dwFrameBudget = (DWORD) std::min<ULONGLONG>(ullBudget, m_dwMaxUSec);
+}
+
+bool CNetworkDispatchBudget::CanDispatch()
+{
+	if (m_dwFramePacketCount < MIN_PACKET_COUNT)
+		return true;
+
+	if (ELTimer_GetUSec() - m_ullFrameBegin < m_dwFrameBudget)
+		return true;
+
+	m_isFrameCut = true;
+	return false;
+}
+
+void CNetworkDispatchBudget::OnDispatch()
+{
+	++m_dwFramePacketCount;
+}
+
+void CNetworkDispatchBudget::EndFrame(DWORD dwBacklogSize)
+{
+	ULONGLONG ullNow = ELTimer_GetUSec();
+	DWORD dwDispatchTime = (DWORD) (ullNow - m_ullFrameBegin);
+
+	// a partial packet still waiting for its rest isn't a backlog, only a frame cut by the budget is behind
+	bool bCut = m_isFrameCut && dwBacklogSize;
+
+	if (!bCut)
+		m_ullBehindSince = 0;
+	else if (!m_ullBehindSince)
+		m_ullBehindSince = m_ullFrameBegin;
+
+	m_kStat.dwFrameCount++;
+	m_kStat.dwPacketCount += m_dwFramePacketCount;
+	m_kStat.dwLastPacketCount = m_dwFramePacketCount;
+	m_kStat.dwMaxPacketCount = std::max(m_kStat.dwMaxPacketCount, m_dwFramePacketCount);
+
+	if (bCut)
+		m_kStat.dwCutFrameCount++;
+
+	m_kStat.dwBacklogSize = dwBacklogSize;
+	m_kStat.dwMaxBacklogSize = std::max(m_kStat.dwMaxBacklogSize, dwBacklogSize);
+	m_kStat.dwLatency = m_ullBehindSince ? (DWORD) ((ullNow - m_ullBehindSince) / 1000) : 0;
+	m_kStat.dwMaxLatency = std::max(m_kStat.dwMaxLatency, m_kStat.dwLatency);
+
+	m_kStat.ullDispatchTime += dwDispatchTime;
+	m_kStat.dwLastDispatchTime = dwDispatchTime;
+	m_kStat.dwMaxDispatchTime = std::max(m_kStat.dwMaxDispatchTime, dwDispatchTime);
+}
+
+DWORD CNetworkDispatchBudget::GetFrameBudget() const
+{
+	return m_dwFrameBudget;
+}
+
+const CNetworkDispatchBudget::TStat & CNetworkDispatchBudget::GetStat() const
+{
+	return m_kStat;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <windows.h>
+
+// Decides how many received packets one frame dispatches. A frame gets a small time budget so a busy
+// server can't eat the frame rate, and the budget grows with the bytes still buffered and with how long
+// the client has been behind, so a siege burst is caught up within a few frames instead of piling up.
+// The counters tell how far behind the dispatch runs.
+class CNetworkDispatchBudget
+{
+	public:
+		enum
+		{
+			DEFAULT_BASE_USEC = 2000,
+			DEFAULT_MAX_USEC = 16000,
+			CATCHUP_STEP_SIZE = 8192,		// every step of backlog adds one base budget
+			CATCHUP_LATENCY_MSEC = 500,		// behind longer than this, the frame gets the max budget
+			MIN_PACKET_COUNT = 4,			// dispatched whatever the budget, as the old fixed limit did
+		};
+
+		typedef struct SStat
+		{
+			DWORD		dwFrameCount;
+			DWORD		dwPacketCount;
+			DWORD		dwCutFrameCount;		// frames stopped by the budget with data left
+			DWORD		dwLastPacketCount;
+			DWORD		dwMaxPacketCount;
+
+			DWORD		dwBacklogSize;			// bytes left over by the last frame
+			DWORD		dwMaxBacklogSize;
+			DWORD		dwLatency;				// ms the client has been behind at the end of the last frame
+			DWORD		dwMaxLatency;
+
+			ULONGLONG	ullDispatchTime;		// us, summed over all frames
+			DWORD		dwLastDispatchTime;
+			DWORD		dwMaxDispatchTime;
+		} TStat;
+
+	public:
+		CNetworkDispatchBudget();
+		~CNetworkDispatchBudget();
+
+		void			SetBudget(DWORD dwBaseUSec, DWORD dwMaxUSec);
+		void			Reset();
+
+		void			BeginFrame(DWORD dwBacklogSize);
+		// true while the frame may dispatch one more packet
+		bool			CanDispatch();
+		void			OnDispatch();
+		void			EndFrame(DWORD dwBacklogSize);
+
+		DWORD			GetFrameBudget() const;
+		const TStat &	GetStat() const;
+
+	protected:
+		DWORD			m_dwBaseUSec;
+		DWORD			m_dwMaxUSec;
+
+		ULONGLONG		m_ullFrameBegin;
+		DWORD			m_dwFrameBudget;
+		DWORD			m_dwFramePacketCount;
+		bool			m_isFrameCut;
+		ULONGLONG		m_ullBehindSince;		// 0 while the buffer was drained by the last frame
+
+		TStat			m_kStat;
+};
@@ -0,0 +1,105 @@
+#include "StdAfx.h"
+#include "NetReactor.h"
+#include "NetStream.h"
+
+CNetworkReactor::CNetworkReactor() : m_dwFramePollCount(0)
+{
+	memset(&m_kStat, 0, sizeof(m_kStat));
+}
+
+CNetworkReactor::~CNetworkReactor()
+{
+}
+
+void CNetworkReactor::Register(CNetworkStream * pkStream)
+{
+	if (std::find(m_kVct_pkStream.begin(), m_kVct_pkStream.end(), pkStream) != m_kVct_pkStream.end())
+		return;
+
+	m_kVct_pkStream.push_back(pkStream);
+	m_kStat.dwStreamCount = m_kVct_pkStream.size();
+}
+
+void CNetworkReactor::Unregister(CNetworkStream * pkStream)
+{
+	std::vector<CNetworkStream *>::iterator f = std::find(m_kVct_pkStream.begin(), m_kVct_pkStream.end(), pkStream);
+	if (f == m_kVct_pkStream.end())
+		return;
+
+	m_kVct_pkStream.erase(f);
+	m_kStat.dwStreamCount = m_kVct_pkStream.size();
+
+	// the handle may be reused by a socket opened later in the frame, which must not get these events
+	SOCKET sock = pkStream->GetSocket();
+	for (WSAPOLLFD & rkPollFD : m_kVct_kPollFD)
+	{
+		if (rkPollFD.fd == sock)
+			rkPollFD.fd = INVALID_SOCKET;
+	}
+}
+
+void CNetworkReactor::Poll()
+{
+	m_kStat.dwFrameCount++;
+	m_kStat.dwLastFramePollCount = m_dwFramePollCount;
+	m_kStat.dwMaxFramePollCount = std::max(m_kStat.dwMaxFramePollCount, m_dwFramePollCount);
+	m_dwFramePollCount = 0;
+
+	m_kVct_kPollFD.clear();
+
+	for (CNetworkStream * pkStream : m_kVct_pkStream)
+	{
+		WSAPOLLFD kPollFD;
+		kPollFD.fd = pkStream->GetSocket();
+		kPollFD.events = POLLRDNORM | POLLWRNORM;
+		kPollFD.revents = 0;
+
+		if (INVALID_SOCKET != kPollFD.fd)
+			m_kVct_kPollFD.push_back(kPollFD);
+	}
+
+	if (m_kVct_kPollFD.empty())
+		return;
+
+	m_kStat.dwPollCount++;
+	m_dwFramePollCount++;
+
+	// a failed poll hands out no events, the streams then poll on their own
+	if (WSAPoll(&m_kVct_kPollFD[0], m_kVct_kPollFD.size(), 0) == SOCKET_ERROR)
+		m_kVct_kPollFD.clear();
+}
+
+void CNetworkReactor::Flush()
+{
+	// a stream that fails its send disconnects and unregisters itself
+	std::vector<CNetworkStream *> kVct_pkStream(m_kVct_pkStream);
+
+	for (CNetworkStream * pkStream : kVct_pkStream)
+		pkStream->Flush();
+}
+
+bool CNetworkReactor::PopEvents(SOCKET sock, short * psEvents)
+{
+	for (WSAPOLLFD & rkPollFD : m_kVct_kPollFD)
+	{
+		if (rkPollFD.fd != sock)
+			continue;
+
+		*psEvents = rkPollFD.revents;
+		rkPollFD.fd = INVALID_SOCKET;
+		return true;
+	}
+
+	return false;
+}
+
+void CNetworkReactor::OnSelfPoll()
+{
+	m_kStat.dwSelfPollCount++;
+	m_dwFramePollCount++;
+}
+
+const CNetworkReactor::TStat & CNetworkReactor::GetStat() const
+{
+	return m_kStat;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "EterBase/Singleton.h"
+
+#include <vector>
+
+class CNetworkStream;
+
+// Owns the readiness polling of every client connection. A frame polls all registered sockets with one
+// WSAPoll instead of a select per stream, each stream's Process takes the events of its socket from
+// here, and the end of the frame flushes what every stream queued. A stream processed without a fresh
+// poll, or without a reactor at all, polls its own socket as before.
+class CNetworkReactor : public CSingleton<CNetworkReactor>
+{
+	public:
+		typedef struct SStat
+		{
+			DWORD		dwFrameCount;
+			DWORD		dwPollCount;			// WSAPoll calls of the reactor
+			DWORD		dwSelfPollCount;		// polls the streams made on their own
+			DWORD		dwLastFramePollCount;	// both kinds, in the last frame
+			DWORD		dwMaxFramePollCount;
+			DWORD		dwStreamCount;
+		} TStat;
+
+	public:
+		CNetworkReactor();
+		virtual ~CNetworkReactor();
+
+		void			Register(CNetworkStream * pkStream);
+		void			Unregister(CNetworkStream * pkStream);
+
+		// once per frame, before the streams are processed
+		void			Poll();
+		// once per frame, after the packets of the frame are queued
+		void			Flush();
+
+		// the events the frame's poll saw on sock, each are handed out once
+		bool			PopEvents(SOCKET sock, short * psEvents);
+		void			OnSelfPoll();
+
+		const TStat &	GetStat() const;
+
+	protected:
+		std::vector<CNetworkStream *>	m_kVct_pkStream;
+		std::vector<WSAPOLLFD>			m_kVct_kPollFD;
+
+		DWORD							m_dwFramePollCount;
+		TStat							m_kStat;
+};
@@ -0,0 +1,79 @@
+#include "StdAfx.h"
+#include "NetRingBuffer.h"
+
+CNetworkRingBuffer::CNetworkRingBuffer() : m_pcBuf(NULL), m_dwMask(0), m_dwInputPos(0), m_dwOutputPos(0)
+{
+}
+
+CNetworkRingBuffer::~CNetworkRingBuffer()
+{
+	Destroy();
+}
+
+void CNetworkRingBuffer::Create(int iSize)
+{
+	Destroy();
+
+	DWORD dwCapacity = 8;
+	while (dwCapacity < (DWORD) iSize)
+		dwCapacity <<= 1;
+
+	m_pcBuf = new char[dwCapacity];
+	m_dwMask = dwCapacity - 1;
+}
+
+void CNetworkRingBuffer::Destroy()
+{
+	if (m_pcBuf)
+	{
+		delete [] m_pcBuf;
+		m_pcBuf = NULL;
+	}
+
+	m_dwMask = 0;
+	Clear();
+}
+
+void CNetworkRingBuffer::Clear()
+{
+	m_dwInputPos = 0;
+	m_dwOutputPos = 0;
+}
+
+char * CNetworkRingBuffer::GetInputSpan(int * piSize) const
+{
+	if (!m_pcBuf)
+	{
+		*piSize = 0;
+		return NULL;
+	}
+
+	return GetSpan(m_dwInputPos, m_dwOutputPos + m_dwMask + 1, piSize);
+}
+
+bool CNetworkRingBuffer::Write(int iSize, const void * c_pvSrc)
+{
+	if (iSize > GetFreeSize())
+		return false;
+
+	CopyIn(m_dwInputPos, iSize, c_pvSrc);
+	m_dwInputPos += iSize;
+	return true;
+}
+
+void CNetworkRingBuffer::__CopyOutWrapped(DWORD dwOffset, int iSize, void * pvDest) const
+{
+	int iSpanSize = m_dwMask + 1 - dwOffset;
+
+	memcpy(pvDest, m_pcBuf + dwOffset, iSpanSize);
+	memcpy((char *) pvDest + iSpanSize, m_pcBuf, iSize - iSpanSize);
+}
+
+void CNetworkRingBuffer::CopyIn(DWORD dwPos, int iSize, const void * c_pvSrc)
+{
+	int iSpanSize;
+	char * pcSpan = GetSpan(dwPos, dwPos + iSize, &iSpanSize);
+
+	memcpy(pcSpan, c_pvSrc, iSpanSize);
+	memcpy(m_pcBuf, (const char *) c_pvSrc + iSpanSize, iSize - iSpanSize);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <windows.h>
+#include <algorithm>
+#include <cstring>
+
+// A byte queue over a block of a power of two size. The input and output positions only ever grow and
+// are masked on access, so consumed bytes are never moved to the front. Any range of positions is
+// at most two contiguous spans, one up to the end of the block and one from its start.
+class CNetworkRingBuffer
+{
+	public:
+		CNetworkRingBuffer();
+		~CNetworkRingBuffer();
+
+		// iSize is rounded up to a power of two, whatever was queued is dropped
+		void			Create(int iSize);
+		void			Destroy();
+		void			Clear();
+
+		bool			IsCreated() const { return NULL != m_pcBuf; }
+		int				GetCapacity() const { return m_pcBuf ? m_dwMask + 1 : 0; }
+		int				GetUsedSize() const { return m_dwInputPos - m_dwOutputPos; }
+		int				GetFreeSize() const { return GetCapacity() - GetUsedSize(); }
+
+		DWORD			GetInputPos() const { return m_dwInputPos; }
+		DWORD			GetOutputPos() const { return m_dwOutputPos; }
+
+		// the contiguous part of [dwBegin, dwEnd) starting at dwBegin
+		char *			GetSpan(DWORD dwBegin, DWORD dwEnd, int * piSize) const
+		{
+			DWORD dwOffset = dwBegin & m_dwMask;
+			*piSize = std::min(dwEnd - dwBegin, m_dwMask + 1 - dwOffset);
+			return m_pcBuf + dwOffset;
+		}
+
+		// the contiguous free space at the input position, recv writes there and CommitInput takes it
+		char *			GetInputSpan(int * piSize) const;
+		void			CommitInput(int iSize) { m_dwInputPos += iSize; }
+		bool			Write(int iSize, const void * c_pvSrc);
+
+		// every packet is read through here, the copy across the end of the block stays out of line
+		void			CopyOut(DWORD dwPos, int iSize, void * pvDest) const
+		{
+			DWORD dwOffset = dwPos & m_dwMask;
+			if (dwOffset + iSize <= m_dwMask + 1)
+				memcpy(pvDest, m_pcBuf + dwOffset, iSize);
+			else
+				__CopyOutWrapped(dwOffset, iSize, pvDest);
+		}
+
+		void			CopyIn(DWORD dwPos, int iSize, const void * c_pvSrc);
+		void			Skip(int iSize) { m_dwOutputPos += iSize; }
+
+	protected:
+		void			__CopyOutWrapped(DWORD dwOffset, int iSize, void * pvDest) const;
+
+	protected:
+		char *			m_pcBuf;
+		DWORD			m_dwMask;
+		DWORD			m_dwInputPos;
+		DWORD			m_dwOutputPos;
+};
@@ -1,5 +1,6 @@
 #include "StdAfx.h"
 #include "NetStream.h"
+#include "NetReactor.h"
 //#include "eterCrypt.h"
 #include <iomanip>
 #include <sstream>
@@ -39,61 +40,98 @@ bool CNetworkStream::IsSecurityMode()
 
 void CNetworkStream::SetRecvBufferSize(int recvBufSize)
 {
-	if (m_recvBuf)
+	if (m_kRecvBuf.GetCapacity() >= recvBufSize)
+		return;
+
+	m_kRecvBuf.Create(recvBufSize);
+	m_dwRecvDecodePos = m_kRecvBuf.GetInputPos();
+}
+
+void CNetworkStream::SetSendBufferSize(int sendBufSize)
+{
+	if (m_kSendBuf.GetCapacity() >= sendBufSize)
+		return;
+
+	m_kSendBuf.Create(sendBufSize);
+	m_dwSendEncodePos = m_kSendBuf.GetInputPos();
+}
+
+#ifndef _IMPROVED_PACKET_ENCRYPTION_
+typedef int (*TTeaFunction)(unsigned long * dest, const unsigned long * src, const unsigned long * key, int size);
+
+// in place, iSize is whole blocks; only a block lying across the end of the ring needs a copy
+static void __TeaRingBuffer(CNetworkRingBuffer & rkBuf, DWORD dwPos, int iSize, TTeaFunction pfnTea, const char * c_szKey)
+{
+	while (iSize > 0)
 	{
-		if (m_recvBufSize>recvBufSize)
-			return;
+		int iSpanSize;
+		char * pcSpan = rkBuf.GetSpan(dwPos, dwPos + iSize, &iSpanSize);
+
+		int iBlockSize = iSpanSize & ~7;
+		if (iBlockSize > 0)
+		{
+			pfnTea((unsigned long *) pcSpan, (const unsigned long *) pcSpan, (const unsigned long *) c_szKey, iBlockSize);
+		}
+		else
+		{
+			char acBlock[8];
+			iBlockSize = sizeof(acBlock);
 
-		delete [] m_recvBuf;
+			rkBuf.CopyOut(dwPos, iBlockSize, acBlock);
+			pfnTea((unsigned long *) acBlock, (const unsigned long *) acBlock, (const unsigned long *) c_szKey, iBlockSize);
+			rkBuf.CopyIn(dwPos, iBlockSize, acBlock);
+		}
 
-		if (m_recvTEABuf)
-			delete [] m_recvTEABuf;
+		dwPos += iBlockSize;
+		iSize -= iBlockSize;
 	}
-	m_recvBufSize = recvBufSize;
-	m_recvBuf = new char[m_recvBufSize];	
-	m_recvTEABufSize = ((m_recvBufSize>>3)+1)<<3;
-	m_recvTEABuf = new char[m_recvTEABufSize];
 }
+#endif
 
-void CNetworkStream::SetSendBufferSize(int sendBufSize)
+void CNetworkStream::__DecodeRecvBuffer()
 {
-	if (m_sendBuf)
+	DWORD dwInputPos = m_kRecvBuf.GetInputPos();
+
+#ifdef _IMPROVED_PACKET_ENCRYPTION_
+	if (IsSecurityMode())
 	{
-		if (m_sendBufSize > sendBufSize)
-			return;
+		while (m_dwRecvDecodePos != dwInputPos)
+		{
+			int iSpanSize;
+			char * pcSpan = m_kRecvBuf.GetSpan(m_dwRecvDecodePos, dwInputPos, &iSpanSize);
 
-		delete [] m_sendBuf;
+			m_cipher.Decrypt(pcSpan, iSpanSize);
+			m_dwRecvDecodePos += iSpanSize;
+		}
+	}
+#else
+	if (IsSecurityMode())
+	{
+		// a partial block stays encrypted in the ring until the rest of it arrives
+		int decodeSize = (dwInputPos - m_dwRecvDecodePos) & ~7;
 
-		if (m_sendTEABuf)
-			delete [] m_sendTEABuf;
+		__TeaRingBuffer(m_kRecvBuf, m_dwRecvDecodePos, decodeSize, tea_decrypt, m_szDecryptKey);
+		m_dwRecvDecodePos += decodeSize;
 	}
+#endif // _IMPROVED_PACKET_ENCRYPTION_
 
-	m_sendBufSize = sendBufSize;
-	m_sendBuf = new char[m_sendBufSize];
-	m_sendTEABufSize = ((m_sendBufSize>>3)+1)<<3;
-	m_sendTEABuf = new char[m_sendTEABufSize];
+	if (!IsSecurityMode())
+		m_dwRecvDecodePos = dwInputPos;
 }
 
 bool CNetworkStream::__RecvInternalBuffer()
 {
-	if (m_recvBufOutputPos>0)
+	// the free space may wrap around the end of the ring, a second recv fills the part at its start
+	for (int i = 0; i < 2; ++i)
 	{
-		int recvBufDataSize = m_recvBufInputPos - m_recvBufOutputPos;
-		if (recvBufDataSize>0)
-		{
-			memmove(m_recvBuf, m_recvBuf + m_recvBufOutputPos, recvBufDataSize);
-		}
-		
-		m_recvBufInputPos -= m_recvBufOutputPos;
-		m_recvBufOutputPos = 0;
-	}
+		int restSize;
+		char * pcSpan = m_kRecvBuf.GetInputSpan(&restSize);
 
-#ifdef _IMPROVED_PACKET_ENCRYPTION_
-	int restSize = m_recvBufSize - m_recvBufInputPos;
-	if (restSize>0)
-	{		
-		int recvSize = recv(m_sock, m_recvBuf + m_recvBufInputPos, m_recvBufSize - m_recvBufInputPos, 0);	
-		//Tracenf("RECV %d %d(%d, %d)", recvSize, restSize, m_recvTEABufSize - m_recvTEABufInputPos, m_recvBufSize - m_recvBufInputPos);
+		if (restSize <= 0)
+			break;
+
+		int recvSize = recv(m_sock, pcSpan, restSize, 0);
+		//Tracenf("RECV %d %d", recvSize, restSize);
 
 		if (recvSize < 0)
 		{
@@ -103,185 +141,143 @@ bool CNetworkStream::__RecvInternalBuffer()
 			{
 				return false;
 			}
+
+			break;
 		}
 		else if (recvSize == 0)
 		{
+			// what the first recv got is still dispatched, the next Process sees the close again
+			if (i > 0)
+				break;
+
 			return false;
 		}
 
-		if (IsSecurityMode()) {
-			m_cipher.Decrypt(m_recvBuf + m_recvBufInputPos, recvSize);
-		}
+		m_kRecvBuf.CommitInput(recvSize);
 
-		m_recvBufInputPos += recvSize;
+		if (recvSize < restSize)
+			break;
 	}
-#else
-	if (IsSecurityMode())
-	{		
-		int restSize = std::min(m_recvTEABufSize - m_recvTEABufInputPos, m_recvBufSize - m_recvBufInputPos);
- 
-		if (restSize > 0)
-		{
-			int recvSize = recv(m_sock, m_recvTEABuf + m_recvTEABufInputPos, restSize, 0);	
-			//Tracenf("RECV %d %d(%d, %d)", recvSize, restSize, m_recvTEABufSize - m_recvTEABufInputPos, m_recvBufSize - m_recvBufInputPos);
 
-			if (recvSize < 0)
-			{
-				int error = WSAGetLastError();
+	__DecodeRecvBuffer();
 
-				if (error != WSAEWOULDBLOCK)
-				{
-					return false;
-				}
-			}
-			else if (recvSize == 0)
-			{
-				return false;
-			}
+	return true;
+}
 
-			m_recvTEABufInputPos += recvSize;
+void CNetworkStream::__EncodeSendBuffer()
+{
+#ifdef _IMPROVED_PACKET_ENCRYPTION_
+	DWORD dwInputPos = m_kSendBuf.GetInputPos();
 
-			int decodeSize = m_recvTEABufInputPos;
+	if (IsSecurityMode())
+	{
+		while (m_dwSendEncodePos != dwInputPos)
+		{
+			int iSpanSize;
+			char * pcSpan = m_kSendBuf.GetSpan(m_dwSendEncodePos, dwInputPos, &iSpanSize);
 
-			if (decodeSize >= 8)
-			{
-				decodeSize >>= 3;
-				decodeSize <<= 3;
-
-				/*int decodeDstSize = tea_decrypt((DWORD *) (m_recvBuf + m_recvBufInputPos),
-												 (DWORD *) m_recvTEABuf,
-												 (const DWORD *) m_szDecryptKey,
-												 decodeSize);
-												 */
-				int decodeDstSize = tea_decrypt((DWORD *) (m_recvBuf + m_recvBufInputPos),
-												(DWORD *) m_recvTEABuf,
-												(const DWORD *) m_szDecryptKey,
-												decodeSize);
-
-				m_recvBufInputPos += decodeDstSize;
-
-				if (m_recvTEABufInputPos>decodeSize)
-					memmove(m_recvTEABuf, m_recvTEABuf+decodeSize, m_recvTEABufInputPos-decodeSize);
-
-				m_recvTEABufInputPos -= decodeSize;
-				
-				
-				//Tracenf("!!!!!! decrypt decodeSrcSize %d -> decodeDstSize %d (recvOutputPos %d, recvInputPos %d, teaInputPos %d)", 
-				//		decodeSize, decodeDstSize, m_recvBufOutputPos, m_recvBufInputPos, m_recvTEABufInputPos);
-			}
+			m_cipher.Encrypt(pcSpan, iSpanSize);
+			m_dwSendEncodePos += iSpanSize;
 		}
 	}
-	else
+#else
+	if (IsSecurityMode())
 	{
-		int restSize = m_recvBufSize - m_recvBufInputPos;
-		if (restSize>0)
-		{		
-			int recvSize = recv(m_sock, m_recvBuf + m_recvBufInputPos, m_recvBufSize - m_recvBufInputPos, 0);	
-			//Tracenf("RECV %d %d(%d, %d)", recvSize, restSize, m_recvTEABufSize - m_recvTEABufInputPos, m_recvBufSize - m_recvBufInputPos);
+		// padded to whole blocks with zero bytes as tea_encrypt always did, the receiver skips 0 headers
+		int padSize = (8 - (m_kSendBuf.GetInputPos() - m_dwSendEncodePos) % 8) % 8;
+		if (padSize <= m_kSendBuf.GetFreeSize())
+		{
+			static const char sc_acZero[8] = {};
+			m_kSendBuf.Write(padSize, sc_acZero);
+		}
 
-			if (recvSize < 0)
-			{
-				int error = WSAGetLastError();
+		int encodeSize = (m_kSendBuf.GetInputPos() - m_dwSendEncodePos) & ~7;
 
-				if (error != WSAEWOULDBLOCK)
-				{
-					return false;
-				}
-			}
-			else if (recvSize == 0)
-			{
-				return false;
-			}
-
-			m_recvBufInputPos += recvSize;
-		}
+		__TeaRingBuffer(m_kSendBuf, m_dwSendEncodePos, encodeSize, tea_encrypt, m_szEncryptKey);
+		m_dwSendEncodePos += encodeSize;
 	}
 #endif // _IMPROVED_PACKET_ENCRYPTION_
-		
-	//Tracef("recvSize: %d input pos %d output pos %d\n", recvSize, m_recvBufInputPos, m_recvBufOutputPos);			
 
-	return true;
+	if (!IsSecurityMode())
+		m_dwSendEncodePos = m_kSendBuf.GetInputPos();
 }
 
-
 bool CNetworkStream::__SendInternalBuffer()
 {
-#ifdef _IMPROVED_PACKET_ENCRYPTION_
-	int dataSize=__GetSendBufferSize();
-	if (dataSize<=0)
+	if (__GetSendBufferSize() <= 0)
 		return true;
 
-	if (IsSecurityMode()) {
-		m_cipher.Encrypt(m_sendBuf + m_sendBufOutputPos, dataSize);
-	}
-
-	int sendSize = send(m_sock, m_sendBuf+m_sendBufOutputPos, dataSize, 0);	
-	if (sendSize < 0)
-		return false;
+	// bytes are encrypted once, when they first reach this point, whatever part of them send takes
+	__EncodeSendBuffer();
 
-	m_sendBufOutputPos+=sendSize;
+	// both spans of the ring go out in one gathered send
+	WSABUF akBuf[2];
+	DWORD dwBufCount = 0;
 
-	__PopSendBuffer();
-#else
-	if (IsSecurityMode())
+	DWORD dwPos = m_kSendBuf.GetOutputPos();
+	while (dwPos != m_dwSendEncodePos)
 	{
-		int encodeSize=__GetSendBufferSize();
-		if (encodeSize<=0)
-			return true;
-
-		m_sendTEABufInputPos += tea_encrypt((DWORD *) (m_sendTEABuf + m_sendTEABufInputPos),
-												 (DWORD *) (m_sendBuf + m_sendBufOutputPos),
-												 (const DWORD *) m_szEncryptKey,
-												 encodeSize);
-		m_sendBufOutputPos += encodeSize;
-
-		if (m_sendTEABufInputPos>0)
-		{	
-			int sendSize = send(m_sock, m_sendTEABuf, m_sendTEABufInputPos, 0);	
-			if (sendSize < 0)
-				return false;
+		int iSpanSize;
+		akBuf[dwBufCount].buf = m_kSendBuf.GetSpan(dwPos, m_dwSendEncodePos, &iSpanSize);
+		akBuf[dwBufCount].len = iSpanSize;
 
-			if (m_sendTEABufInputPos>sendSize)
-				memmove(m_sendTEABuf, m_sendTEABuf+sendSize, m_sendTEABufInputPos-sendSize);
+		++dwBufCount;
+		dwPos += iSpanSize;
+	}
 
-			m_sendTEABufInputPos-=sendSize;			
-		}
+	if (!dwBufCount)
+		return true;
 
-		__PopSendBuffer();
-	}
-	else
-	{
-		int dataSize=__GetSendBufferSize();
-		if (dataSize<=0)
-			return true;
+	DWORD dwSendSize = 0;
 
-		int sendSize = send(m_sock, m_sendBuf+m_sendBufOutputPos, dataSize, 0);	
-		if (sendSize < 0)
-			return false;
+	++m_kSendStat.dwSendCount;
+	++m_dwFrameSendCount;
 
-		m_sendBufOutputPos+=sendSize;
+	if (WSASend(m_sock, akBuf, dwBufCount, &dwSendSize, 0, NULL, NULL) == SOCKET_ERROR)
+	{
+		if (WSAGetLastError() == WSAEWOULDBLOCK)
+			++m_kSendStat.dwWouldBlockCount;
 
-		__PopSendBuffer();
+		return false;
 	}
-#endif // _IMPROVED_PACKET_ENCRYPTION_
 
+	m_kSendBuf.Skip(dwSendSize);
+
+	m_kSendStat.ullSendSize += dwSendSize;
+	m_kSendStat.dwLastSendSize = dwSendSize;
+	m_kSendStat.dwMaxSendSize = std::max(m_kSendStat.dwMaxSendSize, dwSendSize);
 	return true;
 }
 
-void CNetworkStream::__PopSendBuffer()
+void CNetworkStream::__EndSendFrame()
 {
-	if (m_sendBufOutputPos<=0)
-		return;
-		
-	int sendBufDataSize = m_sendBufInputPos - m_sendBufOutputPos;
+	m_kSendStat.dwFrameCount++;
+	m_kSendStat.dwLastFrameSendCount = m_dwFrameSendCount;
+	m_kSendStat.dwMaxFrameSendCount = std::max(m_kSendStat.dwMaxFrameSendCount, m_dwFrameSendCount);
 
-	if (sendBufDataSize>0)
-	{
-		memmove(m_sendBuf, m_sendBuf+m_sendBufOutputPos, sendBufDataSize);
-	}
+	m_dwFrameSendCount = 0;
+}
+
+bool CNetworkStream::Flush()
+{
+	if (m_sock == INVALID_SOCKET || !m_isOnline)
+		return true;
+
+	if (__SendInternalBuffer())
+		return true;
+
+	// a full socket buffer keeps the rest queued for the next flush
+	if (WSAGetLastError() == WSAEWOULDBLOCK)
+		return true;
 
-	m_sendBufInputPos = sendBufDataSize;
-	m_sendBufOutputPos = 0;	
+	OnRemoteDisconnect();
+	Clear();
+	return false;
+}
+
+const CNetworkStream::TSendStat & CNetworkStream::GetSendStat() const
+{
+	return m_kSendStat;
 }
 
 #pragma warning(push)
@@ -291,31 +287,20 @@ void CNetworkStream::Process()
 	if (m_sock == INVALID_SOCKET)
 		return;
 
-	fd_set fdsRecv;
-	fd_set fdsSend;
+	__EndSendFrame();
 
-	FD_ZERO(&fdsRecv);
-	FD_ZERO(&fdsSend);
-
-	FD_SET(m_sock, &fdsRecv);
-	FD_SET(m_sock, &fdsSend);
-
-	TIMEVAL delay;
-
-	delay.tv_sec = 0;
-	delay.tv_usec = 0;
-	
-	if (select(0, &fdsRecv, &fdsSend, NULL, &delay) == SOCKET_ERROR)
+	short sEvents;
+	if (!__PollEvents(&sEvents))
 		return;
 
 	if (!m_isOnline)
 	{
-		if (FD_ISSET(m_sock, &fdsSend))
+		if (sEvents & POLLWRNORM)
 		{
 			m_isOnline = true;
 			OnConnectSuccess();
 		}
-		else if (time(NULL) > m_connectLimitTime)
+		else if ((sEvents & (POLLERR | POLLHUP)) || time(NULL) > m_connectLimitTime)
 		{
 			Clear();
 			OnConnectFailure();
@@ -324,22 +309,15 @@ void CNetworkStream::Process()
 		return;
 	}
 
-	if (FD_ISSET(m_sock, &fdsSend) && (m_sendBufInputPos > m_sendBufOutputPos))
+	// whatever the last Flush left behind, streams without their own flush point send everything here
+	if ((sEvents & POLLWRNORM) && __GetSendBufferSize() > 0)
 	{
-		if (!__SendInternalBuffer())
-		{
-			int error = WSAGetLastError();
-
-			if (error != WSAEWOULDBLOCK)
-			{
-				OnRemoteDisconnect();
-				Clear();
-				return;
-			}
-		}
+		if (!Flush())
+			return;
 	}
 
-	if (FD_ISSET(m_sock, &fdsRecv))
+	// a closed or failed connection is found by the recv
+	if (sEvents & (POLLRDNORM | POLLHUP | POLLERR))
 	{
 		if (!__RecvInternalBuffer())
 		{
@@ -357,6 +335,27 @@ void CNetworkStream::Process()
 }
 #pragma warning(pop)
 
+bool CNetworkStream::__PollEvents(short * psEvents)
+{
+	CNetworkReactor * pkReactor = CNetworkReactor::InstancePtr();
+	if (pkReactor && pkReactor->PopEvents(m_sock, psEvents))
+		return true;
+
+	if (pkReactor)
+		pkReactor->OnSelfPoll();
+
+	WSAPOLLFD kPollFD;
+	kPollFD.fd = m_sock;
+	kPollFD.events = POLLRDNORM | POLLWRNORM;
+	kPollFD.revents = 0;
+
+	if (WSAPoll(&kPollFD, 1, 0) == SOCKET_ERROR)
+		return false;
+
+	*psEvents = kPollFD.revents;
+	return true;
+}
+
 void CNetworkStream::Disconnect()
 {
 	if (m_sock == INVALID_SOCKET)
@@ -376,6 +375,9 @@ void CNetworkStream::Clear()
 	m_cipher.CleanUp();
 #endif
 
+	if (CNetworkReactor * pkReactor = CNetworkReactor::InstancePtr())
+		pkReactor->Unregister(this);
+
 	closesocket(m_sock);
 	m_sock = INVALID_SOCKET;
 
@@ -389,14 +391,11 @@ void CNetworkStream::Clear()
 	m_isOnline = false;
 	m_connectLimitTime = 0;
 
-	m_recvTEABufInputPos = 0;
-	m_sendTEABufInputPos = 0;
+	m_kRecvBuf.Clear();
+	m_dwRecvDecodePos = 0;
 
-	m_recvBufInputPos = 0;	
-	m_recvBufOutputPos = 0;
-	
-	m_sendBufInputPos = 0;	
-	m_sendBufOutputPos = 0;
+	m_kSendBuf.Clear();
+	m_dwSendEncodePos = 0;
 
 	m_SequenceGenerator.seed(SEQUENCE_SEED);
 }
@@ -433,6 +432,10 @@ bool CNetworkStream::Connect(const CNetworkAddress& c_rkNetAddr, int limitSec)
 	}
 
 	m_connectLimitTime = time(NULL) + limitSec;
+
+	if (CNetworkReactor * pkReactor = CNetworkReactor::InstancePtr())
+		pkReactor->Register(this);
+
 	return true;	
 }
 
@@ -462,12 +465,13 @@ bool CNetworkStream::Connect(const char* c_szAddr, int port, int /*limitSec*/)
 
 void CNetworkStream::ClearRecvBuffer()
 {
-	m_recvBufOutputPos = m_recvBufInputPos = 0;	 
+	// a partial TEA block behind the readable bytes belongs to what comes next
+	m_kRecvBuf.Skip(GetRecvBufferSize());
 }
 
 int CNetworkStream::GetRecvBufferSize()
 {
-	return m_recvBufInputPos - m_recvBufOutputPos;
+	return m_dwRecvDecodePos - m_kRecvBuf.GetOutputPos();
 }
 
 bool CNetworkStream::Peek(int size)
@@ -483,7 +487,7 @@ bool CNetworkStream::Peek(int size, char * pDestBuf)
 	if (GetRecvBufferSize() < size)
 		return false;
 
-	memcpy(pDestBuf, m_recvBuf + m_recvBufOutputPos, size);
+	m_kRecvBuf.CopyOut(m_kRecvBuf.GetOutputPos(), size, pDestBuf);
 	return true;
 }
 
@@ -721,7 +725,7 @@ bool CNetworkStream::Recv(int size)
 	if (!Peek(size))
 		return false;
 
-	m_recvBufOutputPos += size;
+	m_kRecvBuf.Skip(size);
 	return true;
 }
 
@@ -758,24 +762,22 @@ bool CNetworkStream::Recv(int size, char * pDestBuf)
 	}
 #endif
 
-	m_recvBufOutputPos += size;
+	m_kRecvBuf.Skip(size);
 	return true;
 }
 
 int CNetworkStream::__GetSendBufferSize()
 {
-	return m_sendBufInputPos-m_sendBufOutputPos;
+	return m_kSendBuf.GetUsedSize();
 }
 
 
 bool CNetworkStream::Send(int size, const char * pSrcBuf)
 {
-	int sendBufRestSize = m_sendBufSize - m_sendBufInputPos;
-	if ((size + 1) > sendBufRestSize)
+	if ((size + 1) > m_kSendBuf.GetFreeSize())
 		return false;
 
-	memcpy(m_sendBuf + m_sendBufInputPos, pSrcBuf, size);
-	m_sendBufInputPos += size;
+	m_kSendBuf.Write(size, pSrcBuf);
 
 #ifdef _PACKETDUMP
 	if (*pSrcBuf != 0)
@@ -836,6 +838,11 @@ bool CNetworkStream::IsOnline()
 	return m_isOnline;
 }
 
+SOCKET CNetworkStream::GetSocket() const
+{
+	return m_sock;
+}
+
 void CNetworkStream::SetPacketSequenceMode(bool isOn)
 {
 	m_bUseSequence = isOn;
@@ -891,23 +898,11 @@ CNetworkStream::CNetworkStream()
 	m_isOnline = false;
 	m_connectLimitTime = 0;
 
-	m_recvTEABuf = NULL;
-	m_recvTEABufSize = 0;
-	m_recvTEABufInputPos = 0;
-	
-	m_recvBuf = NULL;	
-	m_recvBufSize = 0;	
-	m_recvBufOutputPos = 0;
-	m_recvBufInputPos = 0;	
-
-	m_sendTEABuf = NULL;
-	m_sendTEABuf = 0;
-	m_sendTEABufInputPos = 0;
+	m_dwRecvDecodePos = 0;
+	m_dwSendEncodePos = 0;
 
-	m_sendBuf = NULL;	
-	m_sendBufSize = 0;	
-	m_sendBufOutputPos = 0;
-	m_sendBufInputPos = 0;
+	memset(&m_kSendStat, 0, sizeof(m_kSendStat));
+	m_dwFrameSendCount = 0;
 
 	m_SequenceGenerator.seed(SEQUENCE_SEED);
 	m_bUseSequence = false;
@@ -916,30 +911,6 @@ CNetworkStream::CNetworkStream()
 CNetworkStream::~CNetworkStream()
 {
 	Clear();
-
-	if (m_sendTEABuf)
-	{
-		delete [] m_sendTEABuf;
-		m_sendTEABuf=NULL;
-	}
-
-	if (m_recvTEABuf)
-	{
-		delete [] m_recvTEABuf;
-		m_recvTEABuf=NULL;
-	}
-
-	if (m_recvBuf)
-	{
-		delete [] m_recvBuf;
-		m_recvBuf=NULL;
-	}
-
-	if (m_sendBuf)
-	{
-		delete [] m_sendBuf;
-		m_sendBuf=NULL;
-	}
 }
 
 #ifdef _IMPROVED_PACKET_ENCRYPTION_
@@ -964,10 +935,16 @@ void CNetworkStream::DecryptAlreadyReceivedData()
 	if (!IsSecurityMode())
 		return;
 
-	const int unreadSize = m_recvBufInputPos - m_recvBufOutputPos;
-	if (unreadSize <= 0)
-		return;
+	DWORD dwPos = m_kRecvBuf.GetOutputPos();
+	DWORD dwInputPos = m_kRecvBuf.GetInputPos();
+
+	while (dwPos != dwInputPos)
+	{
+		int iSpanSize;
+		char * pcSpan = m_kRecvBuf.GetSpan(dwPos, dwInputPos, &iSpanSize);
 
-	m_cipher.Decrypt(m_recvBuf + m_recvBufOutputPos, unreadSize);
+		m_cipher.Decrypt(pcSpan, iSpanSize);
+		dwPos += iSpanSize;
+	}
 }
 #endif // _IMPROVED_PACKET_ENCRYPTION_
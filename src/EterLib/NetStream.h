@@ -5,6 +5,7 @@
 #endif
 #include "EterBase/tea.h"
 #include "NetAddress.h"
+#include "NetRingBuffer.h"
 
 #include <pcg_random.hpp>
 
@@ -12,6 +13,20 @@
 
 class CNetworkStream
 {
+	public:
+		typedef struct SSendStat
+		{
+			DWORD		dwFrameCount;
+			DWORD		dwSendCount;			// send syscalls
+			DWORD		dwLastFrameSendCount;
+			DWORD		dwMaxFrameSendCount;
+			DWORD		dwWouldBlockCount;
+
+			ULONGLONG	ullSendSize;			// bytes, summed over all sends
+			DWORD		dwLastSendSize;
+			DWORD		dwMaxSendSize;
+		} TSendStat;
+
 	public:
 		CNetworkStream();
 		virtual ~CNetworkStream();		
@@ -49,7 +64,13 @@ class CNetworkStream
 		bool Send(int len, const void* pSrcBuf);
 		bool SendFlush(int len, const void* pSrcBuf);
 
+		// sends what the frame queued in one call, the frame's owner calls it once all packets are written
+		bool Flush();
+
+		const TSendStat & GetSendStat() const;
+
 		bool IsOnline();
+		SOCKET GetSocket() const;
 
 		void SetPacketSequenceMode(bool isOn);
 		bool SendSequence();
@@ -64,9 +85,13 @@ class CNetworkStream
 		bool __SendInternalBuffer();
 		bool __RecvInternalBuffer();
 
-		void __PopSendBuffer();
+		void __DecodeRecvBuffer();
+		void __EncodeSendBuffer();
 
 		int __GetSendBufferSize();
+		void __EndSendFrame();
+
+		bool __PollEvents(short * psEvents);
 
 #ifdef _IMPROVED_PACKET_ENCRYPTION_
 		size_t Prepare(void* buffer, size_t* length);
@@ -78,26 +103,16 @@ class CNetworkStream
 	private:
 		time_t	m_connectLimitTime;
 
-		char*	m_recvTEABuf;
-		int		m_recvTEABufInputPos;
-		int		m_recvTEABufSize;
-
-		char*	m_recvBuf;
-		int		m_recvBufSize;
-		int		m_recvBufInputPos;
-		int		m_recvBufOutputPos;
-
-		char*	m_sendBuf;
-		int		m_sendBufSize;
-		int		m_sendBufInputPos;
-		int		m_sendBufOutputPos;
-
-		char*	m_sendTEABuf;
-		int		m_sendTEABufSize;
-		int		m_sendTEABufInputPos;
+		CNetworkRingBuffer	m_kRecvBuf;
+		DWORD				m_dwRecvDecodePos;	// up to here the received bytes are plain and readable
+		CNetworkRingBuffer	m_kSendBuf;
+		DWORD				m_dwSendEncodePos;	// up to here the queued bytes are encrypted and ready to go
 
 		bool	m_isOnline;
 
+		TSendStat	m_kSendStat;
+		DWORD		m_dwFrameSendCount;
+
 #ifdef _IMPROVED_PACKET_ENCRYPTION_
 		Cipher	m_cipher;
 #else
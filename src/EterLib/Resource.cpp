@@ -9,13 +9,16 @@
 
 bool CResource::ms_bDeleteImmediately = false;
 
-CResource::CResource(const char* c_szFileName) : me_state(STATE_EMPTY)
+CResource::CResource(const char* c_szFileName) : me_state(STATE_EMPTY), m_isLooseFile(false), m_iStatIndex(-1)
 {
+	memset(m_auMemorySize, 0, sizeof(m_auMemorySize));
 	SetFileName(c_szFileName);
 }
 
 CResource::~CResource()
 {
+	static const size_t c_auEmpty[MEMORY_TYPE_NUM] = {};
+	__SetMemorySize(c_auEmpty);
 }
 
 void CResource::SetDeleteImmediately(bool isSet)
@@ -45,17 +48,24 @@ void CResource::Load()
 
 	DWORD		dwStart = ELTimer_GetMSec();
 	TPackFile	file;
+	TPackFileView	view;
 
 	//Tracenf("Load %s", c_szFileName);
 
-	if (CPackManager::Instance().GetFile(c_szFileName, file))
+	if (CPackManager::Instance().GetFileView(c_szFileName, view, file, m_isLooseFile))
 	{
 		m_dwLoadCostMiliiSecond = ELTimer_GetMSec() - dwStart;
 		//Tracef("CResource::Load %s (%d bytes) in %d ms\n", c_szFileName, file.Size(), m_dwLoadCostMiliiSecond);
 
-		if (OnLoad(file.size(), file.data()))
+		ULONGLONG ullLoadStart = ELTimer_GetUSec();
+		bool bLoaded = OnLoad(view.size(), view.data());
+		if (CResourceManager::InstancePtr())
+			CResourceManager::Instance().AddLoadTime(this, CResourceManager::LOAD_STAGE_MAIN, ELTimer_GetUSec() - ullLoadStart);
+
+		if (bLoaded)
 		{
 			me_state = STATE_EXIST;
+			UpdateMemorySize(view.size());
 		}
 		else
 		{
@@ -82,11 +92,13 @@ void CResource::Reload()
 	Tracef("CResource::Reload %s\n", GetFileName());
 
 	TPackFile	file;
-	if (CPackManager::Instance().GetFile(GetFileName(), file))
+	TPackFileView	view;
+	if (CPackManager::Instance().GetFileView(GetFileName(), view, file, m_isLooseFile))
 	{
-		if (OnLoad(file.size(), file.data()))
+		if (OnLoad(view.size(), view.data()))
 		{
 			me_state = STATE_EXIST;
+			UpdateMemorySize(view.size());
 		}
 		else
 		{
@@ -105,6 +117,34 @@ void CResource::Reload()
 	}
 }
 
+bool CResource::Finalize(CDecodedData * pData, int iSize, const void * c_pvBuf)
+{
+	// loaded synchronously while the request was on its way
+	if (me_state != STATE_EMPTY)
+		return STATE_EXIST == me_state;
+
+	if (!OnFinalize(pData, iSize, c_pvBuf))
+	{
+		Tracef("CResource::Finalize Error %s\n", GetFileName());
+		me_state = STATE_ERROR;
+		return false;
+	}
+
+	me_state = STATE_EXIST;
+	UpdateMemorySize(iSize);
+	return true;
+}
+
+CResource::CDecodedData * CResource::OnDecode(int /*iSize*/, const void * /*c_pvBuf*/) const
+{
+	return NULL;
+}
+
+bool CResource::OnFinalize(CDecodedData * /*pData*/, int iSize, const void * c_pvBuf)
+{
+	return OnLoad(iSize, c_pvBuf);
+}
+
 CResource::TType CResource::StringToType(const char* c_szType)
 {
 	return GetCRC32(c_szType, strlen(c_szType));
@@ -136,8 +176,44 @@ void CResource::SetFileName(const char* c_szFileName)
 
 void CResource::Clear()
 {
+	static const size_t c_auEmpty[MEMORY_TYPE_NUM] = {};
+
 	OnClear();
 	me_state = STATE_EMPTY;
+	__SetMemorySize(c_auEmpty);
+}
+
+size_t CResource::GetTotalMemorySize() const
+{
+	size_t uSize = 0;
+	for (int i = 0; i < MEMORY_TYPE_NUM; ++i)
+		uSize += m_auMemorySize[i];
+
+	return uSize;
+}
+
+void CResource::UpdateMemorySize(int iFileSize)
+{
+	size_t auSize[MEMORY_TYPE_NUM] = {};
+	OnGetMemorySize(iFileSize, auSize);
+	__SetMemorySize(auSize);
+}
+
+void CResource::OnGetMemorySize(int iFileSize, size_t * auSize) const
+{
+	auSize[MEMORY_DATA] = iFileSize;
+}
+
+void CResource::__SetMemorySize(const size_t * c_auSize)
+{
+	if (!memcmp(m_auMemorySize, c_auSize, sizeof(m_auMemorySize)))
+		return;
+
+	// resources can outlive the manager at shutdown, nothing is left to account for then
+	if (CResourceManager::InstancePtr())
+		CResourceManager::Instance().OnResourceMemoryChanged(this, m_auMemorySize, c_auSize);
+
+	memcpy(m_auMemorySize, c_auSize, sizeof(m_auMemorySize));
 }
 
 bool CResource::IsType(TType type)
@@ -17,6 +17,22 @@ class CResource : public CReferenceObject
 			STATE_FREE
 		};
 
+		// what the bytes a resource holds are spent on, see GetMemorySize
+		enum EMemoryType
+		{
+			MEMORY_TEXTURE,
+			MEMORY_VERTEX_BUFFER,
+			MEMORY_DATA,
+			MEMORY_TYPE_NUM
+		};
+
+		// CPU side result of OnDecode, whatever the resource type needs to hand over to its OnFinalize
+		class CDecodedData
+		{
+			public:
+				virtual ~CDecodedData() {}
+		};
+
 	public:
 		void			Clear();
 
@@ -42,12 +58,30 @@ class CResource : public CReferenceObject
 		bool			IsType(TType type);
 
 		DWORD			GetLoadCostMilliSecond()	{ return m_dwLoadCostMiliiSecond;	}
+
+		// read from the disk rather than the packs, set before the first load (guild marks the client writes)
+		void			SetLooseFile(bool isLooseFile)	{ m_isLooseFile = isLooseFile;	}
+		bool			IsLooseFile() const			{ return m_isLooseFile;			}
+
+		// CResourceManager's stat bucket for the file extension, found once when the resource is registered
+		void			SetStatIndex(int iStatIndex)	{ m_iStatIndex = iStatIndex;	}
+		int				GetStatIndex() const		{ return m_iStatIndex;			}
+
+		// bytes held since the last load, reported to CResourceManager for its memory budget
+		size_t			GetMemorySize(int iType) const	{ return m_auMemorySize[iType];	}
+		size_t			GetTotalMemorySize() const;
+		void			UpdateMemorySize(int iFileSize);
 		//const char *	GetFileName() const			{ return m_pszFileName;				}
 		const char *	GetFileName() const			{ return m_stFileName.c_str();				}
 		const std::string& GetFileNameString() const { return m_stFileName;	}
 
 		virtual bool	OnLoad(int iSize, const void * c_pvBuf) = 0;
 
+		// Background loading in two steps, Decode on a loader thread and Finalize on the main thread afterwards.
+		// Finalize does what Load does with the file, but starts from the decoded data when there is some.
+		CDecodedData *	Decode(int iSize, const void * c_pvBuf) const	{ return OnDecode(iSize, c_pvBuf);	}
+		bool			Finalize(CDecodedData * pData, int iSize, const void * c_pvBuf);
+
 	protected:
 		void			SetFileName(const char* c_szFileName);
 
@@ -55,14 +89,28 @@ class CResource : public CReferenceObject
 		virtual bool	OnIsEmpty() const = 0;
 		virtual bool	OnIsType(TType type) = 0;
 
+		// Runs on a loader thread while the main thread keeps using the resource, so it may only work on the
+		// bytes it is given and must not touch the members or the device. NULL leaves everything to OnFinalize.
+		virtual CDecodedData *	OnDecode(int iSize, const void * c_pvBuf) const;
+		// main thread, pData is NULL if there was no decode step, by default the file goes through OnLoad
+		virtual bool	OnFinalize(CDecodedData * pData, int iSize, const void * c_pvBuf);
+
 		virtual void	OnConstruct();
 		virtual void	OnSelfDestruct();
 
+		// fills auSize[MEMORY_TYPE_NUM] after a load, by default the loaded file is counted as data
+		virtual void	OnGetMemorySize(int iFileSize, size_t * auSize) const;
+
+		void			__SetMemorySize(const size_t * c_auSize);
+
 	protected:
 		std::string		m_stFileName;
 		//char *			m_pszFileName;
 		DWORD			m_dwLoadCostMiliiSecond;
 		EState			me_state;
+		bool			m_isLooseFile;
+		int				m_iStatIndex;
+		size_t			m_auMemorySize[MEMORY_TYPE_NUM];
 
 	protected:
 		static bool		ms_bDeleteImmediately;
@@ -1,6 +1,5 @@
 #include "StdAfx.h"
 #include <io.h>
-#include "EterBase/CRC32.h"
 #include "EterBase/Timer.h"
 #include "EterBase/Stl.h"
 #include "PackLib/PackManager.h"
@@ -8,13 +7,21 @@
 #include "ResourceManager.h"
 #include "GrpImage.h"
 
-int g_iLoadingDelayTime = 20;
+int g_iResourceMemoryBudget = sizeof(void *) == 4 ? 384 : 1024;	// the 32 bit client has to leave room for everything else
 
 const long c_Deleting_Wait_Time = 30000;			// 삭제 대기 시간 (30초)
 const long c_DeletingCountPerFrame = 30;			// 프레임당 체크 리소스 갯수
 const long c_Reference_Decrease_Wait_Time = 30000;	// 선로딩 리소스의 해제 대기 시간 (30초)
+const long c_Budget_Check_Time = 1000;				// how often an exceeded budget is looked at again
+const ULONGLONG c_Load_Time_Bucket_Base = 250;		// microseconds, upper bound of the first histogram bucket
 
-CFileLoaderThread CResourceManager::ms_loadingThread;
+// what the decode step of a background request leaves for __OnBackgroundLoaded, shared by both so that
+// data of a request cancelled in between is freed by whichever of them lets go last
+typedef struct SBackgroundDecode
+{
+	std::unique_ptr<CResource::CDecodedData>	pData;
+	ULONGLONG									ullDecodeTime = 0;
+} TBackgroundDecode;
 
 void CResourceManager::LoadStaticCache(const char* c_szFileName)
 {
@@ -25,64 +32,54 @@ void CResourceManager::LoadStaticCache(const char* c_szFileName)
 		return;
 	}
 
-	DWORD dwCacheKey=GetCRC32(c_szFileName, strlen(c_szFileName));
-	TResourcePointerMap::iterator f=m_pCacheMap.find(dwCacheKey);
-	if (m_pCacheMap.end()!=f)
+	uint64_t ullCacheKey=TResourcePointerMap::Hash(c_szFileName);
+	if (m_pCacheMap.Find(ullCacheKey, c_szFileName))
 		return;
 
 	pkRes->AddReference();
-	m_pCacheMap.insert(TResourcePointerMap::value_type(dwCacheKey, pkRes));	
-
+	m_pCacheMap.Insert(ullCacheKey, pkRes->GetFileNameString(), pkRes);
 }
 
 void CResourceManager::ProcessBackgroundLoading()
 {
-	TResourceRequestMap::iterator itor = m_RequestMap.begin();
-
-	while (itor != m_RequestMap.end())
+	m_RequestMap.ForEach([this](uint64_t ullFileHash, const std::string & c_rstName, std::string & stFileName)
 	{
-		DWORD dwFileCRC = itor->first;
-		std::string & stFileName = itor->second;
+		CResource * pResource = __FindResourcePointer(ullFileHash, c_rstName.c_str());
 
-		if (isResourcePointerData(dwFileCRC) ||
-			(m_WaitingMap.end() != m_WaitingMap.find(dwFileCRC)))
+		if ((pResource && pResource->IsData()) || m_WaitingMap.Find(ullFileHash, c_rstName.c_str()))
 		{
 			//printf("SKP %s\n", stFileName.c_str());
-			itor = m_RequestMap.erase(itor);
-			continue;
+			return;
 		}
 
-		//printf("REQ %s\n", stFileName.c_str());
-		ms_loadingThread.Request(stFileName);
-		m_WaitingMap.insert(TResourceRequestMap::value_type(dwFileCRC, stFileName));
-		itor = m_RequestMap.erase(itor);
-		//break; // NOTE: 여기서 break 하면 천천히 로딩 된다.
-	}
+		// created now (still empty) so the loader thread has the resource to decode for,
+		// resources are only ever deleted in Destroy, after the loader threads are gone
+		if (!pResource)
+			pResource = GetResourcePointer(stFileName.c_str());
 
-	DWORD dwCurrentTime = ELTimer_GetMSec();
+		if (!pResource)
+			return;
 
-	CFileLoaderThread::TData * pData;
-	while (ms_loadingThread.Fetch(&pData))
-	{
-		//printf("LOD %s\n", pData->stFileName.c_str());
-		CResource * pResource = GetResourcePointer(pData->stFileName.c_str());
+		std::shared_ptr<TBackgroundDecode> pkDecode = std::make_shared<TBackgroundDecode>();
 
-		if (pResource)
+		//printf("REQ %s\n", stFileName.c_str());
+		TPackRequestID requestID = CPackManager::Instance().RequestAsync(stFileName, [this, ullFileHash, pkDecode](const std::string & c_rstFileName, bool bSuccess, TPackFile & rFile)
 		{
-			if (pResource->IsEmpty())
-			{				
-				pResource->OnLoad(pData->File.size(), pData->File.data());
-				pResource->AddReferenceOnly();
+			__OnBackgroundLoaded(ullFileHash, c_rstFileName, bSuccess, rFile, pkDecode->pData.get(), pkDecode->ullDecodeTime);
+		}, 0, [pResource, pkDecode](const std::string & /*c_rstFileName*/, TPackFile & rFile)	// called in loader thread
+		{
+			ULONGLONG ullStart = ELTimer_GetUSec();
+			pkDecode->pData.reset(pResource->Decode(rFile.size(), rFile.data()));
+			pkDecode->ullDecodeTime = ELTimer_GetUSec() - ullStart;
+		}, pResource->IsLooseFile());
 
-				// 여기서 올라간 레퍼런스 카운트를 일정 시간이 지난 뒤에 풀어주기 위하여
-				m_pResRefDecreaseWaitingMap.insert(TResourceRefDecreaseWaitingMap::value_type(dwCurrentTime, pResource));
-			}
-		}
+		m_WaitingMap.Insert(ullFileHash, c_rstName, requestID);
+	});
 
-		m_WaitingMap.erase(GetCRC32(pData->stFileName.c_str(), pData->stFileName.size()));
+	m_RequestMap.Clear();
 
-		delete pData;
-	}
+	// completed requests are handed to __OnBackgroundLoaded here, in one batch per frame
+	CPackManager::Instance().DispatchAsyncCompletions();
 
 	// DO : 일정 시간이 지나고 난뒤 미리 로딩해 두었던 리소스의 레퍼런스 카운트를 감소 시킨다 - [levites]
 	long lCurrentTime = ELTimer_GetMSec();
@@ -107,35 +104,77 @@ void CResourceManager::ProcessBackgroundLoading()
 	}
 }
 
+void CResourceManager::__OnBackgroundLoaded(uint64_t ullFileHash, const std::string & c_rstFileName, bool bSuccess, TPackFile & rFile, CResource::CDecodedData * pData, ULONGLONG ullDecodeTime)	// called in main thread
+{
+	//printf("LOD %s\n", c_rstFileName.c_str());
+	CResource * pResource = __FindResourcePointer(ullFileHash, c_rstFileName.c_str());
+
+	if (pResource)
+	{
+		if (!bSuccess)
+		{
+			// nothing to finalize, the synchronous load reads it again or marks the resource STATE_ERROR
+			pResource->Load();
+		}
+		else if (!pResource->IsData())
+		{
+			if (pData)
+				AddLoadTime(pResource, LOAD_STAGE_DECODE, ullDecodeTime);
+
+			ULONGLONG ullStart = ELTimer_GetUSec();
+			pResource->Finalize(pData, rFile.size(), rFile.data());
+			AddLoadTime(pResource, pData ? LOAD_STAGE_FINALIZE : LOAD_STAGE_MAIN, ELTimer_GetUSec() - ullStart);
+
+			pResource->AddReferenceOnly();
+
+			// 여기서 올라간 레퍼런스 카운트를 일정 시간이 지난 뒤에 풀어주기 위하여
+			m_pResRefDecreaseWaitingMap.insert(TResourceRefDecreaseWaitingMap::value_type(ELTimer_GetMSec(), pResource));
+		}
+	}
+
+	m_WaitingMap.Erase(ullFileHash, c_rstFileName.c_str());
+}
+
+void CResourceManager::CancelBackgroundLoading()
+{
+	m_WaitingMap.ForEach([](uint64_t /*ullFileHash*/, const std::string & /*c_rstName*/, TPackRequestID & rRequestID)
+	{
+		CPackManager::Instance().CancelAsync(rRequestID);
+	});
+
+	m_WaitingMap.Clear();
+	m_RequestMap.Clear();
+}
+
 void CResourceManager::PushBackgroundLoadingSet(std::set<std::string> & LoadingSet)
 {
 	std::set<std::string>::iterator itor = LoadingSet.begin();
 
 	while (itor != LoadingSet.end())
 	{
-		DWORD dwFileCRC = __GetFileCRC(itor->c_str());
+		bool bNormalized;
+		uint64_t ullFileHash = TResourceRequestMap::Hash(itor->c_str(), &bNormalized);
 
-		if (NULL != isResourcePointerData(dwFileCRC))
+		CResource * pResource = __FindResourcePointer(ullFileHash, itor->c_str());
+		if (pResource && pResource->IsData())
 		{
 			++itor;
 			continue;
 		}
 
-		m_RequestMap.insert(TResourceRequestMap::value_type(dwFileCRC, itor->c_str()));
+		m_RequestMap.Insert(ullFileHash, __GetNormalizedFileName(itor->c_str(), bNormalized), *itor);
 		++itor;
 	}
 }
 
 void CResourceManager::__DestroyCacheMap()
 {
-	TResourcePointerMap::iterator i;
-	for (i = m_pCacheMap.begin(); i != m_pCacheMap.end(); ++i)
+	m_pCacheMap.ForEach([](uint64_t /*ullFileHash*/, const std::string & /*c_rstName*/, CResource * pResource)
 	{
-		CResource* pResource = i->second;
 		pResource->Release();
-	}
+	});
 
-	m_pCacheMap.clear();
+	m_pCacheMap.Clear();
 }
 
 void CResourceManager::__DestroyDeletingResourceMap()
@@ -149,16 +188,19 @@ void CResourceManager::__DestroyDeletingResourceMap()
 
 void CResourceManager::__DestroyResourceMap()
 {
-	Tracenf("CResourceManager::__DestroyResourceMap %d", m_pResMap.size());
+	Tracenf("CResourceManager::__DestroyResourceMap %d", m_pResMap.Size());
 
-	TResourcePointerMap::iterator i;
-	for (i = m_pResMap.begin(); i != m_pResMap.end(); ++i)
+	m_pResMap.ForEach([](uint64_t /*ullFileHash*/, const std::string & /*c_rstName*/, CResource * pResource)
 	{
-		CResource* pResource = i->second;
 		pResource->Clear();
-	}
+	});
 
-	stl_wipe_second(m_pResMap);
+	m_pResMap.ForEach([](uint64_t /*ullFileHash*/, const std::string & /*c_rstName*/, CResource * pResource)
+	{
+		delete pResource;
+	});
+
+	m_pResMap.Clear();
 }
 
 void CResourceManager::DestroyDeletingList()
@@ -186,19 +228,20 @@ void CResourceManager::RegisterResourceNewFunctionByTypePointer(int iType, CReso
 	m_pResNewFuncByTypeMap[iType] = pNewFunc;
 }
 
-CResource * CResourceManager::InsertResourcePointer(DWORD dwFileCRC, CResource* pResource)
+CResource * CResourceManager::InsertResourcePointer(uint64_t ullFileHash, CResource* pResource)
 {
-	TResourcePointerMap::iterator itor = m_pResMap.find(dwFileCRC);
+	CResource ** ppResource = m_pResMap.Find(ullFileHash, pResource->GetFileName());
 
-	if (m_pResMap.end() != itor)
+	if (ppResource)
 	{		
 		TraceError("CResource::InsertResourcePointer: %s is already registered\n", pResource->GetFileName());
 		assert(!"CResource::InsertResourcePointer: Resource already resistered");
 		delete pResource;
-		return itor->second;
+		return *ppResource;
 	}
 
-	m_pResMap.insert(TResourcePointerMap::value_type(dwFileCRC, pResource));
+	m_pResMap.Insert(ullFileHash, pResource->GetFileNameString(), pResource);
+	pResource->SetStatIndex(__GetStatIndex(pResource->GetFileName()));
 	return pResource;
 }
 
@@ -228,12 +271,24 @@ CResource * CResourceManager::GetTypeResourcePointer(const char * c_szFileName,
 		return NULL;
 	}
 
-	const char * c_pszFile;
-	DWORD dwFileCRC = __GetFileCRC(c_szFileName, &c_pszFile);
-	CResource * pResource = FindResourcePointer(dwFileCRC);
+	bool bNormalized;
+	uint64_t ullFileHash = TResourcePointerMap::Hash(c_szFileName, &bNormalized);
+	CResource * pResource = __FindResourcePointer(ullFileHash, c_szFileName);
 
 	if (pResource)	// 이미 리소스가 있으면 리턴 한다.
+	{
+		TResourceStat & rkStat = __GetStat(pResource);
+		if (pResource->IsData())
+			++rkStat.dwHitCount;
+		else
+			++rkStat.dwMissCount;
+
 		return pResource;
+	}
+
+	// only names not loaded yet are copied into their normalized form
+	const char * c_pszFile = __GetNormalizedFileName(c_szFileName, bNormalized);
+	++__GetStat(c_pszFile).dwMissCount;
 
 	CResource *	(*newFunc) (const char *) = NULL;
 
@@ -266,11 +321,11 @@ CResource * CResourceManager::GetTypeResourcePointer(const char * c_szFileName,
 		return NULL;
 	}
 
-	pResource = InsertResourcePointer(dwFileCRC, newFunc(c_pszFile));
+	pResource = InsertResourcePointer(ullFileHash, newFunc(c_pszFile));
 	return pResource;
 }
 
-CResource * CResourceManager::GetResourcePointer(const char * c_szFileName)
+CResource * CResourceManager::GetResourcePointer(const char * c_szFileName, bool bLooseFile)
 {
 	if (!c_szFileName || !*c_szFileName)
 	{
@@ -278,12 +333,24 @@ CResource * CResourceManager::GetResourcePointer(const char * c_szFileName)
 		return NULL;
 	}
 
-	const char * c_pszFile;
-	DWORD dwFileCRC = __GetFileCRC(c_szFileName, &c_pszFile);
-	CResource * pResource = FindResourcePointer(dwFileCRC);
+	bool bNormalized;
+	uint64_t ullFileHash = TResourcePointerMap::Hash(c_szFileName, &bNormalized);
+	CResource * pResource = __FindResourcePointer(ullFileHash, c_szFileName);
 
 	if (pResource)	// 이미 리소스가 있으면 리턴 한다.
+	{
+		TResourceStat & rkStat = __GetStat(pResource);
+		if (pResource->IsData())
+			++rkStat.dwHitCount;
+		else
+			++rkStat.dwMissCount;
+
 		return pResource;
+	}
+
+	// only names not loaded yet are copied into their normalized form
+	const char * c_pszFile = __GetNormalizedFileName(c_szFileName, bNormalized);
+	++__GetStat(c_pszFile).dwMissCount;
 
 	const char * pcFileExt = strrchr(c_pszFile, '.');
 
@@ -315,53 +382,50 @@ CResource * CResourceManager::GetResourcePointer(const char * c_szFileName)
 		return NULL;
 	}
 
-	pResource = InsertResourcePointer(dwFileCRC, newFunc(c_pszFile));
-	return pResource;
+	pResource = newFunc(c_pszFile);
+	pResource->SetLooseFile(bLooseFile);
+
+	return InsertResourcePointer(ullFileHash, pResource);
 }
 
-CResource * CResourceManager::FindResourcePointer(DWORD dwFileCRC)
+CResource * CResourceManager::FindResourcePointer(const char * c_szFileName)
 {
-	TResourcePointerMap::iterator itor = m_pResMap.find(dwFileCRC);
-
-	if (m_pResMap.end() == itor)
-		return NULL;
-
-	return itor->second;
+	return __FindResourcePointer(TResourcePointerMap::Hash(c_szFileName), c_szFileName);
 }
 
-bool CResourceManager::isResourcePointerData(DWORD dwFileCRC)
+CResource * CResourceManager::__FindResourcePointer(uint64_t ullFileHash, const char * c_szFileName)
 {
-	TResourcePointerMap::iterator itor = m_pResMap.find(dwFileCRC);
+	CResource ** ppResource = m_pResMap.Find(ullFileHash, c_szFileName);
 
-	if (m_pResMap.end() == itor)
+	if (!ppResource)
 		return NULL;
 
-	return (itor->second)->IsData();
+	return *ppResource;
 }
 
-DWORD CResourceManager::__GetFileCRC(const char * c_szFileName, const char ** c_ppszLowerFileName)
+bool CResourceManager::isResourcePointerData(const char * c_szFileName)
 {
-	static char s_szFullPathFileName[MAX_PATH];
-	const char * src = c_szFileName;
-	char * dst = s_szFullPathFileName;
-	int	len = 0;
+	CResource * pResource = FindResourcePointer(c_szFileName);
 
-	while (src[len])
-	{
-		if (src[len]=='/')
-			dst[len] = '\\';
-		else
-			dst[len] = (char) korean_tolower(src[len]);
+	if (!pResource)
+		return false;
 
-		++len;
-	}
+	return pResource->IsData();
+}
+
+const char * CResourceManager::__GetNormalizedFileName(const char * c_szFileName, bool bNormalized)
+{
+	if (bNormalized)
+		return c_szFileName;
 
-	dst[len] = '\0';
+	static char s_szFullPathFileName[MAX_PATH];
+	int len = 0;
 
-	if (c_ppszLowerFileName)
-		*c_ppszLowerFileName = &s_szFullPathFileName[0];
+	for (; c_szFileName[len] && len < MAX_PATH - 1; ++len)
+		s_szFullPathFileName[len] = TResourcePointerMap::NormalizeChar(c_szFileName[len]);
 
-	return (GetCRC32(s_szFullPathFileName, len));
+	s_szFullPathFileName[len] = '\0';
+	return s_szFullPathFileName;
 }
 
 typedef struct SDumpData
@@ -409,13 +473,12 @@ void CResourceManager::DumpFileListToTextFile(const char* c_szFileName)
 {
 	std::vector<TDumpData> dumpVector;
 
-	for (TResourcePointerMap::iterator i = m_pResMap.begin(); i != m_pResMap.end(); ++i)
+	m_pResMap.ForEach([&dumpVector](uint64_t /*ullFileHash*/, const std::string & /*c_rstName*/, CResource * pResource)
 	{
-		CResource* pResource = i->second;
 		TDumpData data;
 
 		if (pResource->IsEmpty())
-			continue;
+			return;
 		
 		data.filename = pResource->GetFileName();
 
@@ -443,7 +506,7 @@ void CResourceManager::DumpFileListToTextFile(const char* c_szFileName)
 		data.cost = pResource->GetLoadCostMilliSecond();
 
 		dumpVector.push_back(data);
-	}
+	});
 
 	FILE * fp = fopen(c_szFileName, "w");
 
@@ -465,6 +528,41 @@ void CResourceManager::DumpFileListToTextFile(const char* c_szFileName)
 		std::for_each(dumpVector.begin(), dumpVector.end(), DumpCostPrint);
 		fprintf(fp,	"total: %.2fmb", DumpPrint.m_totalKB / 1024.0f);
 
+		fprintf(fp, "\n\nmemory: %.2fmb budget: %.2fmb\n", m_uMemorySize / 1048576.0f, m_uMemoryBudget / 1048576.0f);
+		fprintf(fp, "%-6s %8s %8s %8s %8s %10s %10s %10s\n", "type", "hit", "miss", "expire", "evict", "texture", "vertex", "data");
+
+		for (TResourceStatIndexMap::iterator i = m_StatIndexMap.begin(); i != m_StatIndexMap.end(); ++i)
+		{
+			const TResourceStat & c_rkStat = m_kVct_kStat[i->second];
+			fprintf(fp, "%-6s %8u %8u %8u %8u %9.2fm %9.2fm %9.2fm\n", i->first.c_str(),
+				c_rkStat.dwHitCount, c_rkStat.dwMissCount, c_rkStat.dwExpireCount, c_rkStat.dwEvictCount,
+				c_rkStat.auMemorySize[CResource::MEMORY_TEXTURE] / 1048576.0f,
+				c_rkStat.auMemorySize[CResource::MEMORY_VERTEX_BUFFER] / 1048576.0f,
+				c_rkStat.auMemorySize[CResource::MEMORY_DATA] / 1048576.0f);
+		}
+
+		static const char * c_aszStageName[LOAD_STAGE_NUM] = { "main", "decode", "final" };
+
+		fprintf(fp, "\nload time (ms), loads per bucket: <0.25 <0.5 <1 <2 <4 <8 <16 >=16\n");
+
+		for (TResourceStatIndexMap::iterator i = m_StatIndexMap.begin(); i != m_StatIndexMap.end(); ++i)
+		{
+			const TResourceStat & c_rkStat = m_kVct_kStat[i->second];
+
+			for (int iStage = 0; iStage < LOAD_STAGE_NUM; ++iStage)
+			{
+				if (!c_rkStat.aullLoadTime[iStage])
+					continue;
+
+				fprintf(fp, "%-6s %-6s %10.1f", i->first.c_str(), c_aszStageName[iStage], c_rkStat.aullLoadTime[iStage] / 1000.0);
+
+				for (int iBucket = 0; iBucket < LOAD_TIME_BUCKET_NUM; ++iBucket)
+					fprintf(fp, " %6u", c_rkStat.aadwLoadTimeHistogram[iStage][iBucket]);
+
+				fprintf(fp, "\n");
+			}
+		}
+
 		fclose(fp);
 	}
 }
@@ -491,6 +589,9 @@ void CResourceManager::Update()
 			if (pResource->canDestroy())
 			{
 				//Tracef("Resource Clear %s\n", pResource->GetFileName());
+				if (pResource->IsData())
+					++__GetStat(pResource).dwExpireCount;
+
 				pResource->Clear();
 			}
 
@@ -503,22 +604,139 @@ void CResourceManager::Update()
 			++itor;
 	}
 
+	if (m_uMemoryBudget && m_uMemorySize > m_uMemoryBudget && CurrentTime >= m_dwNextBudgetCheckTime)
+	{
+		__EvictOverBudget();
+		m_dwNextBudgetCheckTime = CurrentTime + c_Budget_Check_Time;
+	}
+
 	ProcessBackgroundLoading();
+	__ReloadChangedResources();
+}
+
+void CResourceManager::__EvictOverBudget()
+{
+	// the deadline is the release time plus c_Deleting_Wait_Time, so the earliest one was released first
+	std::vector<std::pair<DWORD, CResource *> > kVct_kCandidate;
+	kVct_kCandidate.reserve(m_ResourceDeletingMap.size());
+
+	for (TResourceDeletingMap::iterator i = m_ResourceDeletingMap.begin(); i != m_ResourceDeletingMap.end(); ++i)
+	{
+		if (i->first->canDestroy() && i->first->GetTotalMemorySize() > 0)
+			kVct_kCandidate.push_back(std::make_pair(i->second, i->first));
+	}
+
+	std::sort(kVct_kCandidate.begin(), kVct_kCandidate.end());
+
+	// go a bit below the budget, so it isn't exceeded again by the next load
+	size_t uTargetSize = m_uMemoryBudget - m_uMemoryBudget / 8;
+
+	for (size_t i = 0; i < kVct_kCandidate.size() && m_uMemorySize > uTargetSize; ++i)
+	{
+		CResource * pResource = kVct_kCandidate[i].second;
+
+		++__GetStat(pResource).dwEvictCount;
+		pResource->Clear();
+
+		m_ResourceDeletingMap.erase(pResource);
+	}
+
+	if (m_uMemorySize > m_uMemoryBudget)
+		Tracenf("CResourceManager: %u MB in use, budget %u MB, the rest is still referenced", (unsigned) (m_uMemorySize >> 20), (unsigned) (m_uMemoryBudget >> 20));
+}
+
+void CResourceManager::SetMemoryBudget(size_t uBytes)
+{
+	m_uMemoryBudget = uBytes;
+	m_dwNextBudgetCheckTime = 0;
+}
+
+void CResourceManager::OnResourceMemoryChanged(CResource * pResource, const size_t * c_auOldSize, const size_t * c_auNewSize)
+{
+	TResourceStat & rkStat = __GetStat(pResource);
+
+	for (int i = 0; i < CResource::MEMORY_TYPE_NUM; ++i)
+	{
+		rkStat.auMemorySize[i] += c_auNewSize[i] - c_auOldSize[i];
+		m_uMemorySize += c_auNewSize[i] - c_auOldSize[i];
+	}
+}
+
+void CResourceManager::AddLoadTime(CResource * pResource, int iStage, ULONGLONG ullMicroSecond)
+{
+	TResourceStat & rkStat = __GetStat(pResource);
+	rkStat.aullLoadTime[iStage] += ullMicroSecond;
+
+	int iBucket = 0;
+	for (ULONGLONG ullBound = c_Load_Time_Bucket_Base; ullMicroSecond >= ullBound && iBucket < LOAD_TIME_BUCKET_NUM - 1; ullBound *= 2)
+		++iBucket;
+
+	++rkStat.aadwLoadTimeHistogram[iStage][iBucket];
+}
+
+int CResourceManager::__GetStatIndex(const char * c_szFileName)
+{
+	const char * pcFileExt = strrchr(c_szFileName, '.');
+	std::string_view stExt = pcFileExt ? std::string_view(pcFileExt + 1) : std::string_view();
+
+	TResourceStatIndexMap::iterator f = m_StatIndexMap.find(stExt);
+	if (m_StatIndexMap.end() != f)
+		return f->second;
+
+	TResourceStat kStat;
+	memset(&kStat, 0, sizeof(kStat));
+	m_kVct_kStat.push_back(kStat);
+
+	int iStatIndex = int(m_kVct_kStat.size() - 1);
+	m_StatIndexMap.emplace(std::string(stExt), iStatIndex);
+	return iStatIndex;
+}
+
+CResourceManager::TResourceStat & CResourceManager::__GetStat(const char * c_szFileName)
+{
+	return m_kVct_kStat[__GetStatIndex(c_szFileName)];
+}
+
+CResourceManager::TResourceStat & CResourceManager::__GetStat(CResource * pResource)
+{
+	// resources made outside of GetResourcePointer look their extension up once
+	if (pResource->GetStatIndex() < 0)
+		pResource->SetStatIndex(__GetStatIndex(pResource->GetFileName()));
+
+	return m_kVct_kStat[pResource->GetStatIndex()];
+}
+
+void CResourceManager::__ReloadChangedResources()
+{
+	CPackManager::Instance().FetchChangedFiles(m_ChangedFiles);
+
+	for (const std::string & c_rstFileName : m_ChangedFiles)
+	{
+		CResource * pResource = FindResourcePointer(c_rstFileName.c_str());
+
+		// resources that aren't loaded pick the new file up on their next Load
+		if (!pResource || pResource->IsEmpty())
+			continue;
+
+		pResource->Reload();
+	}
 }
 
 void CResourceManager::ReserveDeletingResource(CResource * pResource)
 {
+	// released again after being picked up, the wait (and its place in the eviction order) starts over
 	DWORD dwCurrentTime = ELTimer_GetMSec();
-	m_ResourceDeletingMap.insert(TResourceDeletingMap::value_type(pResource, dwCurrentTime + c_Deleting_Wait_Time));
+	m_ResourceDeletingMap[pResource] = dwCurrentTime + c_Deleting_Wait_Time;
 }
 
 CResourceManager::CResourceManager()
 {
-	//ms_loadingThread.Create(0);
+	m_uMemorySize = 0;
+	m_uMemoryBudget = size_t(std::max(0, g_iResourceMemoryBudget)) * 1024 * 1024;
+	m_dwNextBudgetCheckTime = 0;
 }
 
 CResourceManager::~CResourceManager()
 {
 	Destroy();
-	//ms_loadingThread.Shutdown();
 }
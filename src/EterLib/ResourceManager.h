@@ -1,14 +1,47 @@
 #pragma once
 
 #include "Resource.h"
-#include "FileLoaderThread.h"
+#include "ResourceNameMap.h"
+#include "PackLib/PackManager.h"
 
 #include <set>
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 class CResourceManager : public CSingleton<CResourceManager>
 {
+	public:
+		// where the time turning a file into a resource goes
+		enum ELoadStage
+		{
+			LOAD_STAGE_MAIN,		// OnLoad on the main thread, every synchronous load and resources without a decode step
+			LOAD_STAGE_DECODE,		// OnDecode on a loader thread
+			LOAD_STAGE_FINALIZE,	// OnFinalize on the main thread after a decode
+			LOAD_STAGE_NUM
+		};
+
+		// bucket i counts the loads under 0.25ms * 2^i, the last one everything slower
+		enum
+		{
+			LOAD_TIME_BUCKET_NUM = 8,
+		};
+
+		// per file extension: lookups that found the resource loaded or not, and data dropped to free memory
+		typedef struct SResourceStat
+		{
+			DWORD		dwHitCount;
+			DWORD		dwMissCount;
+			DWORD		dwExpireCount;		// cleared after c_Deleting_Wait_Time without a reference
+			DWORD		dwEvictCount;		// cleared early because the memory budget was exceeded
+			size_t		auMemorySize[CResource::MEMORY_TYPE_NUM];
+			ULONGLONG	aullLoadTime[LOAD_STAGE_NUM];	// microseconds
+			DWORD		aadwLoadTimeHistogram[LOAD_STAGE_NUM][LOAD_TIME_BUCKET_NUM];
+		} TResourceStat;
+
+		typedef std::map<std::string, int, std::less<>>						TResourceStatIndexMap;	// extension to m_kVct_kStat index
+
 	public:
 		CResourceManager();
 		virtual ~CResourceManager();
@@ -21,13 +54,14 @@ class CResourceManager : public CSingleton<CResourceManager>
 		void		BeginThreadLoading();
 		void		EndThreadLoading();
 
-		CResource *	InsertResourcePointer(DWORD dwFileCRC, CResource* pResource);
-		CResource *	FindResourcePointer(DWORD dwFileCRC);
-		CResource *	GetResourcePointer(const char * c_szFileName);
+		CResource *	InsertResourcePointer(uint64_t ullFileHash, CResource* pResource);
+		CResource *	FindResourcePointer(const char * c_szFileName);
+		// bLooseFile only counts for a resource created by this call, see CResource::SetLooseFile
+		CResource *	GetResourcePointer(const char * c_szFileName, bool bLooseFile = false);
 		CResource *	GetTypeResourcePointer(const char * c_szFileName, int iType=-1);
 
 		// 추가
-		bool		isResourcePointerData(DWORD dwFileCRC);
+		bool		isResourcePointerData(const char * c_szFileName);
 
 		void		RegisterResourceNewFunctionPointer(const char* c_szFileExt, CResource* (*pResNewFunc)(const char* c_szFileName));
 		void		RegisterResourceNewFunctionByTypePointer(int iType, CResource* (*pNewFunc) (const char* c_szFileName));
@@ -38,23 +72,41 @@ class CResourceManager : public CSingleton<CResourceManager>
 		void		Update();
 		void		ReserveDeletingResource(CResource * pResource);
 
+		// Unreferenced resources are normally kept for c_Deleting_Wait_Time. While the loaded resources
+		// take more than the budget, the least recently released ones are cleared right away. 0 disables it.
+		void		SetMemoryBudget(size_t uBytes);
+		size_t		GetMemoryBudget() const		{ return m_uMemoryBudget;	}
+		size_t		GetMemorySize() const		{ return m_uMemorySize;		}
+
+		void		OnResourceMemoryChanged(CResource * pResource, const size_t * c_auOldSize, const size_t * c_auNewSize);
+		void		AddLoadTime(CResource * pResource, int iStage, ULONGLONG ullMicroSecond);
+
 	public:
 		void		ProcessBackgroundLoading();
 		void		PushBackgroundLoadingSet(std::set<std::string> & LoadingSet);
+		void		CancelBackgroundLoading();	// drops requests that are no longer needed (e.g. after a warp)
 
 	protected:
 		void		__DestroyDeletingResourceMap();
 		void		__DestroyResourceMap();
 		void		__DestroyCacheMap();
 
-		DWORD		__GetFileCRC(const char * c_szFileName, const char ** c_pszLowerFile = NULL);
+		const char *	__GetNormalizedFileName(const char * c_szFileName, bool bNormalized);
+		CResource *	__FindResourcePointer(uint64_t ullFileHash, const char * c_szFileName);
+		void		__OnBackgroundLoaded(uint64_t ullFileHash, const std::string & c_rstFileName, bool bSuccess, TPackFile & rFile, CResource::CDecodedData * pData, ULONGLONG ullDecodeTime);
+		void		__ReloadChangedResources();
+		void		__EvictOverBudget();
+		int			__GetStatIndex(const char * c_szFileName);
+		TResourceStat & __GetStat(const char * c_szFileName);
+		TResourceStat & __GetStat(CResource * pResource);
 	
 	protected:
-		typedef std::map<DWORD,	CResource *>									TResourcePointerMap;
+		typedef CResourceNameMap<CResource *>									TResourcePointerMap;
 		typedef std::map<std::string, CResource* (*)(const char*)>				TResourceNewFunctionPointerMap;
 		typedef std::map<int, CResource* (*)(const char*)>						TResourceNewFunctionByTypePointerMap;
 		typedef std::map<CResource *, DWORD>									TResourceDeletingMap;
-		typedef std::map<DWORD, std::string>									TResourceRequestMap;
+		typedef CResourceNameMap<std::string>									TResourceRequestMap;
+		typedef CResourceNameMap<TPackRequestID>								TResourceWaitingMap;
 		typedef std::map<long, CResource*>										TResourceRefDecreaseWaitingMap;
 
 	protected:
@@ -64,10 +116,15 @@ class CResourceManager : public CSingleton<CResourceManager>
 		TResourceNewFunctionByTypePointerMap	m_pResNewFuncByTypeMap;
 		TResourceDeletingMap					m_ResourceDeletingMap;
 		TResourceRequestMap						m_RequestMap;	// 쓰레드로 로딩 요청한 리스트
-		TResourceRequestMap						m_WaitingMap;
+		TResourceWaitingMap						m_WaitingMap;	// requests in flight on CPackManager's async loader
 		TResourceRefDecreaseWaitingMap			m_pResRefDecreaseWaitingMap;
+		std::vector<std::string>				m_ChangedFiles;	// overlay files edited while running, reused every frame
 
-		static CFileLoaderThread				ms_loadingThread;
+		TResourceStatIndexMap					m_StatIndexMap;
+		std::vector<TResourceStat>				m_kVct_kStat;	// by CResource::GetStatIndex
+		size_t									m_uMemorySize;
+		size_t									m_uMemoryBudget;
+		DWORD									m_dwNextBudgetCheckTime;
 };
 
-extern int g_iLoadingDelayTime;
\ No newline at end of file
+extern int g_iResourceMemoryBudget;	// MB, read from the config
\ No newline at end of file
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "EterBase/Stl.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <string_view>
+
+// Open addressing hash table (linear probing) keyed by a resource file name in its normalized form,
+// lower case with backslashes. The 64 bit hash picks the slot and the stored name rules out collisions.
+// Lookups accept any spelling of a name and normalize it while hashing and comparing, so looking up
+// a name never copies it.
+template<typename T>
+class CResourceNameMap
+{
+	public:
+		static char NormalizeChar(char c)
+		{
+			return '/' == c ? '\\' : korean_tolower(c);
+		}
+
+		// FNV-1a over the normalized name, *pbNormalized tells whether c_szName was in that form already
+		static uint64_t Hash(const char * c_szName, bool * pbNormalized = NULL)
+		{
+			uint64_t ullHash = 0xcbf29ce484222325ull;
+			bool bNormalized = true;
+
+			for (const char * pc = c_szName; *pc; ++pc)
+			{
+				char c = NormalizeChar(*pc);
+				bNormalized &= (c == *pc);
+
+				ullHash ^= (unsigned char) c;
+				ullHash *= 0x100000001b3ull;
+			}
+
+			if (pbNormalized)
+				*pbNormalized = bNormalized;
+
+			return ullHash;
+		}
+
+	public:
+		CResourceNameMap() : m_uCount(0)
+		{
+		}
+
+		size_t Size() const
+		{
+			return m_uCount;
+		}
+
+		T * Find(uint64_t ullHash, const char * c_szName)
+		{
+			if (!m_uCount)
+				return NULL;
+
+			for (size_t i = ullHash & __GetMask(); m_kVct_kSlot[i].bUsed; i = (i + 1) & __GetMask())
+			{
+				if (m_kVct_kSlot[i].ullHash == ullHash && __IsSameName(m_kVct_kSlot[i].stName, c_szName))
+					return &m_kVct_kSlot[i].value;
+			}
+
+			return NULL;
+		}
+
+		// c_stName has to be normalized already, an existing entry of that name is kept and returned
+		T & Insert(uint64_t ullHash, std::string_view c_stName, const T & c_rValue)
+		{
+			if ((m_uCount + 1) * 4 > m_kVct_kSlot.size() * 3)
+				__Grow();
+
+			size_t i = ullHash & __GetMask();
+			for (; m_kVct_kSlot[i].bUsed; i = (i + 1) & __GetMask())
+			{
+				if (m_kVct_kSlot[i].ullHash == ullHash && m_kVct_kSlot[i].stName == c_stName)
+					return m_kVct_kSlot[i].value;
+			}
+
+			SSlot & rkSlot = m_kVct_kSlot[i];
+			rkSlot.ullHash = ullHash;
+			rkSlot.stName.assign(c_stName);
+			rkSlot.value = c_rValue;
+			rkSlot.bUsed = true;
+
+			++m_uCount;
+			return rkSlot.value;
+		}
+
+		bool Erase(uint64_t ullHash, const char * c_szName)
+		{
+			if (!m_uCount)
+				return false;
+
+			size_t i = ullHash & __GetMask();
+			for (; m_kVct_kSlot[i].bUsed; i = (i + 1) & __GetMask())
+			{
+				if (m_kVct_kSlot[i].ullHash == ullHash && __IsSameName(m_kVct_kSlot[i].stName, c_szName))
+					break;
+			}
+
+			if (!m_kVct_kSlot[i].bUsed)
+				return false;
+
+			// shift the following entries of the run back, so no lookup stops early at the hole
+			for (size_t j = (i + 1) & __GetMask(); m_kVct_kSlot[j].bUsed; j = (j + 1) & __GetMask())
+			{
+				size_t uHome = m_kVct_kSlot[j].ullHash & __GetMask();
+
+				bool bStays = (i <= j) ? (i < uHome && uHome <= j) : (i < uHome || uHome <= j);
+				if (bStays)
+					continue;
+
+				m_kVct_kSlot[i] = std::move(m_kVct_kSlot[j]);
+				i = j;
+			}
+
+			m_kVct_kSlot[i].bUsed = false;
+			m_kVct_kSlot[i].stName.clear();
+			m_kVct_kSlot[i].value = T();
+
+			--m_uCount;
+			return true;
+		}
+
+		// keeps the slots, tables that are filled and drained every frame don't reallocate
+		void Clear()
+		{
+			if (!m_uCount)
+				return;
+
+			for (SSlot & rkSlot : m_kVct_kSlot)
+			{
+				if (!rkSlot.bUsed)
+					continue;
+
+				rkSlot.bUsed = false;
+				rkSlot.stName.clear();
+				rkSlot.value = T();
+			}
+
+			m_uCount = 0;
+		}
+
+		// fn(uint64_t ullHash, const std::string & c_rstName, T & rValue), the map must not change meanwhile
+		template<typename F>
+		void ForEach(F fn)
+		{
+			if (!m_uCount)
+				return;
+
+			for (SSlot & rkSlot : m_kVct_kSlot)
+			{
+				if (rkSlot.bUsed)
+					fn(rkSlot.ullHash, rkSlot.stName, rkSlot.value);
+			}
+		}
+
+	protected:
+		struct SSlot
+		{
+			uint64_t		ullHash = 0;
+			std::string		stName;
+			T				value = T();
+			bool			bUsed = false;
+		};
+
+		size_t __GetMask() const
+		{
+			return m_kVct_kSlot.size() - 1;
+		}
+
+		static bool __IsSameName(const std::string & c_rstName, const char * c_szName)
+		{
+			size_t i = 0;
+			for (; i < c_rstName.length(); ++i)
+			{
+				// names usually come in normalized already, only differing characters need the conversion
+				if (c_rstName[i] != c_szName[i] && c_rstName[i] != NormalizeChar(c_szName[i]))
+					return false;
+			}
+
+			return '\0' == c_szName[i];
+		}
+
+		void __Grow()
+		{
+			std::vector<SSlot> kVct_kOld;
+			kVct_kOld.swap(m_kVct_kSlot);
+			m_kVct_kSlot.resize(kVct_kOld.empty() ? 64 : kVct_kOld.size() * 2);
+
+			for (SSlot & rkOld : kVct_kOld)
+			{
+				if (!rkOld.bUsed)
+					continue;
+
+				size_t i = rkOld.ullHash & __GetMask();
+				while (m_kVct_kSlot[i].bUsed)
+					i = (i + 1) & __GetMask();
+
+				m_kVct_kSlot[i] = std::move(rkOld);
+			}
+		}
+
+	protected:
+		std::vector<SSlot>	m_kVct_kSlot;	// power of two size, at most 3/4 used
+		size_t				m_uCount;
+};
@@ -37,5 +37,5 @@
 #include "EterLocale/CodePageId.h"
 
 #ifndef VC_EXTRALEAN
-#include <winsock.h>
+#include <winsock2.h>
 #endif
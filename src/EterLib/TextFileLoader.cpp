@@ -1,7 +1,10 @@
 #include "StdAfx.h"
 #include "EterBase/CRC32.h"
 #include <string>
+#include <charconv>
 #include "PackLib/PackManager.h"
+#include "PackLib/GroupFile.h"
+#include "PackLib/GroupParser.h"
 
 #include "Pool.h"
 #include "TextFileLoader.h"
@@ -11,32 +14,55 @@ bool CTextFileLoader::ms_isCacheMode=false;
 
 CDynamicPool<CTextFileLoader::SGroupNode>	CTextFileLoader::SGroupNode::ms_kPool;
 
-CTokenVector* CTextFileLoader::SGroupNode::GetTokenVector(const std::string& c_rstGroupName)
+bool CTextFileLoader::SGroupNode::GetTokenViews(std::string_view c_stGroupName, std::span<const std::string_view> * pTokens)
 {
-	DWORD dwGroupNameKey=GenNameKey(c_rstGroupName.c_str(), c_rstGroupName.length());
+	DWORD dwGroupNameKey=GenNameKey(c_stGroupName.data(), c_stGroupName.length());
 
-	std::map<DWORD, CTokenVector>::iterator f=m_kMap_dwKey_kVct_stToken.find(dwGroupNameKey);
-	if (m_kMap_dwKey_kVct_stToken.end()==f)
-		return NULL;
+	std::vector<STokenRange>::iterator f=std::lower_bound(m_kVct_kTokenRange.begin(), m_kVct_kTokenRange.end(), dwGroupNameKey,
+		[](const STokenRange& c_rkRange, DWORD dwKey) { return c_rkRange.dwKey < dwKey; });
 
-	return &f->second;
+	if (m_kVct_kTokenRange.end()==f || f->dwKey!=dwGroupNameKey)
+		return false;
+
+	*pTokens=std::span<const std::string_view>(m_pkVct_stToken->data() + f->dwFirst, f->dwCount);
+	return true;
 }
 
-bool CTextFileLoader::SGroupNode::IsExistTokenVector(const std::string& c_rstGroupName)
+CTokenVector* CTextFileLoader::SGroupNode::GetTokenVector(std::string_view c_stGroupName)
 {
-	DWORD dwGroupNameKey=GenNameKey(c_rstGroupName.c_str(), c_rstGroupName.length());
+	DWORD dwGroupNameKey=GenNameKey(c_stGroupName.data(), c_stGroupName.length());
 
-	if (m_kMap_dwKey_kVct_stToken.end()==m_kMap_dwKey_kVct_stToken.find(dwGroupNameKey))
-		return false;
+	std::map<DWORD, CTokenVector>::iterator f=m_kMap_dwKey_kVct_stToken.find(dwGroupNameKey);
+	if (m_kMap_dwKey_kVct_stToken.end()!=f)
+		return &f->second;
 
-	return true;
+	std::span<const std::string_view> kTokens;
+	if (!GetTokenViews(c_stGroupName, &kTokens))
+		return NULL;
+
+	CTokenVector& rkVct_stToken=m_kMap_dwKey_kVct_stToken[dwGroupNameKey];
+	rkVct_stToken.reserve(kTokens.size());
+	for (std::string_view stToken : kTokens)
+		rkVct_stToken.emplace_back(stToken);
+
+	return &rkVct_stToken;
 }
 
-void CTextFileLoader::SGroupNode::InsertTokenVector(const std::string& c_rstGroupName, const CTokenVector& c_rkVct_stToken)
+bool CTextFileLoader::SGroupNode::IsExistTokenVector(std::string_view c_stGroupName)
 {
-	DWORD dwGroupNameKey=GenNameKey(c_rstGroupName.c_str(), c_rstGroupName.length());
+	std::span<const std::string_view> kTokens;
+	return GetTokenViews(c_stGroupName, &kTokens);
+}
 
-	m_kMap_dwKey_kVct_stToken.insert(std::map<DWORD, CTokenVector>::value_type(dwGroupNameKey, c_rkVct_stToken));
+void CTextFileLoader::SGroupNode::InsertTokenRange(DWORD dwKey, DWORD dwFirst, DWORD dwCount)
+{
+	m_kVct_kTokenRange.push_back({ dwKey, dwFirst, dwCount });
+}
+
+void CTextFileLoader::SGroupNode::SortTokenRanges()
+{
+	std::stable_sort(m_kVct_kTokenRange.begin(), m_kVct_kTokenRange.end(),
+		[](const STokenRange& a, const STokenRange& b) { return a.dwKey < b.dwKey; });
 }
 
 DWORD CTextFileLoader::SGroupNode::GenNameKey(const char* c_szGroupName, UINT uGroupNameLen)
@@ -73,6 +99,7 @@ CTextFileLoader::SGroupNode* CTextFileLoader::SGroupNode::New()
 
 void CTextFileLoader::SGroupNode::Delete(SGroupNode* pkNode)
 {
+	pkNode->m_kVct_kTokenRange.clear();
 	pkNode->m_kMap_dwKey_kVct_stToken.clear();
 	pkNode->ChildNodeVector.clear();
 	pkNode->m_strGroupName="";
@@ -139,22 +166,19 @@ CTextFileLoader::CTextFileLoader()
 {
 	SetTop();
 
-	m_acBufData=NULL;
-	m_dwBufSize=0;
-	m_dwBufCapacity=0;
-
 	m_GlobalNode.m_strGroupName = "global";
+	m_GlobalNode.m_dwGroupNameKey = 0;
+	m_GlobalNode.m_pkVct_stToken = &m_kVct_stToken;
 	m_GlobalNode.pParentNode = NULL;
 
+	m_pkCompiledToken = NULL;
+
 	m_kVct_pkNode.reserve(128);	
 }
 
 CTextFileLoader::~CTextFileLoader()
 {
 	Destroy();
-
-	if (m_acBufData)
-		delete [] m_acBufData;
 }
 
 void CTextFileLoader::__DestroyGroupNodeVector()
@@ -179,137 +203,173 @@ bool CTextFileLoader::Load(const char * c_szFileName)
 {
 	m_strFileName = "";
 
+	// both forms are read in place from the pack mapping when possible, the nodes and tokens point into it
 	TPackFile kFile;
-	if (!CPackManager::Instance().GetFile( c_szFileName, kFile))
+	TPackFileView kView;
+	if (!CPackManager::Instance().GetFileView(c_szFileName, kView, kFile))
 		return false;
 
-	if (m_dwBufCapacity<kFile.size())
-	{
-		m_dwBufCapacity=kFile.size();
+	m_strFileName = c_szFileName;
+	SetTop();
 
-		if (m_acBufData)
-			delete [] m_acBufData;
+	// the nodes of an earlier load point into the text that is about to be replaced
+	__DestroyGroupNodeVector();
+	m_GlobalNode.ChildNodeVector.clear();
+	m_GlobalNode.m_kVct_kTokenRange.clear();
+	m_GlobalNode.m_kMap_dwKey_kVct_stToken.clear();
+	m_kVct_stToken.clear();
+	m_pkCompiledToken = NULL;
 
-		m_acBufData=new char[m_dwBufCapacity];
-	}
+	// swapping keeps the buffer kView may point into
+	m_kFile.swap(kFile);
 
-	m_dwBufSize=kFile.size();
-	memcpy(m_acBufData, kFile.data(), m_dwBufSize);
+	bool bResult;
+	if (IsGroupFile(kView))
+		bResult = __LoadCompiled(kView);
+	else
+		bResult = __LoadText(std::string_view((const char *) kView.data(), kView.size()));
 
-	m_strFileName = c_szFileName;
-	m_dwcurLineIndex = 0;
+	m_GlobalNode.SortTokenRanges();
+	for (TGroupNode * pNode : m_kVct_pkNode)
+		pNode->SortTokenRanges();
 
-	m_textFileLoader.Bind(m_dwBufSize, m_acBufData);
-	return LoadGroup(&m_GlobalNode);
+	return bResult;
 }
 
-bool CTextFileLoader::LoadGroup(TGroupNode * pGroupNode)
+bool CTextFileLoader::__LoadCompiled(std::span<const uint8_t> kData)
 {
-	CTokenVector stTokenVector;
-	int nLocalGroupDepth = 0;
-	
-	for (; m_dwcurLineIndex < m_textFileLoader.GetLineCount(); ++m_dwcurLineIndex)
+	const TGroupFileHeader * c_pkHeader = (const TGroupFileHeader *) kData.data();
+
+	uint64_t ullRangeOffset = sizeof(TGroupFileHeader) + uint64_t(c_pkHeader->node_count) * sizeof(TGroupFileNode);
+	uint64_t ullTokenOffset = ullRangeOffset + uint64_t(c_pkHeader->range_count) * sizeof(TGroupFileRange);
+	uint64_t ullStringOffset = ullTokenOffset + uint64_t(c_pkHeader->token_count) * sizeof(TGroupFileToken);
+
+	if (GROUP_FILE_VERSION != c_pkHeader->version || 0 == c_pkHeader->node_count || ullStringOffset + c_pkHeader->strings_size != kData.size())
 	{
-		int iRet;
+		TraceError("CTextFileLoader::__LoadCompiled : unsupported compiled file %s", m_strFileName.c_str());
+		return false;
+	}
+
+	const TGroupFileNode * c_pkNode = (const TGroupFileNode *) (kData.data() + sizeof(TGroupFileHeader));
+	const TGroupFileRange * c_pkRange = (const TGroupFileRange *) (kData.data() + ullRangeOffset);
+	const TGroupFileToken * c_pkToken = (const TGroupFileToken *) (kData.data() + ullTokenOffset);
+	const char * c_pcString = (const char *) kData.data() + ullStringOffset;
+
+	// every string is followed by its null byte
+	auto GetString = [&](const TGroupFileString & c_rkString, std::string_view * pstString)
+	{
+		if (uint64_t(c_rkString.offset) + c_rkString.size >= c_pkHeader->strings_size)
+			return false;
 
-		if ((iRet = m_textFileLoader.SplitLine2(m_dwcurLineIndex, &stTokenVector)) != 0)
+		*pstString = std::string_view(c_pcString + c_rkString.offset, c_rkString.size);
+		return true;
+	};
+
+	m_kVct_stToken.resize(c_pkHeader->token_count);
+	for (DWORD i = 0; i < c_pkHeader->token_count; ++i)
+	{
+		if (!GetString(c_pkToken[i].text, &m_kVct_stToken[i]))
 		{
-			if (iRet == -2)
-				TraceError("cannot find \" in %s:%lu", m_strFileName.c_str(), m_dwcurLineIndex);
-			continue;
+			TraceError("CTextFileLoader::__LoadCompiled : damaged compiled file %s", m_strFileName.c_str());
+			return false;
 		}
+	}
 
-		stl_lowers(stTokenVector[0]);
+	// node 0 is the global scope, node i > 0 becomes m_kVct_pkNode[i - 1]
+	for (DWORD i = 0; i < c_pkHeader->node_count; ++i)
+	{
+		const TGroupFileNode & c_rkNode = c_pkNode[i];
 
-		if ('{' == stTokenVector[0][0])
+		std::string_view stName;
+		if ((i > 0 && (c_rkNode.parent >= i || !GetString(c_rkNode.name, &stName))) ||
+			uint64_t(c_rkNode.first_range) + c_rkNode.range_count > c_pkHeader->range_count)
 		{
-			nLocalGroupDepth++;
-			continue;
+			TraceError("CTextFileLoader::__LoadCompiled : damaged compiled file %s", m_strFileName.c_str());
+			return false;
 		}
 
-		if ('}' == stTokenVector[0][0]) {
-			nLocalGroupDepth--;
-			break;
+		TGroupNode * pNode = &m_GlobalNode;
+		if (i > 0)
+		{
+			pNode = TGroupNode::New();
+			m_kVct_pkNode.push_back(pNode);
+
+			pNode->pParentNode = 0 == c_rkNode.parent ? &m_GlobalNode : m_kVct_pkNode[c_rkNode.parent - 1];
+			pNode->m_pkVct_stToken = &m_kVct_stToken;
+			pNode->SetGroupName(std::string(stName));
+			pNode->pParentNode->ChildNodeVector.push_back(pNode);
 		}
 
-		// Group
-		if (0 == stTokenVector[0].compare("group"))
+		pNode->m_kVct_kTokenRange.reserve(c_rkNode.range_count);
+		for (DWORD j = c_rkNode.first_range; j < c_rkNode.first_range + c_rkNode.range_count; ++j)
 		{
-			if (2 != stTokenVector.size())
+			const TGroupFileRange & c_rkRange = c_pkRange[j];
+
+			std::string_view stKey;
+			if (!GetString(c_rkRange.key, &stKey) || uint64_t(c_rkRange.first_token) + c_rkRange.token_count > c_pkHeader->token_count)
 			{
-				assert(!"There is no group name!");
-				continue;
+				TraceError("CTextFileLoader::__LoadCompiled : damaged compiled file %s", m_strFileName.c_str());
+				return false;
 			}
 
-			TGroupNode * pNewNode = TGroupNode::New();
-			m_kVct_pkNode.push_back(pNewNode);
+			pNode->InsertTokenRange(__GenLowerNameKey(stKey), c_rkRange.first_token, c_rkRange.token_count);
+		}
+	}
 
-			pNewNode->pParentNode = pGroupNode;
-			pNewNode->SetGroupName(stTokenVector[1]);			
-			pGroupNode->ChildNodeVector.push_back(pNewNode);
+	m_pkCompiledToken = c_pkToken;
+	return 0 != (c_pkHeader->flags & GROUP_FILE_FLAG_COMPLETE);
+}
 
-			++m_dwcurLineIndex;
+DWORD CTextFileLoader::__GenLowerNameKey(std::string_view stName)
+{
+	char szLowerName[256];
+	size_t uLen = std::min(stName.length(), sizeof(szLowerName));
 
-			if( false == LoadGroup(pNewNode) )
-				return false;
-		}
-		// List
-		else if (0 == stTokenVector[0].compare("list"))
-		{
-			if (2 != stTokenVector.size())
-			{
-				assert(!"There is no list name!");
-				continue;
-			}
+	for (size_t i = 0; i < uLen; ++i)
+		szLowerName[i] = korean_tolower(stName[i]);
 
-			CTokenVector stSubTokenVector;
+	if (uLen == stName.length())
+		return SGroupNode::GenNameKey(szLowerName, uLen);
 
-			stl_lowers(stTokenVector[1]);
-			std::string key = stTokenVector[1];
+	// too long for the stack buffer, doesn't happen with real data
+	std::string strLowerName(stName);
+	stl_lowers(strLowerName);
+	return SGroupNode::GenNameKey(strLowerName.c_str(), strLowerName.length());
+}
 
-			stTokenVector.clear();
+bool CTextFileLoader::__LoadText(std::string_view stText)
+{
+	// keeps its buffers from one load to the next, only the tokens are copied out
+	static thread_local CGroupParser s_kParser;
 
-			++m_dwcurLineIndex;
-			for (; m_dwcurLineIndex < m_textFileLoader.GetLineCount(); ++m_dwcurLineIndex)
-			{
-				if (!m_textFileLoader.SplitLine(m_dwcurLineIndex, &stSubTokenVector))
-					continue;
-
-				if ('{' == stSubTokenVector[0][0])
-					continue;
-				
-				if ('}' == stSubTokenVector[0][0])
-					break;
-
-				for (DWORD j = 0; j < stSubTokenVector.size(); ++j)
-				{
-					stTokenVector.push_back(stSubTokenVector[j]);
-				}
-			}
+	CGroupParser & kParser = s_kParser;
+	bool bResult = kParser.Parse(stText);
 
-			pGroupNode->InsertTokenVector(key, stTokenVector);
-			//pGroupNode->LocalTokenVectorMap.insert(std::make_pair(key, stTokenVector));
-		}
-		else
-		{
-			std::string key = stTokenVector[0];
+	for (const std::string & c_rstError : kParser.errors)
+		TraceError("CTextFileLoader::Load : %s (filename: %s)", c_rstError.c_str(), m_strFileName.c_str());
 
-			if (1 == stTokenVector.size())
-			{
-				TraceError("CTextFileLoader::LoadGroup : must have a value (filename: %s line: %d key: %s)",
-							m_strFileName.c_str(),
-							m_dwcurLineIndex,
-							key.c_str());
-				break;
-			}
+	// node 0 is the global scope, node i > 0 becomes m_kVct_pkNode[i - 1]
+	for (size_t i = 1; i < kParser.nodes.size(); ++i)
+	{
+		const TGroupParseNode & c_rkNode = kParser.nodes[i];
 
-			stTokenVector.erase(stTokenVector.begin());
-			pGroupNode->InsertTokenVector(key, stTokenVector);
-			//pGroupNode->LocalTokenVectorMap.insert(std::make_pair(key, stTokenVector));
-		}
+		TGroupNode * pNode = TGroupNode::New();
+		m_kVct_pkNode.push_back(pNode);
+
+		pNode->pParentNode = 0 == c_rkNode.parent ? &m_GlobalNode : m_kVct_pkNode[c_rkNode.parent - 1];
+		pNode->m_pkVct_stToken = &m_kVct_stToken;
+		pNode->SetGroupName(std::string(c_rkNode.name));
+		pNode->pParentNode->ChildNodeVector.push_back(pNode);
+	}
+
+	for (const TGroupParseRange & c_rkRange : kParser.ranges)
+	{
+		TGroupNode * pNode = 0 == c_rkRange.node ? &m_GlobalNode : m_kVct_pkNode[c_rkRange.node - 1];
+		pNode->InsertTokenRange(__GenLowerNameKey(c_rkRange.key), c_rkRange.first_token, c_rkRange.token_count);
 	}
 
-	return (nLocalGroupDepth == 0);
+	m_kVct_stToken.assign(kParser.tokens.begin(), kParser.tokens.end());
+	return bResult;
 }
 
 void CTextFileLoader::SetTop()
@@ -407,7 +467,18 @@ BOOL CTextFileLoader::GetCurrentNodeName(std::string * pstrName)
 	return TRUE;
 }
 
-BOOL CTextFileLoader::IsToken(const std::string & c_rstrKey)
+BOOL CTextFileLoader::IsToken(std::string_view stKey)
+{
+	if (!m_pcurNode)
+	{
+		assert(!"Node to access has not set!");
+		return FALSE;
+	}
+
+	return m_pcurNode->IsExistTokenVector(stKey);
+}
+
+BOOL CTextFileLoader::GetTokenViews(std::string_view stKey, std::span<const std::string_view> * pTokens)
 {
 	if (!m_pcurNode)
 	{
@@ -415,11 +486,10 @@ BOOL CTextFileLoader::IsToken(const std::string & c_rstrKey)
 		return FALSE;
 	}
 
-	return m_pcurNode->IsExistTokenVector(c_rstrKey);
-	//return m_pcurNode->LocalTokenVectorMap.end() != m_pcurNode->LocalTokenVectorMap.find(c_rstrKey);
+	return m_pcurNode->GetTokenViews(stKey, pTokens);
 }
 
-BOOL CTextFileLoader::GetTokenVector(const std::string & c_rstrKey, CTokenVector ** ppTokenVector)
+BOOL CTextFileLoader::GetTokenVector(std::string_view stKey, CTokenVector ** ppTokenVector)
 {
 	if (!m_pcurNode)
 	{
@@ -427,269 +497,248 @@ BOOL CTextFileLoader::GetTokenVector(const std::string & c_rstrKey, CTokenVector
 		return FALSE;
 	}
 
-	CTokenVector* pkRetTokenVector=m_pcurNode->GetTokenVector(c_rstrKey);
+	CTokenVector* pkRetTokenVector=m_pcurNode->GetTokenVector(stKey);
 	if (!pkRetTokenVector)
 		return FALSE;
 
 	*ppTokenVector = pkRetTokenVector;
+	return TRUE;
+}
 
-	//CTokenVectorMap::iterator itor = m_pcurNode->LocalTokenVectorMap.find(c_rstrKey);
-	//if (m_pcurNode->LocalTokenVectorMap.end() == itor)
-	//{
-		//Tracef(" CTextFileLoader::GetTokenVector - Failed to find the key %s [%s :: %s]\n", m_File.GetFileName(), m_pcurNode->strGroupName.c_str(), c_rstrKey.c_str());
-	//	return FALSE;
-	//}
+// atoi/atof on a token that isn't null terminated; from_chars handles the usual numbers,
+// anything it rejects goes through a terminated copy so the results stay those of atoi/atof
+static int TokenToInteger(std::string_view stToken)
+{
+	const char * c_pcBegin = stToken.data();
+	const char * c_pcEnd = c_pcBegin + stToken.length();
+	if (c_pcBegin != c_pcEnd && '+' == *c_pcBegin)
+		++c_pcBegin;
 
-	//*ppTokenVector = &itor->second;
+	int iValue;
+	if (std::from_chars(c_pcBegin, c_pcEnd, iValue).ec == std::errc())
+		return iValue;
 
-	return TRUE;
+	char szToken[64];
+	size_t uLen = std::min(stToken.length(), sizeof(szToken) - 1);
+	memcpy(szToken, stToken.data(), uLen);
+	szToken[uLen] = '\0';
+	return atoi(szToken);
 }
 
-BOOL CTextFileLoader::GetTokenBoolean(const std::string & c_rstrKey, BOOL * pData)
+static float TokenToFloat(std::string_view stToken)
 {
-	CTokenVector * pTokenVector;
-	if (!GetTokenVector(c_rstrKey, &pTokenVector))
-		return FALSE;
+	const char * c_pcBegin = stToken.data();
+	const char * c_pcEnd = c_pcBegin + stToken.length();
+	if (c_pcBegin != c_pcEnd && '+' == *c_pcBegin)
+		++c_pcBegin;
 
-	if (pTokenVector->empty())
-	{
-		//Tracef(" CTextFileLoader::GetTokenBoolean - Failed to find the value %s [%s : %s]\n", m_File.GetFileName(), m_pcurNode->strGroupName.c_str(), c_rstrKey.c_str());
-		return FALSE;
-	}
+	double dValue;
+	if (std::from_chars(c_pcBegin, c_pcEnd, dValue).ec == std::errc())
+		return (float) dValue;
 
-	*pData = BOOL(atoi(pTokenVector->at(0).c_str()));
+	char szToken[64];
+	size_t uLen = std::min(stToken.length(), sizeof(szToken) - 1);
+	memcpy(szToken, stToken.data(), uLen);
+	szToken[uLen] = '\0';
+	return atof(szToken);
+}
 
-	return TRUE;
+// the tokens handed out by GetTokenViews are elements of m_kVct_stToken, their index finds the compiled value
+int CTextFileLoader::__GetTokenInteger(const std::string_view & c_rstToken)
+{
+	if (m_pkCompiledToken)
+		return m_pkCompiledToken[&c_rstToken - m_kVct_stToken.data()].integer;
+
+	return TokenToInteger(c_rstToken);
 }
 
-BOOL CTextFileLoader::GetTokenByte(const std::string & c_rstrKey, BYTE * pData)
+float CTextFileLoader::__GetTokenFloat(const std::string_view & c_rstToken)
 {
-	CTokenVector * pTokenVector;
-	if (!GetTokenVector(c_rstrKey, &pTokenVector))
-		return FALSE;
+	if (m_pkCompiledToken)
+		return m_pkCompiledToken[&c_rstToken - m_kVct_stToken.data()].value;
 
-	if (pTokenVector->empty())
-	{
-		//Tracef(" CTextFileLoader::GetTokenByte - Failed to find the value %s [%s : %s]\n", m_File.GetFileName(), m_pcurNode->strGroupName.c_str(), c_rstrKey.c_str());
+	return TokenToFloat(c_rstToken);
+}
+
+BOOL CTextFileLoader::GetTokenBoolean(std::string_view stKey, BOOL * pData)
+{
+	std::span<const std::string_view> kTokens;
+	if (!GetTokenViews(stKey, &kTokens) || kTokens.empty())
 		return FALSE;
-	}
 
-	*pData = BYTE(atoi(pTokenVector->at(0).c_str()));
+	*pData = BOOL(__GetTokenInteger(kTokens[0]));
 
 	return TRUE;
 }
 
-BOOL CTextFileLoader::GetTokenWord(const std::string & c_rstrKey, WORD * pData)
+BOOL CTextFileLoader::GetTokenByte(std::string_view stKey, BYTE * pData)
 {
-	CTokenVector * pTokenVector;
-	if (!GetTokenVector(c_rstrKey, &pTokenVector))
+	std::span<const std::string_view> kTokens;
+	if (!GetTokenViews(stKey, &kTokens) || kTokens.empty())
 		return FALSE;
 
-	if (pTokenVector->empty())
-	{
-		//Tracef(" CTextFileLoader::GetTokenWord - Failed to find the value %s [%s : %s]\n", m_File.GetFileName(), m_pcurNode->strGroupName.c_str(), c_rstrKey.c_str());
-		return FALSE;
-	}
-
-	*pData = WORD(atoi(pTokenVector->at(0).c_str()));
+	*pData = BYTE(__GetTokenInteger(kTokens[0]));
 
 	return TRUE;
 }
 
-BOOL CTextFileLoader::GetTokenInteger(const std::string & c_rstrKey, int * pData)
+BOOL CTextFileLoader::GetTokenWord(std::string_view stKey, WORD * pData)
 {
-	CTokenVector * pTokenVector;
-	if (!GetTokenVector(c_rstrKey, &pTokenVector))
+	std::span<const std::string_view> kTokens;
+	if (!GetTokenViews(stKey, &kTokens) || kTokens.empty())
 		return FALSE;
 
-	if (pTokenVector->empty())
-	{
-		//Tracef(" CTextFileLoader::GetTokenInteger - Failed to find the value %s [%s : %s]\n", m_File.GetFileName(), m_pcurNode->strGroupName.c_str(), c_rstrKey.c_str());
+	*pData = WORD(__GetTokenInteger(kTokens[0]));
+
+	return TRUE;
+}
+
+BOOL CTextFileLoader::GetTokenInteger(std::string_view stKey, int * pData)
+{
+	std::span<const std::string_view> kTokens;
+	if (!GetTokenViews(stKey, &kTokens) || kTokens.empty())
 		return FALSE;
-	}
 
-	*pData = atoi(pTokenVector->at(0).c_str());
+	*pData = __GetTokenInteger(kTokens[0]);
 
 	return TRUE;
 }
 
-BOOL CTextFileLoader::GetTokenDoubleWord(const std::string & c_rstrKey, DWORD * pData)
+BOOL CTextFileLoader::GetTokenDoubleWord(std::string_view stKey, DWORD * pData)
 {
-	return GetTokenInteger(c_rstrKey, *(int **)(&pData));
+	return GetTokenInteger(stKey, *(int **)(&pData));
 }
 
-BOOL CTextFileLoader::GetTokenFloat(const std::string & c_rstrKey, float * pData)
+BOOL CTextFileLoader::GetTokenFloat(std::string_view stKey, float * pData)
 {
-	CTokenVector * pTokenVector;
-	if (!GetTokenVector(c_rstrKey, &pTokenVector))
+	std::span<const std::string_view> kTokens;
+	if (!GetTokenViews(stKey, &kTokens) || kTokens.empty())
 		return FALSE;
 
-	if (pTokenVector->empty())
-	{
-		//Tracef(" CTextFileLoader::GetTokenFloat - Failed to find the value %s [%s : %s]\n", m_File.GetFileName(), m_pcurNode->strGroupName.c_str(), c_rstrKey.c_str());
-		return FALSE;
-	}
-
-	*pData = atof(pTokenVector->at(0).c_str());
+	*pData = __GetTokenFloat(kTokens[0]);
 
 	return TRUE;
 }
 
-BOOL CTextFileLoader::GetTokenVector2(const std::string & c_rstrKey, D3DXVECTOR2 * pVector2)
+// fills pValues with exactly uCount floats, fails if the key has a different number of values
+BOOL CTextFileLoader::__GetTokenFloats(std::string_view stKey, float * pValues, size_t uCount)
 {
-	CTokenVector * pTokenVector;
-	if (!GetTokenVector(c_rstrKey, &pTokenVector))
-		return FALSE;
-
-	if (pTokenVector->size() != 2)
-	{
-		//Tracef(" CTextFileLoader::GetTokenVector2 - This key should have 2 values %s [%s : %s]\n", m_File.GetFileName(), m_pcurNode->strGroupName.c_str(), c_rstrKey.c_str());
+	std::span<const std::string_view> kTokens;
+	if (!GetTokenViews(stKey, &kTokens) || kTokens.size() != uCount)
 		return FALSE;
-	}
 
-	pVector2->x = atof(pTokenVector->at(0).c_str());
-	pVector2->y = atof(pTokenVector->at(1).c_str());
+	for (size_t i = 0; i < uCount; ++i)
+		pValues[i] = __GetTokenFloat(kTokens[i]);
 
 	return TRUE;
 }
 
-BOOL CTextFileLoader::GetTokenVector3(const std::string & c_rstrKey, D3DXVECTOR3 * pVector3)
+BOOL CTextFileLoader::GetTokenVector2(std::string_view stKey, D3DXVECTOR2 * pVector2)
 {
-	CTokenVector * pTokenVector;
-	if (!GetTokenVector(c_rstrKey, &pTokenVector))
+	float afValue[2];
+	if (!__GetTokenFloats(stKey, afValue, 2))
 		return FALSE;
 
-	if (pTokenVector->size() != 3)
-	{
-		//Tracef(" CTextFileLoader::GetTokenVector3 - This key should have 3 values %s [%s : %s]\n", m_File.GetFileName(), m_pcurNode->strGroupName.c_str(), c_rstrKey.c_str());
+	pVector2->x = afValue[0];
+	pVector2->y = afValue[1];
+
+	return TRUE;
+}
+
+BOOL CTextFileLoader::GetTokenVector3(std::string_view stKey, D3DXVECTOR3 * pVector3)
+{
+	float afValue[3];
+	if (!__GetTokenFloats(stKey, afValue, 3))
 		return FALSE;
-	}
 
-	pVector3->x = atof(pTokenVector->at(0).c_str());
-	pVector3->y = atof(pTokenVector->at(1).c_str());
-	pVector3->z = atof(pTokenVector->at(2).c_str());
+	pVector3->x = afValue[0];
+	pVector3->y = afValue[1];
+	pVector3->z = afValue[2];
 
 	return TRUE;
 }
 
-BOOL CTextFileLoader::GetTokenVector4(const std::string & c_rstrKey, D3DXVECTOR4 * pVector4)
+BOOL CTextFileLoader::GetTokenVector4(std::string_view stKey, D3DXVECTOR4 * pVector4)
 {
-	CTokenVector * pTokenVector;
-	if (!GetTokenVector(c_rstrKey, &pTokenVector))
+	float afValue[4];
+	if (!__GetTokenFloats(stKey, afValue, 4))
 		return FALSE;
-	
-	if (pTokenVector->size() != 4)
-	{
-		//Tracef(" CTextFileLoader::GetTokenVector3 - This key should have 3 values %s [%s : %s]\n", m_File.GetFileName(), m_pcurNode->strGroupName.c_str(), c_rstrKey.c_str());
-		return FALSE;
-	}
-	
-	pVector4->x = atof(pTokenVector->at(0).c_str());
-	pVector4->y = atof(pTokenVector->at(1).c_str());
-	pVector4->z = atof(pTokenVector->at(2).c_str());
-	pVector4->w = atof(pTokenVector->at(3).c_str());
-	
+
+	pVector4->x = afValue[0];
+	pVector4->y = afValue[1];
+	pVector4->z = afValue[2];
+	pVector4->w = afValue[3];
+
 	return TRUE;
 }
 
-
-BOOL CTextFileLoader::GetTokenPosition(const std::string & c_rstrKey, D3DXVECTOR3 * pVector)
+BOOL CTextFileLoader::GetTokenPosition(std::string_view stKey, D3DXVECTOR3 * pVector)
 {
-	return GetTokenVector3(c_rstrKey, pVector);
+	return GetTokenVector3(stKey, pVector);
 }
 
-BOOL CTextFileLoader::GetTokenQuaternion(const std::string & c_rstrKey, D3DXQUATERNION * pQ)
+BOOL CTextFileLoader::GetTokenQuaternion(std::string_view stKey, D3DXQUATERNION * pQ)
 {
-	CTokenVector * pTokenVector;
-	if (!GetTokenVector(c_rstrKey, &pTokenVector))
-		return FALSE;
-	
-	if (pTokenVector->size() != 4)
-	{
-		//Tracef(" CTextFileLoader::GetTokenVector3 - This key should have 3 values %s [%s : %s]\n", m_File.GetFileName(), m_pcurNode->strGroupName.c_str(), c_rstrKey.c_str());
+	float afValue[4];
+	if (!__GetTokenFloats(stKey, afValue, 4))
 		return FALSE;
-	}
-	
-	pQ->x = atof(pTokenVector->at(0).c_str());
-	pQ->y = atof(pTokenVector->at(1).c_str());
-	pQ->z = atof(pTokenVector->at(2).c_str());
-	pQ->w = atof(pTokenVector->at(3).c_str());
-	
+
+	pQ->x = afValue[0];
+	pQ->y = afValue[1];
+	pQ->z = afValue[2];
+	pQ->w = afValue[3];
+
 	return TRUE;
 }
 
-BOOL CTextFileLoader::GetTokenDirection(const std::string & c_rstrKey, D3DVECTOR * pVector)
+BOOL CTextFileLoader::GetTokenDirection(std::string_view stKey, D3DVECTOR * pVector)
 {
-	CTokenVector * pTokenVector;
-	if (!GetTokenVector(c_rstrKey, &pTokenVector))
+	float afValue[3];
+	if (!__GetTokenFloats(stKey, afValue, 3))
 		return FALSE;
 
-	if (pTokenVector->size() != 3)
-	{
-		//Tracef(" CTextFileLoader::GetTokenDirection - This key should have 3 values %s [%s : %s]\n", m_File.GetFileName(), m_pcurNode->strGroupName.c_str(), c_rstrKey.c_str());
-		return FALSE;
-	}
-
-	pVector->x = atof(pTokenVector->at(0).c_str());
-	pVector->y = atof(pTokenVector->at(1).c_str());
-	pVector->z = atof(pTokenVector->at(2).c_str());
+	pVector->x = afValue[0];
+	pVector->y = afValue[1];
+	pVector->z = afValue[2];
 
 	return TRUE;
 }
 
-BOOL CTextFileLoader::GetTokenColor(const std::string & c_rstrKey, D3DXCOLOR * pColor)
+BOOL CTextFileLoader::GetTokenColor(std::string_view stKey, D3DXCOLOR * pColor)
 {
-	CTokenVector * pTokenVector;
-	if (!GetTokenVector(c_rstrKey, &pTokenVector))
-		return FALSE;
-
-	if (pTokenVector->size() != 4)
-	{
-		//Tracef(" CTextFileLoader::GetTokenColor - This key should have 4 values %s [%s : %s]\n", m_File.GetFileName(), m_pcurNode->strGroupName.c_str(), c_rstrKey.c_str());
+	float afValue[4];
+	if (!__GetTokenFloats(stKey, afValue, 4))
 		return FALSE;
-	}
 
-	pColor->r = atof(pTokenVector->at(0).c_str());
-	pColor->g = atof(pTokenVector->at(1).c_str());
-	pColor->b = atof(pTokenVector->at(2).c_str());
-	pColor->a = atof(pTokenVector->at(3).c_str());
+	pColor->r = afValue[0];
+	pColor->g = afValue[1];
+	pColor->b = afValue[2];
+	pColor->a = afValue[3];
 
 	return TRUE;
 }
 
-BOOL CTextFileLoader::GetTokenColor(const std::string & c_rstrKey, D3DCOLORVALUE * pColor)
+BOOL CTextFileLoader::GetTokenColor(std::string_view stKey, D3DCOLORVALUE * pColor)
 {
-	CTokenVector * pTokenVector;
-	if (!GetTokenVector(c_rstrKey, &pTokenVector))
+	float afValue[4];
+	if (!__GetTokenFloats(stKey, afValue, 4))
 		return FALSE;
 
-	if (pTokenVector->size() != 4)
-	{
-		//Tracef(" CTextFileLoader::GetTokenColor - This key should have 4 values %s [%s : %s]\n", m_File.GetFileName(), m_pcurNode->strGroupName.c_str(), c_rstrKey.c_str());
-		return FALSE;
-	}
-
-	pColor->r = atof(pTokenVector->at(0).c_str());
-	pColor->g = atof(pTokenVector->at(1).c_str());
-	pColor->b = atof(pTokenVector->at(2).c_str());
-	pColor->a = atof(pTokenVector->at(3).c_str());
+	pColor->r = afValue[0];
+	pColor->g = afValue[1];
+	pColor->b = afValue[2];
+	pColor->a = afValue[3];
 
 	return TRUE;
 }
 
-BOOL CTextFileLoader::GetTokenString(const std::string & c_rstrKey, std::string * pString)
+BOOL CTextFileLoader::GetTokenString(std::string_view stKey, std::string * pString)
 {
-	CTokenVector * pTokenVector;
-	if (!GetTokenVector(c_rstrKey, &pTokenVector))
+	std::span<const std::string_view> kTokens;
+	if (!GetTokenViews(stKey, &kTokens) || kTokens.empty())
 		return FALSE;
 
-	if (pTokenVector->empty())
-	{
-		//Tracef(" CTextFileLoader::GetTokenString - Failed to find the value %s [%s : %s]\n", m_File.GetFileName(), m_pcurNode->strGroupName.c_str(), c_rstrKey.c_str());
-		return FALSE;
-	}
-
-	*pString = pTokenVector->at(0);
+	pString->assign(kTokens[0]);
 
 	return TRUE;
 }
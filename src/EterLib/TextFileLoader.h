@@ -5,11 +5,26 @@
 #include "EterLib/Util.h"
 #include "EterLib/Pool.h"
 
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+struct TGroupFileToken;
+
 class CTextFileLoader
 {
 	public:
 		typedef struct SGroupNode
 		{
+			// a key and the tokens that follow it, as a range of the owning loader's token views
+			struct STokenRange
+			{
+				DWORD dwKey;
+				DWORD dwFirst;
+				DWORD dwCount;
+			};
+
 			static DWORD GenNameKey(const char* c_szGroupName, UINT uGroupNameLen);
 
 			void SetGroupName(const std::string& c_rstGroupName);
@@ -17,14 +32,18 @@ class CTextFileLoader
 
 			const std::string& GetGroupName();
 
-			CTokenVector* GetTokenVector(const std::string& c_rstGroupName);
-			bool IsExistTokenVector(const std::string& c_rstGroupName);
-			void InsertTokenVector(const std::string& c_rstGroupName, const CTokenVector& c_rkVct_stToken);
+			bool GetTokenViews(std::string_view c_stGroupName, std::span<const std::string_view> * pTokens);
+			CTokenVector* GetTokenVector(std::string_view c_stGroupName);
+			bool IsExistTokenVector(std::string_view c_stGroupName);
+			void InsertTokenRange(DWORD dwKey, DWORD dwFirst, DWORD dwCount);
+			void SortTokenRanges();
 
 			DWORD m_dwGroupNameKey;
 			std::string m_strGroupName;
 
-			std::map<DWORD, CTokenVector> m_kMap_dwKey_kVct_stToken;
+			const CTokenViewVector * m_pkVct_stToken;
+			std::vector<STokenRange> m_kVct_kTokenRange;			// sorted by key once loaded, the first of equal keys wins
+			std::map<DWORD, CTokenVector> m_kMap_dwKey_kVct_stToken;	// string copies made on demand by GetTokenVector
 
 			SGroupNode * pParentNode;
 			std::vector<SGroupNode*> ChildNodeVector;
@@ -83,40 +102,48 @@ class CTextFileLoader
 		BOOL SetParentNode();
 		BOOL GetCurrentNodeName(std::string * pstrName);
 
-		BOOL IsToken(const std::string & c_rstrKey);
-		BOOL GetTokenVector(const std::string & c_rstrKey, CTokenVector ** ppTokenVector);
-		BOOL GetTokenBoolean(const std::string & c_rstrKey, BOOL * pData);
-		BOOL GetTokenByte(const std::string & c_rstrKey, BYTE * pData);
-		BOOL GetTokenWord(const std::string & c_rstrKey, WORD * pData);
-		BOOL GetTokenInteger(const std::string & c_rstrKey, int * pData);
-		BOOL GetTokenDoubleWord(const std::string & c_rstrKey, DWORD * pData);
-		BOOL GetTokenFloat(const std::string & c_rstrKey, float * pData);
-		BOOL GetTokenVector2(const std::string & c_rstrKey, D3DXVECTOR2 * pVector2);
-		BOOL GetTokenVector3(const std::string & c_rstrKey, D3DXVECTOR3 * pVector3);
-		BOOL GetTokenVector4(const std::string & c_rstrKey, D3DXVECTOR4 * pVector4);
-
-		BOOL GetTokenPosition(const std::string & c_rstrKey, D3DXVECTOR3 * pVector);
-		BOOL GetTokenQuaternion(const std::string & c_rstrKey, D3DXQUATERNION * pQ);
-		BOOL GetTokenDirection(const std::string & c_rstrKey, D3DVECTOR * pVector);
-		BOOL GetTokenColor(const std::string & c_rstrKey, D3DXCOLOR * pColor);
-		BOOL GetTokenColor(const std::string & c_rstrKey, D3DCOLORVALUE * pColor);
-		BOOL GetTokenString(const std::string & c_rstrKey, std::string * pString);
+		// Tokens are kept as views into the loaded text, GetTokenVector copies a key's tokens into strings
+		// the first time it is asked for them. The scalar getters below parse the views directly, or take
+		// the values PackMaker already parsed when the file was packed in its compiled form (see GroupFile.h).
+		BOOL IsToken(std::string_view stKey);
+		BOOL GetTokenViews(std::string_view stKey, std::span<const std::string_view> * pTokens);
+		BOOL GetTokenVector(std::string_view stKey, CTokenVector ** ppTokenVector);
+		BOOL GetTokenBoolean(std::string_view stKey, BOOL * pData);
+		BOOL GetTokenByte(std::string_view stKey, BYTE * pData);
+		BOOL GetTokenWord(std::string_view stKey, WORD * pData);
+		BOOL GetTokenInteger(std::string_view stKey, int * pData);
+		BOOL GetTokenDoubleWord(std::string_view stKey, DWORD * pData);
+		BOOL GetTokenFloat(std::string_view stKey, float * pData);
+		BOOL GetTokenVector2(std::string_view stKey, D3DXVECTOR2 * pVector2);
+		BOOL GetTokenVector3(std::string_view stKey, D3DXVECTOR3 * pVector3);
+		BOOL GetTokenVector4(std::string_view stKey, D3DXVECTOR4 * pVector4);
+
+		BOOL GetTokenPosition(std::string_view stKey, D3DXVECTOR3 * pVector);
+		BOOL GetTokenQuaternion(std::string_view stKey, D3DXQUATERNION * pQ);
+		BOOL GetTokenDirection(std::string_view stKey, D3DVECTOR * pVector);
+		BOOL GetTokenColor(std::string_view stKey, D3DXCOLOR * pColor);
+		BOOL GetTokenColor(std::string_view stKey, D3DCOLORVALUE * pColor);
+		BOOL GetTokenString(std::string_view stKey, std::string * pString);
 
 	protected:
 		void __DestroyGroupNodeVector();
 
-		bool LoadGroup(TGroupNode * pGroupNode);
+		bool __LoadText(std::string_view stText);
+		bool __LoadCompiled(std::span<const uint8_t> kData);
+
+		int __GetTokenInteger(const std::string_view & c_rstToken);
+		float __GetTokenFloat(const std::string_view & c_rstToken);
+		BOOL __GetTokenFloats(std::string_view stKey, float * pValues, size_t uCount);
+
+		static DWORD __GenLowerNameKey(std::string_view stName);
 
 	protected:
 		std::string					m_strFileName;
 
-		char*						m_acBufData;
-		DWORD						m_dwBufSize;
-		DWORD						m_dwBufCapacity;
-
-		DWORD						m_dwcurLineIndex;
+		CTokenViewVector			m_kVct_stToken;		// every value token of the file, nodes refer to ranges of it
 
-		CMemoryTextFileLoader		m_textFileLoader;
+		std::vector<uint8_t>		m_kFile;				// TPackFile, holds a file that couldn't be read in place
+		const TGroupFileToken *		m_pkCompiledToken;		// parsed values parallel to m_kVct_stToken, NULL for text
 
 		TGroupNode					m_GlobalNode;
 		TGroupNode *				m_pcurNode;
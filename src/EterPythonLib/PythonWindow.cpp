@@ -1351,13 +1351,23 @@ namespace UI
 	}
 
 	BOOL CImageBox::LoadImage(const char * c_szFileName)
+	{
+		return __LoadImage(c_szFileName, false);
+	}
+
+	BOOL CImageBox::LoadImageFromFile(const char* c_szFileName)
+	{
+		return __LoadImage(c_szFileName, true);
+	}
+
+	BOOL CImageBox::__LoadImage(const char * c_szFileName, bool bLooseFile)
 	{
 		if (!c_szFileName[0])
 			return FALSE;
 
 		OnCreateInstance();
 
-		CResource * pResource = CResourceManager::Instance().GetResourcePointer(c_szFileName);
+		CResource * pResource = CResourceManager::Instance().GetResourcePointer(c_szFileName, bLooseFile);
 		if (!pResource)
 			return FALSE;
 		if (!pResource->IsType(CGraphicImage::Type()))
@@ -1373,15 +1383,6 @@ namespace UI
 		return TRUE;
 	}
 
-	BOOL CImageBox::LoadImageFromFile(const char* c_szFileName)
-	{
-		CPackManager::instance().SetFileLoadMode();
-		BOOL r = LoadImage(c_szFileName);
-		CPackManager::instance().SetPackLoadMode();
-
-		return r;
-	}
-
 	void CImageBox::SetDiffuseColor(float fr, float fg, float fb, float fa)
 	{
 		if (!m_pImageInstance)
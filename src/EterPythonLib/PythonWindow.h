@@ -373,6 +373,8 @@ namespace UI
 			int GetHeight();
 
 		protected:
+			BOOL __LoadImage(const char * c_szFileName, bool bLooseFile);
+
 			virtual void OnCreateInstance();
 			virtual void OnDestroyInstance();
 
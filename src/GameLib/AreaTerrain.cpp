@@ -1,6 +1,7 @@
 #include "StdAfx.h"
 #include "PRTerrainLib/StdAfx.h"
 
+#include "EterBase/TimeProfiler.h"
 #include "EterLib/ResourceManager.h"
 #include "EterLib/StateManager.h"
 #include "PackLib/PackManager.h"
@@ -69,14 +70,13 @@ bool CTerrain::Initialize()
 
 void CTerrain::LoadMiniMapTexture(const char * c_pchMiniMapFileName)
 {
-	DWORD dwStart = ELTimer_GetMSec();
+	TIME_PROFILE_SCOPE("CTerrain::LoadMiniMapTexture");
 	CGraphicImage * pImage = (CGraphicImage *) CResourceManager::Instance().GetResourcePointer(c_pchMiniMapFileName);
 	m_MiniMapGraphicImageInstance.SetImagePointer(pImage);
 	
 	if (!m_MiniMapGraphicImageInstance.GetTexturePointer()->IsEmpty())
 	{
 		m_lpMiniMapTexture = m_MiniMapGraphicImageInstance.GetTexturePointer()->GetD3DTexture();
-		Tracef("CTerrain::LoadMiniMapTexture %d ms\n", ELTimer_GetMSec() - dwStart);
 	}
 	else
 	{
@@ -87,7 +87,7 @@ void CTerrain::LoadMiniMapTexture(const char * c_pchMiniMapFileName)
 
 void CTerrain::LoadShadowTexture(const char * ShadowFileName)
 {
-	DWORD dwStart = ELTimer_GetMSec();
+	TIME_PROFILE_SCOPE("CTerrain::LoadShadowTexture");
 	CGraphicImage * pImage = (CGraphicImage *) CResourceManager::Instance().GetResourcePointer(ShadowFileName);
 	m_ShadowGraphicImageInstance.SetImagePointer(pImage);
 
@@ -98,13 +98,11 @@ void CTerrain::LoadShadowTexture(const char * ShadowFileName)
 		TraceError(" CTerrain::LoadShadowTexture - ShadowTexture is Empty");
 		m_lpShadowTexture = NULL;
 	}
-	Tracef("CTerrain::LoadShadowTexture %d ms\n", ELTimer_GetMSec() - dwStart);
 }
 
 bool CTerrain::LoadShadowMap(const char * c_pszFileName)
 {
-	DWORD dwStart = ELTimer_GetMSec();
-	Tracef("LoadShadowMap %s ", c_pszFileName);
+	TIME_PROFILE_SCOPE("CTerrain::LoadShadowMap");
 
 	TPackFile file;
 
@@ -123,8 +121,6 @@ bool CTerrain::LoadShadowMap(const char * c_pszFileName)
 	}
 
 	memcpy(m_awShadowMap, file.data(), dwShadowMapSize);
-
-	Tracef("%d ms\n", ELTimer_GetMSec() - dwStart);
 	return true;
 }
 
@@ -460,21 +456,20 @@ void CTerrain::CalculateNormal(long x, long y)
 bool CTerrain::RAW_LoadTileMap(const char * c_pszFileName, bool bBGLoading)
 {
 	CTerrainImpl::RAW_LoadTileMap(c_pszFileName);
-	DWORD dwStart = ELTimer_GetMSec();
+
+	TIME_PROFILE_SCOPE("CTerrain::RAW_AllocateSplats");
 	RAW_AllocateSplats(bBGLoading);
-	Tracef("CTerrain::RAW_AllocateSplats %d\n", ELTimer_GetMSec() - dwStart);
 	return true;
 }
 
 bool CTerrain::LoadHeightMap(const char * c_pszFileName)
 {
 	CTerrainImpl::LoadHeightMap(c_pszFileName);
-	DWORD dwStart = ELTimer_GetMSec();
+
+	TIME_PROFILE_SCOPE("CTerrain::CalculateNormal");
 	for (WORD y = 0; y < NORMALMAP_YSIZE; ++y)
 		for (WORD x = 0; x < NORMALMAP_XSIZE; ++x)
 			CalculateNormal(x, y);
-		
-	Tracef("LoadHeightMap::CalculateNormal %d ms\n", ELTimer_GetMSec() - dwStart);
 	return true;
 }
 
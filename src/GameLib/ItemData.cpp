@@ -25,11 +25,13 @@ void CItemData::DestroySystem()
 
 CGraphicThing * CItemData::GetModelThing()
 {
+	__LoadFiles();
 	return m_pModelThing;
 }
 
 CGraphicThing * CItemData::GetSubModelThing()
 {
+	__LoadFiles();
 	if (m_pSubModelThing)
 		return m_pSubModelThing;
 	else
@@ -38,23 +40,27 @@ CGraphicThing * CItemData::GetSubModelThing()
 
 CGraphicThing * CItemData::GetDropModelThing()
 {
+	__LoadFiles();
 	return m_pDropModelThing;
 }
 
 CGraphicSubImage * CItemData::GetIconImage()
 {
-	if(m_pIconImage == NULL && m_strIconFileName.empty() == false)
+	if(m_pIconImage == NULL && __GetIconFileName().empty() == false)
 		__SetIconImage(m_strIconFileName.c_str());
 	return m_pIconImage;
 }
 
 DWORD CItemData::GetLODModelThingCount()
 {
+	__LoadFiles();
 	return m_pLODModelThingVector.size();
 }
 
 BOOL CItemData::GetLODModelThingPointer(DWORD dwIndex, CGraphicThing ** ppModelThing)
 {
+	__LoadFiles();
+
 	if (dwIndex >= m_pLODModelThingVector.size())
 		return FALSE;
 
@@ -164,17 +170,60 @@ void CItemData::SetDefaultItemData(const char * c_szIconFileName, const char * c
 		m_strDropModelFileName = "d:/ymir work/item/etc/item_bag.gr2";
 	}
 	m_strIconFileName = c_szIconFileName;
+	m_bIconPending = false;
 
 	m_strSubModelFileName = "";
 	m_strDescription = "";
 	m_strSummary = "";
 	memset(m_ItemTable.alSockets, 0, sizeof(m_ItemTable.alSockets));
 
-	__LoadFiles();
+	m_bFilesLoaded = false;
+}
+
+void CItemData::SetDefaultItemDataByVnum(DWORD dwIconFallbackVnum)
+{
+	SetDefaultItemData("");
+
+	m_dwIconFallbackVnum = dwIconFallbackVnum;
+	m_bIconPending = true;
+}
+
+const std::string & CItemData::__GetIconFileName()
+{
+	if (!m_bIconPending)
+		return m_strIconFileName;
+
+	m_bIconPending = false;
+
+	char szName[64+1];
+	_snprintf(szName, sizeof(szName), "icon/item/%05d.tga", m_ItemTable.dwVnum);
+
+	if (!CResourceManager::Instance().IsFileExist(szName))
+	{
+		_snprintf(szName, sizeof(szName), "icon/item/%05d.tga", m_dwIconFallbackVnum);
+
+		if (!CResourceManager::Instance().IsFileExist(szName))
+		{
+			#ifdef _DEBUG
+			TraceError("%16s(#%-5d) cannot find icon file. setting to default.", m_ItemTable.szName, m_ItemTable.dwVnum);
+			#endif
+			const DWORD EmptyBowl = 27995;
+			_snprintf(szName, sizeof(szName), "icon/item/%05d.tga", EmptyBowl);
+		}
+	}
+
+	m_strIconFileName = szName;
+	return m_strIconFileName;
 }
 
 void CItemData::__LoadFiles()
 {
+	// the models are looked up on first use, most items are never drawn in a session
+	if (m_bFilesLoaded)
+		return;
+
+	m_bFilesLoaded = true;
+
 	// Model File Name
 	if (!m_strModelFileName.empty())
 		m_pModelThing = (CGraphicThing *)CResourceManager::Instance().GetResourcePointer(m_strModelFileName.c_str());
@@ -210,7 +259,7 @@ void CItemData::__SetIconImage(const char * c_szFileName)
 		m_pIconImage = (CGraphicSubImage *)CResourceManager::Instance().GetResourcePointer(c_szFileName);
 }
 
-void CItemData::SetItemTableData(TItemTable * pItemTable)
+void CItemData::SetItemTableData(const TItemTable * pItemTable)
 {
 	memcpy(&m_ItemTable, pItemTable, sizeof(TItemTable));
 }
@@ -451,6 +500,10 @@ void CItemData::Clear()
 	m_pIconImage = NULL;
 	m_pLODModelThingVector.clear();
 
+	m_dwIconFallbackVnum = 0;
+	m_bIconPending = false;
+	m_bFilesLoaded = true;
+
 	memset(&m_ItemTable, 0, sizeof(m_ItemTable));
 }
 
@@ -489,11 +489,15 @@ class CItemData
 
 		//BOOL LoadItemData(const char * c_szFileName);
 		void SetDefaultItemData(const char * c_szIconFileName, const char * c_szModelFileName  = NULL);
-		void SetItemTableData(TItemTable * pItemTable);
+		// item_proto rows missing from item_list: the icon is icon/item/<vnum>.tga, else that of dwIconFallbackVnum,
+		// resolved on the first GetIconImage instead of probing the packs for every row while loading
+		void SetDefaultItemDataByVnum(DWORD dwIconFallbackVnum);
+		void SetItemTableData(const TItemTable * pItemTable);
 
 	protected:
 		void __LoadFiles();
 		void __SetIconImage(const char * c_szFileName);
+		const std::string & __GetIconFileName();
 
 	protected:
 		std::string m_strModelFileName;
@@ -510,6 +514,10 @@ class CItemData
 		CGraphicSubImage * m_pIconImage;
 		std::vector<CGraphicThing *> m_pLODModelThingVector;
 
+		DWORD		m_dwIconFallbackVnum;
+		bool		m_bIconPending;
+		bool		m_bFilesLoaded;
+
 		NRaceData::TAttachingDataVector m_AttachingDataVector;
 		DWORD		m_dwVnum;
 		TItemTable m_ItemTable;
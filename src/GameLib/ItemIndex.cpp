@@ -0,0 +1,94 @@
+#include "StdAfx.h"
+#include "ItemIndex.h"
+
+#include <algorithm>
+
+void CItemIndex::Clear()
+{
+	m_kVct_kItem.clear();
+	m_kVct_kRangeSegment.clear();
+}
+
+void CItemIndex::Build(const std::map<DWORD, CItemData *> & c_rkMap_pItemData, const std::vector<TItemRange> & c_rkVct_kRange)
+{
+	m_kVct_kItem.assign(c_rkMap_pItemData.begin(), c_rkMap_pItemData.end());
+
+	// The bounds of all ranges cut the vnums into segments, each of which gets the first range covering it.
+	std::vector<DWORD> kVct_dwBound;
+	kVct_dwBound.reserve(c_rkVct_kRange.size() * 2);
+
+	for (size_t i = 0; i < c_rkVct_kRange.size(); ++i)
+	{
+		const TItemRange & c_rkRange = c_rkVct_kRange[i];
+		if (c_rkRange.dwVnumRange <= 1)
+			continue;
+
+		kVct_dwBound.push_back(c_rkRange.dwVnum + 1);
+		kVct_dwBound.push_back(c_rkRange.dwVnum + c_rkRange.dwVnumRange);
+	}
+
+	std::sort(kVct_dwBound.begin(), kVct_dwBound.end());
+	kVct_dwBound.erase(std::unique(kVct_dwBound.begin(), kVct_dwBound.end()), kVct_dwBound.end());
+
+	std::vector<CItemData *> kVct_pSegmentItem(kVct_dwBound.empty() ? 0 : kVct_dwBound.size() - 1, NULL);
+
+	for (size_t i = 0; i < c_rkVct_kRange.size(); ++i)
+	{
+		const TItemRange & c_rkRange = c_rkVct_kRange[i];
+		if (c_rkRange.dwVnumRange <= 1)
+			continue;
+
+		size_t uFirst = std::lower_bound(kVct_dwBound.begin(), kVct_dwBound.end(), c_rkRange.dwVnum + 1) - kVct_dwBound.begin();
+		size_t uLast = std::lower_bound(kVct_dwBound.begin(), kVct_dwBound.end(), c_rkRange.dwVnum + c_rkRange.dwVnumRange) - kVct_dwBound.begin();
+
+		for (size_t j = uFirst; j < uLast; ++j)
+		{
+			if (!kVct_pSegmentItem[j])
+				kVct_pSegmentItem[j] = c_rkRange.pItemData;
+		}
+	}
+
+	// neighbours held by the same item are merged, gaps between ranges are left out
+	m_kVct_kRangeSegment.clear();
+
+	for (size_t j = 0; j < kVct_pSegmentItem.size(); ++j)
+	{
+		if (!kVct_pSegmentItem[j])
+			continue;
+
+		if (!m_kVct_kRangeSegment.empty() && m_kVct_kRangeSegment.back().pItemData == kVct_pSegmentItem[j] && m_kVct_kRangeSegment.back().dwEnd == kVct_dwBound[j])
+		{
+			m_kVct_kRangeSegment.back().dwEnd = kVct_dwBound[j + 1];
+			continue;
+		}
+
+		TItemRangeSegment kSegment;
+		kSegment.dwBegin = kVct_dwBound[j];
+		kSegment.dwEnd = kVct_dwBound[j + 1];
+		kSegment.pItemData = kVct_pSegmentItem[j];
+		m_kVct_kRangeSegment.push_back(kSegment);
+	}
+}
+
+CItemData * CItemIndex::Find(DWORD dwVnum) const
+{
+	TItemVector::const_iterator f = std::lower_bound(m_kVct_kItem.begin(), m_kVct_kItem.end(), dwVnum,
+		[](const TItemVector::value_type & c_rkItem, DWORD dwVnum) { return c_rkItem.first < dwVnum; });
+
+	if (m_kVct_kItem.end() != f && f->first == dwVnum)
+		return f->second;
+
+	// the last segment starting at or before dwVnum is the only one that can hold it
+	std::vector<TItemRangeSegment>::const_iterator s = std::upper_bound(m_kVct_kRangeSegment.begin(), m_kVct_kRangeSegment.end(), dwVnum,
+		[](DWORD dwVnum, const TItemRangeSegment & c_rkSegment) { return dwVnum < c_rkSegment.dwBegin; });
+
+	if (m_kVct_kRangeSegment.begin() == s)
+		return NULL;
+
+	--s;
+
+	if (dwVnum >= s->dwEnd)
+		return NULL;
+
+	return s->pItemData;
+}
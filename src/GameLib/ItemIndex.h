@@ -0,0 +1,44 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+class CItemData;
+
+// Vnum lookup of CItemManager. Exact vnums sit in a vector sorted by vnum, ranged items, which answer for the
+// vnums strictly between dwVnum and dwVnum + dwVnumRange, are cut into non-overlapping segments. Both are
+// binary searched, a miss costs two searches instead of a scan over every ranged item.
+class CItemIndex
+{
+	public:
+		typedef struct SItemRange
+		{
+			DWORD		dwVnum;
+			DWORD		dwVnumRange;
+			CItemData *	pItemData;
+		} TItemRange;
+
+	public:
+		void			Clear();
+
+		// c_rkVct_kRange in load order, where ranges overlap the one loaded first wins, as it did in the old scan
+		void			Build(const std::map<DWORD, CItemData *> & c_rkMap_pItemData, const std::vector<TItemRange> & c_rkVct_kRange);
+
+		CItemData *		Find(DWORD dwVnum) const;
+
+	protected:
+		// lookup side of the item map, sorted by vnum
+		typedef std::vector<std::pair<DWORD, CItemData *> > TItemVector;
+
+		// [dwBegin, dwEnd) of the vnums a ranged item answers for, the segments don't overlap and are sorted
+		typedef struct SItemRangeSegment
+		{
+			DWORD		dwBegin;
+			DWORD		dwEnd;
+			CItemData *	pItemData;
+		} TItemRangeSegment;
+
+	protected:
+		TItemVector							m_kVct_kItem;
+		std::vector<TItemRangeSegment>		m_kVct_kRangeSegment;
+};
@@ -2,6 +2,7 @@
 #include "PackLib/PackManager.h"
 #include "EterLib/ResourceManager.h"
 #include "EterBase/lzo.h"
+#include "EterBase/ProtoCache.h"
 
 #include "ItemManager.h"
 
@@ -15,27 +16,15 @@ static DWORD s_adwItemProtoKey[4] =
 
 BOOL CItemManager::SelectItemData(DWORD dwIndex)
 {
-	TItemMap::iterator f = m_ItemMap.find(dwIndex);
+	CItemData * pItemData = __FindItemData(dwIndex);
 
-	if (m_ItemMap.end() == f)
+	if (!pItemData)
 	{
-		int n = m_vec_ItemRange.size();
-		for (int i = 0; i < n; i++)
-		{
-			CItemData * p = m_vec_ItemRange[i];
-			const CItemData::TItemTable * pTable = p->GetTable(); 
-			if ((pTable->dwVnum < dwIndex) &&
-				dwIndex < (pTable->dwVnum + pTable->dwVnumRange))
-			{
-				m_pSelectedItemData = p;
-				return TRUE;
-			}
-		}
 		Tracef(" CItemManager::SelectItemData - FIND ERROR [%d]\n", dwIndex);
 		return FALSE;
 	}
 
-	m_pSelectedItemData = f->second;
+	m_pSelectedItemData = pItemData;
 
 	return TRUE;
 }
@@ -50,27 +39,15 @@ BOOL CItemManager::GetItemDataPointer(DWORD dwItemID, CItemData ** ppItemData)
 	if (0 == dwItemID)
 		return FALSE;
 
-	TItemMap::iterator f = m_ItemMap.find(dwItemID);
+	CItemData * pItemData = __FindItemData(dwItemID);
 
-	if (m_ItemMap.end() == f)
+	if (!pItemData)
 	{
-		int n = m_vec_ItemRange.size();
-		for (int i = 0; i < n; i++)
-		{
-			CItemData * p = m_vec_ItemRange[i];
-			const CItemData::TItemTable * pTable = p->GetTable(); 
-			if ((pTable->dwVnum < dwItemID) &&
-				dwItemID < (pTable->dwVnum + pTable->dwVnumRange))
-			{
-				*ppItemData = p;
-				return TRUE;
-			}
-		}
 		Tracef(" CItemManager::GetItemDataPointer - FIND ERROR [%d]\n", dwItemID);
 		return FALSE;
 	}
 
-	*ppItemData = f->second;
+	*ppItemData = pItemData;
 
 	return TRUE;
 }
@@ -84,6 +61,7 @@ CItemData * CItemManager::MakeItemData(DWORD dwIndex)
 		CItemData * pItemData = CItemData::New();
 
 		m_ItemMap.insert(TItemMap::value_type(dwIndex, pItemData));		
+		m_bIndexDirty = true;
 
 		return pItemData;
 	}
@@ -91,6 +69,35 @@ CItemData * CItemManager::MakeItemData(DWORD dwIndex)
 	return f->second;
 }
 
+CItemData * CItemManager::__FindItemData(DWORD dwVnum)
+{
+	if (m_bIndexDirty)
+		__BuildIndex();
+
+	return m_kItemIndex.Find(dwVnum);
+}
+
+void CItemManager::__BuildIndex()
+{
+	m_bIndexDirty = false;
+
+	std::vector<CItemIndex::TItemRange> kVct_kRange;
+	kVct_kRange.reserve(m_vec_ItemRange.size());
+
+	for (size_t i = 0; i < m_vec_ItemRange.size(); ++i)
+	{
+		const CItemData::TItemTable * c_pTable = m_vec_ItemRange[i]->GetTable();
+
+		CItemIndex::TItemRange kRange;
+		kRange.dwVnum = c_pTable->dwVnum;
+		kRange.dwVnumRange = c_pTable->dwVnumRange;
+		kRange.pItemData = m_vec_ItemRange[i];
+		kVct_kRange.push_back(kRange);
+	}
+
+	m_kItemIndex.Build(m_ItemMap, kVct_kRange);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 // Load Item Table
 
@@ -254,111 +261,111 @@ DWORD GetHashCode( const char* pString )
 bool CItemManager::LoadItemTable(const char* c_szFileName)
 {	
 	TPackFile file;
-	LPCVOID pvData;
 
 	if (!CPackManager::Instance().GetFile(c_szFileName, file))
 		return false;
 
-	DWORD dwFourCC, dwElements, dwDataSize;
-	DWORD dwVersion=0;
-	DWORD dwStride=0;
+	// only runs when the cache file is missing or stale, the rows are read straight from it otherwise
+	auto fnDecode = [c_szFileName](const BYTE * c_pbSource, DWORD dwSourceSize, std::vector<BYTE> & rvecRows)
+	{
+		DWORD dwFourCC, dwElements;
+		DWORD dwVersion=0;
+		DWORD dwStride=0;
 
-	uint8_t* p = file.data();
-	memcpy(&dwFourCC, p, sizeof(DWORD));
-	p += sizeof(DWORD);
+		const BYTE * p = c_pbSource;
+		const BYTE * c_pbEnd = c_pbSource + dwSourceSize;
 
-	if (dwFourCC == MAKEFOURCC('M', 'I', 'P', 'X'))
-	{
-		memcpy(&dwVersion, p, sizeof(DWORD));
-		p += sizeof(DWORD);
+		if (dwSourceSize < sizeof(DWORD) * 5)
+			return false;
 
-		memcpy(&dwStride, p, sizeof(DWORD));
+		memcpy(&dwFourCC, p, sizeof(DWORD));
 		p += sizeof(DWORD);
-	
-		if (dwVersion != 1)
+
+		if (dwFourCC == MAKEFOURCC('M', 'I', 'P', 'X'))
 		{
-			TraceError("CPythonItem::LoadItemTable: invalid item_proto[%s] VERSION[%d]", c_szFileName, dwVersion);
-			return false;
+			memcpy(&dwVersion, p, sizeof(DWORD));
+			p += sizeof(DWORD);
+
+			memcpy(&dwStride, p, sizeof(DWORD));
+			p += sizeof(DWORD);
+		
+			if (dwVersion != 1)
+			{
+				TraceError("CPythonItem::LoadItemTable: invalid item_proto[%s] VERSION[%d]", c_szFileName, dwVersion);
+				return false;
+			}
+			if (dwStride != sizeof(CItemData::TItemTable))
+			{
+				TraceError("CPythonItem::LoadItemTable: invalid item_proto[%s] STRIDE[%d] != sizeof(SItemTable)", 
+					c_szFileName, dwStride, sizeof(CItemData::TItemTable));
+				return false;
+			}
 		}
-		if (dwStride != sizeof(CItemData::TItemTable))
+		else if (dwFourCC != MAKEFOURCC('M', 'I', 'P', 'T'))
 		{
-			TraceError("CPythonItem::LoadItemTable: invalid item_proto[%s] STRIDE[%d] != sizeof(SItemTable)", 
-				c_szFileName, dwStride, sizeof(CItemData::TItemTable));
+			TraceError("CPythonItem::LoadItemTable: invalid item proto type %s", c_szFileName);
 			return false;
 		}
-	}
-	else if (dwFourCC != MAKEFOURCC('M', 'I', 'P', 'T'))
-	{
-		TraceError("CPythonItem::LoadItemTable: invalid item proto type %s", c_szFileName);
-		return false;
-	}
 
-	memcpy(&dwElements, p, sizeof(DWORD));
-	p += sizeof(DWORD);
+		if (p + sizeof(DWORD) * 2 > c_pbEnd)
+			return false;
 
-	memcpy(&dwDataSize, p, sizeof(DWORD));
-	p += sizeof(DWORD);
+		memcpy(&dwElements, p, sizeof(DWORD));
+		p += sizeof(DWORD);
 
-	BYTE * pbData = new BYTE[dwDataSize];
-	memcpy(pbData, p, dwDataSize);
+		// the data size, the LZO header carries it again
+		p += sizeof(DWORD);
 
-	/////
+		CLZObject zObj;
 
-	CLZObject zObj;
+		if (!CLZO::Instance().Decompress(zObj, p, s_adwItemProtoKey))
+			return false;
 
-	if (!CLZO::Instance().Decompress(zObj, pbData, s_adwItemProtoKey))
-	{
-		delete [] pbData;
+		if (zObj.GetSize() < dwElements * sizeof(CItemData::TItemTable))
+		{
+			TraceError("CPythonItem::LoadItemTable: item_proto[%s] holds less than %u items", c_szFileName, dwElements);
+			return false;
+		}
+
+		rvecRows.assign(zObj.GetBuffer(), zObj.GetBuffer() + dwElements * sizeof(CItemData::TItemTable));
+		return true;
+	};
+
+	CProtoCache kItemProto;
+
+	if (!kItemProto.Load(c_szFileName, file.data(), file.size(), sizeof(CItemData::TItemTable), s_adwItemProtoKey, fnDecode))
 		return false;
-	}
 
 	/////
 
-	char szName[64+1];
-	
-	CItemData::TItemTable * table = (CItemData::TItemTable *) zObj.GetBuffer();
+	DWORD dwElements = kItemProto.GetCount();
 	std::map<DWORD,DWORD> itemNameMap;
 
-	for (DWORD i = 0; i < dwElements; ++i, ++table)
+	for (DWORD i = 0; i < dwElements; ++i)
 	{
+		const CItemData::TItemTable * table = (const CItemData::TItemTable *) kItemProto.GetRow(i);
 		CItemData * pItemData;
 		DWORD dwVnum = table->dwVnum;
+		DWORD dwNameHash = GetHashCode(table->szName);
 
 		TItemMap::iterator f = m_ItemMap.find(dwVnum);
 		if (m_ItemMap.end() == f)
 		{
-			_snprintf(szName, sizeof(szName), "icon/item/%05d.tga", dwVnum);
+			// an item without its own icon shows that of the first item of the same name, else of its grade 0
+			std::map<DWORD, DWORD>::iterator itVnum = itemNameMap.find(dwNameHash);
+			DWORD dwIconFallbackVnum = (itVnum != itemNameMap.end()) ? itVnum->second : dwVnum - dwVnum % 10;
 
-			if (CResourceManager::Instance().IsFileExist(szName) == false)
-			{
-				std::map<DWORD, DWORD>::iterator itVnum = itemNameMap.find(GetHashCode(table->szName));
-				
-				if (itVnum != itemNameMap.end())
-					_snprintf(szName, sizeof(szName), "icon/item/%05d.tga", itVnum->second);
-				else
-					_snprintf(szName, sizeof(szName), "icon/item/%05d.tga", dwVnum-dwVnum % 10);
-
-				if (CResourceManager::Instance().IsFileExist(szName) == false)
-				{
-					#ifdef _DEBUG
-					TraceError("%16s(#%-5d) cannot find icon file. setting to default.", table->szName, dwVnum);
-					#endif
-					const DWORD EmptyBowl = 27995;
-					_snprintf(szName, sizeof(szName), "icon/item/%05d.tga", EmptyBowl);
-				}
-			}
-				
 			pItemData = CItemData::New();
 
-			pItemData->SetDefaultItemData(szName);
+			pItemData->SetDefaultItemDataByVnum(dwIconFallbackVnum);
 			m_ItemMap.insert(TItemMap::value_type(dwVnum, pItemData));
 		}
 		else
 		{
 			pItemData = f->second;
 		}	
-		if (itemNameMap.find(GetHashCode(table->szName)) == itemNameMap.end())
-			itemNameMap.insert(std::map<DWORD,DWORD>::value_type(GetHashCode(table->szName),table->dwVnum));
+		if (itemNameMap.find(dwNameHash) == itemNameMap.end())
+			itemNameMap.insert(std::map<DWORD,DWORD>::value_type(dwNameHash,table->dwVnum));
 		pItemData->SetItemTableData(table);
 		if (0 != table->dwVnumRange)
 		{
@@ -366,6 +373,8 @@ bool CItemManager::LoadItemTable(const char* c_szFileName)
 		}
 	}
 
+	m_bIndexDirty = true;
+
 //!@#
 //	CItemData::TItemTable * table = (CItemData::TItemTable *) zObj.GetBuffer();
 //	for (DWORD i = 0; i < dwElements; ++i, ++table)
@@ -389,7 +398,6 @@ bool CItemManager::LoadItemTable(const char* c_szFileName)
 //		pItemData->SetItemTableData(table);
 //	}
 
-	delete [] pbData;
 	return true;
 }
 
@@ -400,9 +408,13 @@ void CItemManager::Destroy()
 		CItemData::Delete(i->second);
 
 	m_ItemMap.clear();
+	m_vec_ItemRange.clear();
+
+	m_kItemIndex.Clear();
+	m_bIndexDirty = false;
 }
 
-CItemManager::CItemManager() : m_pSelectedItemData(NULL)
+CItemManager::CItemManager() : m_pSelectedItemData(NULL), m_bIndexDirty(false)
 {
 }
 CItemManager::~CItemManager()
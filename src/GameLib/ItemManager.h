@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ItemData.h"
+#include "ItemIndex.h"
 
 class CItemManager : public CSingleton<CItemManager>
 {
@@ -35,8 +36,16 @@ class CItemManager : public CSingleton<CItemManager>
 		bool			LoadItemTable(const char* c_szFileName);
 		CItemData *		MakeItemData(DWORD dwIndex);
 
+	protected:
+		CItemData *		__FindItemData(DWORD dwVnum);
+		void			__BuildIndex();
+
 	protected:
 		TItemMap m_ItemMap;
 		std::vector<CItemData*>  m_vec_ItemRange;
 		CItemData * m_pSelectedItemData;		
+
+		// rebuilt from m_ItemMap and m_vec_ItemRange on the first lookup after they changed
+		CItemIndex	m_kItemIndex;
+		bool		m_bIndexDirty;
 };
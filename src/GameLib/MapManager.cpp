@@ -1,4 +1,5 @@
 #include "StdAfx.h"
+#include "EterBase/TimeProfiler.h"
 #include "EterLib/StateManager.h"
 #include "PackLib/PackManager.h"
 
@@ -108,6 +109,8 @@ void CMapManager::LoadProperty()
 
 bool CMapManager::LoadMap(const std::string & c_rstrMapName, float x, float y, float z)
 {
+	TIME_PROFILE_SCOPE("CMapManager::LoadMap", c_rstrMapName.c_str());
+
 	CMapOutdoor& rkMap = GetMapOutdoorRef();
 
 	rkMap.Leave();
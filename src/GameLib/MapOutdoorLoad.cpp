@@ -1,4 +1,5 @@
 #include "StdAfx.h"
+#include "EterBase/TimeProfiler.h"
 #include "MapOutdoor.h"
 #include "AreaTerrain.h"
 #include "AreaLoaderThread.h"
@@ -9,6 +10,8 @@
 
 bool CMapOutdoor::Load(float x, float y, float z)
 {
+	TIME_PROFILE_SCOPE("CMapOutdoor::Load", GetName().c_str());
+
 	Destroy();
 
 	{
@@ -155,34 +158,23 @@ bool CMapOutdoor::LoadArea(WORD wAreaCoordX, WORD wAreaCoordY, WORD wCellCoordX,
 {
 	if (isAreaLoaded(wAreaCoordX, wAreaCoordY))
 		return true;
-#ifdef _DEBUG
-	DWORD dwStartTime = ELTimer_GetMSec();
-#endif
+
 	unsigned long ulID = (unsigned long) (wAreaCoordX) * 1000L + (unsigned long) (wAreaCoordY);
 	char szAreaPathName[64+1];
 	_snprintf(szAreaPathName, sizeof(szAreaPathName), "%s\\%06u\\", GetMapDataDirectory().c_str(), ulID);
 
+	TIME_PROFILE_SCOPE("CMapOutdoor::LoadArea", szAreaPathName);
+
 	CArea * pArea = CArea::New();
 	pArea->SetMapOutDoor(this);
-#ifdef _DEBUG
-	Tracef("CMapOutdoor::LoadArea1 %d\n", ELTimer_GetMSec() - dwStartTime);
-	dwStartTime = ELTimer_GetMSec();
-#endif
 
 	pArea->SetCoordinate(wAreaCoordX, wAreaCoordY);
 	if ( !pArea->Load(szAreaPathName) )
 		TraceError(" CMapOutdoor::LoadArea(%d, %d) LoadShadowMap ERROR", wAreaCoordX, wAreaCoordY);
-#ifdef _DEBUG
-	Tracef("CMapOutdoor::LoadArea2 %d\n", ELTimer_GetMSec() - dwStartTime);
-	dwStartTime = ELTimer_GetMSec();
-#endif
 
 	m_AreaVector.push_back(pArea);
 
 	pArea->EnablePortal(m_bEnablePortal);
-#ifdef _DEBUG
-	Tracef("CMapOutdoor::LoadArea3 %d\n", ELTimer_GetMSec() - dwStartTime);
-#endif
 
 	return true;
 }
@@ -193,11 +185,11 @@ bool CMapOutdoor::LoadTerrain(WORD wTerrainCoordX, WORD wTerrainCoordY, WORD wCe
 		return true;
 
 	//////////////////////////////////////////////////////////////////////////
-	DWORD dwStartTime = ELTimer_GetMSec();
-	
 	unsigned long ulID = (unsigned long) (wTerrainCoordX) * 1000L + (unsigned long) (wTerrainCoordY);
 	char filename[256];
 	sprintf(filename, "%s\\%06u\\AreaProperty.txt", GetMapDataDirectory().c_str(), ulID);
+
+	TIME_PROFILE_SCOPE("CMapOutdoor::LoadTerrain", filename);
 	
 	CTokenVectorMap stTokenVectorMap;
 	
@@ -275,8 +267,6 @@ bool CMapOutdoor::LoadTerrain(WORD wTerrainCoordX, WORD wTerrainCoordY, WORD wCe
 	pTerrain->CalculateTerrainPatch();
 	
 	pTerrain->SetReady();
-	
-	Tracef("CMapOutdoor::LoadTerrain %d\n", ELTimer_GetMSec() - dwStartTime);
 
 	m_TerrainVector.push_back(pTerrain);
 
@@ -18,15 +18,15 @@ bool CPropertyManager::Initialize(const char * c_pszPackFileName)
 	if (c_pszPackFileName)
 	{
 		m_pack = std::make_shared<CPack>();
-		if (!m_pack->Open(c_pszPackFileName, m_fileDict)) {
-			LogBoxf("Cannot open property pack file (filename %s)", c_pszPackFileName);
+		if (!m_pack->Open(c_pszPackFileName)) {
+			LogBoxf("Cannot open property pack file (filename %s): %s", c_pszPackFileName, m_pack->GetError().c_str());
 			return false;
 		}
 
 		m_isFileMode = false;
 
-		for (auto it = m_fileDict.begin(); it != m_fileDict.end(); ++it) {
-			std::string stFileName = it->second.second.file_name;
+		for (size_t i = 0; i < m_pack->GetEntryCount(); ++i) {
+			std::string stFileName(m_pack->GetEntryName(m_pack->GetEntry(i)));
 			if (!stricmp("property/reserve", stFileName.c_str())) {
 				LoadReservedCRC(stFileName.c_str());
 			}
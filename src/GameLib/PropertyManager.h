@@ -28,5 +28,4 @@ class CPropertyManager : public CSingleton<CPropertyManager>
 		TPropertyCRCMap								m_PropertyByCRCMap;
 		TCRCSet										m_ReservedCRCSet;
 		std::shared_ptr<CPack>						m_pack;
-		TPackFileMap								m_fileDict;
 };
@@ -0,0 +1,296 @@
+#include <windows.h>
+
+#include <map>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+#include <argparse.hpp>
+
+#include "GameLib/ItemIndex.h"
+
+// Replays a trace of item vnum lookups through CItemIndex and through the lookup CItemManager had before it
+// (std::map, then a scan over every ranged item), checks both give the same item for every lookup and prints
+// the best ns per lookup of each. The item set is generated from the counts and seed on the trace's first
+// line, laid out like an item_proto: vnums 5 apart, every 300th item a ranged one covering the next 4 vnums.
+
+// stands in for CItemData, the index only ever stores and returns the pointer
+struct THarnessItem
+{
+	DWORD dwVnum;
+	DWORD dwVnumRange;
+};
+
+static CItemData * AsItemData(const THarnessItem * c_pkItem)
+{
+	return (CItemData *) c_pkItem;
+}
+
+class CHarnessItemSet
+{
+public:
+	void Generate(DWORD item_count)
+	{
+		m_items.resize(item_count);
+		for (DWORD i = 0; i < item_count; ++i) {
+			m_items[i].dwVnum = 10 + i * 5;
+			m_items[i].dwVnumRange = i % 300 == 0 ? 5 : 0;
+		}
+
+		Build();
+	}
+
+	// overlapping ranges and vnums given twice, where the load order decides which item a vnum gets
+	void GenerateOverlapping(DWORD item_count, uint32_t (*next)(uint64_t&), uint64_t& random)
+	{
+		m_items.resize(item_count);
+		for (DWORD i = 0; i < item_count; ++i) {
+			m_items[i].dwVnum = next(random) % 2000;
+			m_items[i].dwVnumRange = next(random) % 3 ? 0 : next(random) % 60;
+		}
+
+		Build();
+	}
+
+	// CItemManager before the index: the map, and the ranged items scanned in load order
+	CItemData * FindByScan(DWORD dwVnum) const
+	{
+		auto f = m_item_map.find(dwVnum);
+		if (f != m_item_map.end())
+			return f->second;
+
+		for (const THarnessItem * c_pkItem : m_ranged_items) {
+			if (c_pkItem->dwVnum < dwVnum && dwVnum < c_pkItem->dwVnum + c_pkItem->dwVnumRange)
+				return AsItemData(c_pkItem);
+		}
+
+		return NULL;
+	}
+
+	const CItemIndex& GetIndex() const { return m_index; }
+	const std::vector<THarnessItem>& GetItems() const { return m_items; }
+	const std::vector<const THarnessItem*>& GetRangedItems() const { return m_ranged_items; }
+
+private:
+	// the way CItemManager::LoadItemTable fills its map and range list, then __BuildIndex
+	void Build()
+	{
+		m_item_map.clear();
+		m_ranged_items.clear();
+
+		std::vector<CItemIndex::TItemRange> ranges;
+		for (const THarnessItem& item : m_items) {
+			m_item_map.emplace(item.dwVnum, AsItemData(&item));
+
+			if (item.dwVnumRange) {
+				m_ranged_items.push_back(&item);
+				ranges.push_back({ item.dwVnum, item.dwVnumRange, AsItemData(&item) });
+			}
+		}
+
+		m_index.Build(m_item_map, ranges);
+	}
+
+private:
+	std::vector<THarnessItem> m_items;
+	std::map<DWORD, CItemData*> m_item_map;
+	std::vector<const THarnessItem*> m_ranged_items;
+	CItemIndex m_index;
+};
+
+// splitmix64, the same seed gives the same trace everywhere
+static uint32_t NextRandom(uint64_t& state)
+{
+	uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return (uint32_t) ((z ^ (z >> 31)) >> 32);
+}
+
+// inventory and tooltip refreshes: 95% from a working set of 180 vnums, 3% inside ranged items, 2% unknown
+static std::vector<DWORD> GenerateTrace(const CHarnessItemSet& item_set, size_t lookup_count, uint64_t seed)
+{
+	const auto& items = item_set.GetItems();
+	const auto& ranged_items = item_set.GetRangedItems();
+
+	uint64_t random = seed;
+	std::vector<DWORD> working_set;
+	for (int i = 0; i < 180; ++i)
+		working_set.push_back(items[NextRandom(random) % items.size()].dwVnum);
+
+	std::vector<DWORD> trace(lookup_count);
+	for (DWORD& vnum : trace) {
+		uint32_t roll = NextRandom(random) % 100;
+		if (roll < 95)
+			vnum = working_set[NextRandom(random) % working_set.size()];
+		else if (roll < 98 && !ranged_items.empty())
+			vnum = ranged_items[NextRandom(random) % ranged_items.size()]->dwVnum + 1 + NextRandom(random) % 4;
+		else
+			vnum = 200000 + NextRandom(random) % 1000;
+	}
+
+	return trace;
+}
+
+// first line "items <count>", then one vnum per line
+static bool ReadTrace(const std::string& path, DWORD& item_count, std::vector<DWORD>& trace)
+{
+	std::ifstream ifs(path);
+	std::string tag;
+	if (!(ifs >> tag >> item_count) || tag != "items")
+		return false;
+
+	DWORD vnum;
+	while (ifs >> vnum)
+		trace.push_back(vnum);
+
+	return ifs.eof() && !trace.empty();
+}
+
+static bool WriteTrace(const std::string& path, DWORD item_count, const std::vector<DWORD>& trace)
+{
+	std::ofstream ofs(path);
+	ofs << "items " << item_count << "\n";
+	for (DWORD vnum : trace)
+		ofs << vnum << "\n";
+
+	return ofs.good();
+}
+
+static bool CheckOverlappingSets(int set_count)
+{
+	uint64_t random = 1;
+	for (int set = 0; set < set_count; ++set) {
+		CHarnessItemSet item_set;
+		item_set.GenerateOverlapping(300, NextRandom, random);
+
+		for (DWORD vnum = 0; vnum < 2100; ++vnum) {
+			if (item_set.GetIndex().Find(vnum) != item_set.FindByScan(vnum)) {
+				std::cerr << "Set " << set << ": the index and the scan differ on vnum " << vnum << std::endl;
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+template <typename TFind>
+static double MeasureLookups(const std::vector<DWORD>& trace, int repeat, int runs, TFind find, uintptr_t& checksum)
+{
+	double best = 0.0;
+	for (int run = 0; run < runs; ++run) {
+		uintptr_t sum = 0;
+		auto start = std::chrono::steady_clock::now();
+
+		for (int r = 0; r < repeat; ++r) {
+			for (DWORD vnum : trace)
+				sum += (uintptr_t) find(vnum);
+		}
+
+		double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (trace.size() * (double) repeat);
+		if (run == 0 || ns < best)
+			best = ns;
+
+		checksum = sum;
+	}
+
+	return best;
+}
+
+int main(int argc, char* argv[])
+{
+	argparse::ArgumentParser program("ItemIndexReplay");
+
+	program.add_argument("--trace")
+		.default_value("")
+		.help("Lookup trace to replay (see lookup_trace.txt), a generated one if empty");
+
+	program.add_argument("--write-trace")
+		.default_value("")
+		.help("Write the replayed trace to this file");
+
+	program.add_argument("--items")
+		.default_value(20000)
+		.scan<'i', int>()
+		.help("Items of the generated trace");
+
+	program.add_argument("--lookups")
+		.default_value(10000)
+		.scan<'i', int>()
+		.help("Lookups in the generated trace");
+
+	program.add_argument("--seed")
+		.default_value(7)
+		.scan<'i', int>()
+		.help("Seed of the generated trace");
+
+	program.add_argument("--repeat")
+		.default_value(200)
+		.scan<'i', int>()
+		.help("Times the trace is replayed in one run");
+
+	program.add_argument("--runs")
+		.default_value(7)
+		.scan<'i', int>()
+		.help("Runs of each lookup, the best one counts");
+
+	try {
+		program.parse_args(argc, argv);
+	}
+	catch (const std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+		std::cerr << program;
+		std::exit(EXIT_FAILURE);
+	}
+
+	if (!CheckOverlappingSets(200))
+		return EXIT_FAILURE;
+
+	DWORD item_count = std::max(1, program.get<int>("--items"));
+	std::vector<DWORD> trace;
+	CHarnessItemSet item_set;
+
+	std::string trace_path = program.get<std::string>("--trace");
+	if (!trace_path.empty()) {
+		if (!ReadTrace(trace_path, item_count, trace)) {
+			std::cerr << "Failed to read trace: " << trace_path << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		item_set.Generate(item_count);
+	}
+	else {
+		item_set.Generate(item_count);
+		trace = GenerateTrace(item_set, std::max(1, program.get<int>("--lookups")), program.get<int>("--seed"));
+	}
+
+	std::string write_path = program.get<std::string>("--write-trace");
+	if (!write_path.empty() && !WriteTrace(write_path, item_count, trace)) {
+		std::cerr << "Failed to write trace: " << write_path << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	for (DWORD vnum : trace) {
+		if (item_set.GetIndex().Find(vnum) != item_set.FindByScan(vnum)) {
+			std::cerr << "The index and the scan differ on vnum " << vnum << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	int repeat = std::max(1, program.get<int>("--repeat"));
+	int runs = std::max(1, program.get<int>("--runs"));
+
+	uintptr_t scan_checksum = 0, index_checksum = 0;
+	double scan_ns = MeasureLookups(trace, repeat, runs, [&](DWORD vnum) { return item_set.FindByScan(vnum); }, scan_checksum);
+	double index_ns = MeasureLookups(trace, repeat, runs, [&](DWORD vnum) { return item_set.GetIndex().Find(vnum); }, index_checksum);
+
+	printf("%u items (%zu ranged), %zu lookups x %d, best of %d runs\n", item_count, item_set.GetRangedItems().size(), trace.size(), repeat, runs);
+	printf("map + range scan  %.1f ns/lookup\n", scan_ns);
+	printf("CItemIndex        %.1f ns/lookup\n", index_ns);
+
+	return scan_checksum == index_checksum ? EXIT_SUCCESS : EXIT_FAILURE;
+}
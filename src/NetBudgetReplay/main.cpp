@@ -0,0 +1,258 @@
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+#include <argparse.hpp>
+
+#include "EterLib/NetDispatchBudget.h"
+
+// Replays a packet stream through the dispatch loop of CPythonNetworkStream::GamePhase on a simulated clock,
+// once with the old fixed throttle and once with CNetworkDispatchBudget, and prints how long the packets
+// waited and how long the worst frame spent dispatching. Runs are deterministic, the same trace always
+// gives the same numbers.
+
+// a packet of the trace, written as is by --write-trace
+struct TTracePacket
+{
+	uint64_t arrive;	// us since the start of the trace
+	uint32_t size;		// bytes on the wire
+	uint32_t cost;		// us its handler takes
+};
+
+static ULONGLONG s_sim_usec = 0;
+
+// the budget's only clock, the handlers below advance it by their cost instead of doing work
+ULONGLONG ELTimer_GetUSec()
+{
+	return s_sim_usec;
+}
+
+// xorshift64*, std distributions differ between standard libraries and would change the trace
+class CTraceRandom
+{
+public:
+	explicit CTraceRandom(uint64_t seed) : m_state(seed ? seed : 1) {}
+
+	uint32_t Next()
+	{
+		m_state ^= m_state >> 12;
+		m_state ^= m_state << 25;
+		m_state ^= m_state >> 27;
+		return (uint32_t) ((m_state * 2685821657736338717ull) >> 32);
+	}
+
+	double NextUnit() { return (Next() + 0.5) / 4294967296.0; }
+
+private:
+	uint64_t m_state;
+};
+
+// steady movement traffic, and for 4 of every 10 seconds a siege burst of which every fourth packet is a
+// character add, big and slow to handle
+static std::vector<TTracePacket> GenerateSiegeTrace(uint32_t seconds, double burst_rate, uint64_t seed)
+{
+	constexpr double steady_rate = 150.0;
+
+	CTraceRandom random(seed);
+	std::vector<TTracePacket> trace;
+
+	double now = 0.0;
+	const double end = seconds * 1000000.0;
+	while (true) {
+		bool burst = uint64_t(now / 1000000.0) % 10 < 4;
+		now += -std::log(random.NextUnit()) * 1000000.0 / (burst ? burst_rate : steady_rate);
+		if (now >= end)
+			break;
+
+		bool add = burst && random.Next() % 4 == 0;
+		TTracePacket packet;
+		packet.arrive = (uint64_t) now;
+		packet.size = add ? 180 + random.Next() % 60 : 28 + random.Next() % 12;
+		packet.cost = add ? 120 + random.Next() % 200 : 15 + random.Next() % 40;
+		trace.push_back(packet);
+	}
+
+	return trace;
+}
+
+static bool ReadTrace(const std::string& path, std::vector<TTracePacket>& trace)
+{
+	std::ifstream ifs(path, std::ios::binary);
+	if (!ifs.is_open())
+		return false;
+
+	TTracePacket packet;
+	while (ifs.read((char*) &packet, sizeof(packet)))
+		trace.push_back(packet);
+
+	return !trace.empty();
+}
+
+static bool WriteTrace(const std::string& path, const std::vector<TTracePacket>& trace)
+{
+	std::ofstream ofs(path, std::ios::binary);
+	ofs.write((const char*) trace.data(), trace.size() * sizeof(TTracePacket));
+	return (bool) ofs;
+}
+
+struct TReplayState
+{
+	const std::vector<TTracePacket>& trace;
+	size_t head = 0;			// next packet to dispatch
+	size_t arrived = 0;			// packets received so far
+	DWORD buffered = 0;			// bytes of the received, undispatched ones
+	std::vector<double> latency;
+
+	void Dispatch()
+	{
+		const TTracePacket& packet = trace[head++];
+		s_sim_usec += packet.cost;
+		buffered -= packet.size;
+		latency.push_back(double(s_sim_usec - packet.arrive));
+	}
+};
+
+// the loop GamePhase ran before the budget: 4 packets a frame, more only while 8k or more are buffered
+static void DispatchFixed(CNetworkDispatchBudget&, TReplayState& state)
+{
+	constexpr DWORD max_recv_count = 4;
+	constexpr DWORD safe_recv_bufsize = 8192;
+
+	DWORD recv_count = 0;
+	while (state.head < state.arrived) {
+		if (recv_count++ >= max_recv_count - 1 && state.buffered < safe_recv_bufsize)
+			break;
+
+		state.Dispatch();
+	}
+}
+
+static void DispatchBudgeted(CNetworkDispatchBudget& budget, TReplayState& state)
+{
+	budget.BeginFrame(state.buffered);
+	while (state.head < state.arrived && budget.CanDispatch()) {
+		budget.OnDispatch();
+		state.Dispatch();
+	}
+	budget.EndFrame(state.buffered);
+}
+
+template <class TDispatch>
+static void Replay(const char* name, const std::vector<TTracePacket>& trace, DWORD base_usec, DWORD max_usec, TDispatch dispatch)
+{
+	// a 60 fps frame of which rendering takes 9 ms
+	constexpr ULONGLONG frame_usec = 16667;
+	constexpr ULONGLONG render_usec = 9000;
+
+	CNetworkDispatchBudget budget;
+	budget.SetBudget(base_usec, max_usec);
+
+	TReplayState state{ trace };
+	s_sim_usec = 0;
+
+	uint32_t frames = 0;
+	ULONGLONG worst_dispatch = 0;
+	while (state.head < trace.size()) {
+		ULONGLONG frame_begin = s_sim_usec;
+		for (; state.arrived < trace.size() && trace[state.arrived].arrive <= s_sim_usec; state.arrived++)
+			state.buffered += trace[state.arrived].size;
+
+		dispatch(budget, state);
+		worst_dispatch = std::max(worst_dispatch, s_sim_usec - frame_begin);
+
+		s_sim_usec = std::max(s_sim_usec + render_usec, frame_begin + frame_usec);
+		frames++;
+	}
+
+	std::vector<double>& latency = state.latency;
+	std::sort(latency.begin(), latency.end());
+
+	double sum = 0.0;
+	for (double usec : latency)
+		sum += usec;
+
+	printf("%-8s frames %6u  latency avg %7.1f ms p99 %7.1f ms max %7.1f ms  worst frame dispatch %5.1f ms", name, frames,
+		sum / latency.size() / 1000.0, latency[latency.size() * 99 / 100] / 1000.0, latency.back() / 1000.0, worst_dispatch / 1000.0);
+
+	const CNetworkDispatchBudget::TStat& stat = budget.GetStat();
+	if (stat.dwFrameCount)
+		printf("  cut %u max backlog %u max behind %u ms", stat.dwCutFrameCount, stat.dwMaxBacklogSize, stat.dwMaxLatency);
+
+	printf("\n");
+}
+
+int main(int argc, char* argv[])
+{
+	argparse::ArgumentParser program("NetBudgetReplay");
+
+	program.add_argument("--trace")
+		.default_value("")
+		.help("Packet trace to replay (arrival us, size, handler us as uint64/uint32/uint32 records), a generated siege if empty");
+
+	program.add_argument("--write-trace")
+		.default_value("")
+		.help("Write the replayed trace to this file");
+
+	program.add_argument("--seconds")
+		.default_value(60)
+		.scan<'i', int>()
+		.help("Length of the generated trace");
+
+	program.add_argument("--burst-rate")
+		.default_value(2000)
+		.scan<'i', int>()
+		.help("Packets per second during the bursts of the generated trace");
+
+	program.add_argument("--seed")
+		.default_value(7)
+		.scan<'i', int>()
+		.help("Seed of the generated trace");
+
+	program.add_argument("--base-usec")
+		.default_value((int) CNetworkDispatchBudget::DEFAULT_BASE_USEC)
+		.scan<'i', int>()
+		.help("Dispatch budget of a frame without backlog");
+
+	program.add_argument("--max-usec")
+		.default_value((int) CNetworkDispatchBudget::DEFAULT_MAX_USEC)
+		.scan<'i', int>()
+		.help("Dispatch budget of a frame that is catching up");
+
+	try {
+		program.parse_args(argc, argv);
+	}
+	catch (const std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+		std::cerr << program;
+		std::exit(EXIT_FAILURE);
+	}
+
+	std::vector<TTracePacket> trace;
+	std::string trace_path = program.get<std::string>("--trace");
+	if (!trace_path.empty()) {
+		if (!ReadTrace(trace_path, trace)) {
+			std::cerr << "Failed to read trace: " << trace_path << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	else {
+		trace = GenerateSiegeTrace(program.get<int>("--seconds"), program.get<int>("--burst-rate"), program.get<int>("--seed"));
+	}
+
+	std::string write_path = program.get<std::string>("--write-trace");
+	if (!write_path.empty() && !WriteTrace(write_path, trace)) {
+		std::cerr << "Failed to write trace: " << write_path << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cout << "Replaying " << trace.size() << " packets" << std::endl;
+
+	DWORD base_usec = program.get<int>("--base-usec"), max_usec = program.get<int>("--max-usec");
+	Replay("fixed", trace, base_usec, max_usec, DispatchFixed);
+	Replay("budget", trace, base_usec, max_usec, DispatchBudgeted);
+	return EXIT_SUCCESS;
+}
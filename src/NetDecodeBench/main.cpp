@@ -0,0 +1,372 @@
+#include "UserInterface/StdAfx.h"
+#include "UserInterface/Packet.h"
+#include "EterLib/NetPacketHeaderMap.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+#include <argparse.hpp>
+
+// Decodes one generated stream of server packets the way CPythonNetworkStream::CheckPacket and GamePhase do,
+// once with the old CNetworkPacketHeaderMap lookup and switch dispatch and once with a 256 entry table built
+// at compile time, and prints the best ns per packet of each. Headers and sizes come from Packet.h, the
+// handlers do next to nothing, so only the lookup and the dispatch are measured.
+
+// every header of CPythonNetworkStream::__BuildPacketDescTable, with its packet and whether its size is dynamic
+#define NET_DECODE_BENCH_PACKETS(X) \
+	X(HEADER_GC_EMPIRE, TPacketGCEmpire, false) \
+	X(HEADER_GC_WARP, TPacketGCWarp, false) \
+	X(HEADER_GC_SKILL_COOLTIME_END, TPacketGCSkillCoolTimeEnd, false) \
+	X(HEADER_GC_QUEST_INFO, TPacketGCQuestInfo, true) \
+	X(HEADER_GC_REQUEST_MAKE_GUILD, TPacketGCBlank, false) \
+	X(HEADER_GC_PVP, TPacketGCPVP, false) \
+	X(HEADER_GC_DUEL_START, TPacketGCDuelStart, true) \
+	X(HEADER_GC_CHARACTER_ADD, TPacketGCCharacterAdd, false) \
+	X(HEADER_GC_CHAR_ADDITIONAL_INFO, TPacketGCCharacterAdditionalInfo, false) \
+	X(HEADER_GC_CHARACTER_ADD2, TPacketGCCharacterAdd2, false) \
+	X(HEADER_GC_CHARACTER_UPDATE, TPacketGCCharacterUpdate, false) \
+	X(HEADER_GC_CHARACTER_UPDATE2, TPacketGCCharacterUpdate2, false) \
+	X(HEADER_GC_CHARACTER_DEL, TPacketGCCharacterDelete, false) \
+	X(HEADER_GC_CHARACTER_MOVE, TPacketGCMove, false) \
+	X(HEADER_GC_CHAT, TPacketGCChat, true) \
+	X(HEADER_GC_SYNC_POSITION, TPacketGCC2C, true) \
+	X(HEADER_GC_LOGIN_SUCCESS3, TPacketGCLoginSuccess3, false) \
+	X(HEADER_GC_LOGIN_SUCCESS4, TPacketGCLoginSuccess4, false) \
+	X(HEADER_GC_LOGIN_FAILURE, TPacketGCLoginFailure, false) \
+	X(HEADER_GC_PLAYER_CREATE_SUCCESS, TPacketGCPlayerCreateSuccess, false) \
+	X(HEADER_GC_PLAYER_CREATE_FAILURE, TPacketGCCreateFailure, false) \
+	X(HEADER_GC_PLAYER_DELETE_SUCCESS, TPacketGCBlank, false) \
+	X(HEADER_GC_PLAYER_DELETE_WRONG_SOCIAL_ID, TPacketGCBlank, false) \
+	X(HEADER_GC_STUN, TPacketGCStun, false) \
+	X(HEADER_GC_DEAD, TPacketGCDead, false) \
+	X(HEADER_GC_MAIN_CHARACTER, TPacketGCMainCharacter, false) \
+	X(HEADER_GC_MAIN_CHARACTER2_EMPIRE, TPacketGCMainCharacter2_EMPIRE, false) \
+	X(HEADER_GC_MAIN_CHARACTER3_BGM, TPacketGCMainCharacter3_BGM, false) \
+	X(HEADER_GC_MAIN_CHARACTER4_BGM_VOL, TPacketGCMainCharacter4_BGM_VOL, false) \
+	X(HEADER_GC_PLAYER_POINTS, TPacketGCPoints, false) \
+	X(HEADER_GC_PLAYER_POINT_CHANGE, TPacketGCPointChange, false) \
+	X(HEADER_GC_ITEM_DEL, TPacketGCItemDel, false) \
+	X(HEADER_GC_ITEM_SET, TPacketGCItemSet, false) \
+	X(HEADER_GC_ITEM_USE, TPacketGCItemUse, false) \
+	X(HEADER_GC_ITEM_UPDATE, TPacketGCItemUpdate, false) \
+	X(HEADER_GC_ITEM_GROUND_ADD, TPacketGCItemGroundAdd, false) \
+	X(HEADER_GC_ITEM_GROUND_DEL, TPacketGCItemGroundDel, false) \
+	X(HEADER_GC_ITEM_OWNERSHIP, TPacketGCItemOwnership, false) \
+	X(HEADER_GC_QUICKSLOT_ADD, TPacketGCQuickSlotAdd, false) \
+	X(HEADER_GC_QUICKSLOT_DEL, TPacketGCQuickSlotDel, false) \
+	X(HEADER_GC_QUICKSLOT_SWAP, TPacketGCQuickSlotSwap, false) \
+	X(HEADER_GC_WHISPER, TPacketGCWhisper, false) \
+	X(HEADER_GC_CHARACTER_POSITION, TPacketGCPosition, false) \
+	X(HEADER_GC_MOTION, TPacketGCMotion, false) \
+	X(HEADER_GC_SHOP, TPacketGCShop, true) \
+	X(HEADER_GC_SHOP_SIGN, TPacketGCShopSign, false) \
+	X(HEADER_GC_EXCHANGE, TPacketGCExchange, false) \
+	X(HEADER_GC_PING, TPacketGCPing, false) \
+	X(HEADER_GC_SCRIPT, TPacketGCScript, true) \
+	X(HEADER_GC_QUEST_CONFIRM, TPacketGCQuestConfirm, false) \
+	X(HEADER_GC_TARGET, TPacketGCTarget, false) \
+	X(HEADER_GC_MOUNT, TPacketGCMount, false) \
+	X(HEADER_GC_CHANGE_SPEED, TPacketGCChangeSpeed, false) \
+	X(HEADER_GC_HANDSHAKE, TPacketGCHandshake, false) \
+	X(HEADER_GC_HANDSHAKE_OK, TPacketGCBlank, false) \
+	X(HEADER_GC_BINDUDP, TPacketGCBindUDP, false) \
+	X(HEADER_GC_OWNERSHIP, TPacketGCOwnership, false) \
+	X(HEADER_GC_CREATE_FLY, TPacketGCCreateFly, false) \
+	X(HEADER_GC_KEY_AGREEMENT, TPacketKeyAgreement, false) \
+	X(HEADER_GC_KEY_AGREEMENT_COMPLETED, TPacketKeyAgreementCompleted, false) \
+	X(HEADER_GC_ADD_FLY_TARGETING, TPacketGCFlyTargeting, false) \
+	X(HEADER_GC_FLY_TARGETING, TPacketGCFlyTargeting, false) \
+	X(HEADER_GC_PHASE, TPacketGCPhase, false) \
+	X(HEADER_GC_SKILL_LEVEL, TPacketGCSkillLevel, false) \
+	X(HEADER_GC_SKILL_LEVEL_NEW, TPacketGCSkillLevelNew, false) \
+	X(HEADER_GC_MESSENGER, TPacketGCMessenger, true) \
+	X(HEADER_GC_GUILD, TPacketGCGuild, true) \
+	X(HEADER_GC_PARTY_INVITE, TPacketGCPartyInvite, false) \
+	X(HEADER_GC_PARTY_ADD, TPacketGCPartyAdd, false) \
+	X(HEADER_GC_PARTY_UPDATE, TPacketGCPartyUpdate, false) \
+	X(HEADER_GC_PARTY_REMOVE, TPacketGCPartyRemove, false) \
+	X(HEADER_GC_PARTY_LINK, TPacketGCPartyLink, false) \
+	X(HEADER_GC_PARTY_UNLINK, TPacketGCPartyUnlink, false) \
+	X(HEADER_GC_PARTY_PARAMETER, TPacketGCPartyParameter, false) \
+	X(HEADER_GC_SAFEBOX_SET, TPacketGCItemSet, false) \
+	X(HEADER_GC_SAFEBOX_DEL, TPacketGCItemDel, false) \
+	X(HEADER_GC_SAFEBOX_WRONG_PASSWORD, TPacketGCSafeboxWrongPassword, false) \
+	X(HEADER_GC_SAFEBOX_SIZE, TPacketGCSafeboxSize, false) \
+	X(HEADER_GC_SAFEBOX_MONEY_CHANGE, TPacketGCSafeboxMoneyChange, false) \
+	X(HEADER_GC_FISHING, TPacketGCFishing, false) \
+	X(HEADER_GC_DUNGEON, TPacketGCDungeon, true) \
+	X(HEADER_GC_TIME, TPacketGCTime, false) \
+	X(HEADER_GC_WALK_MODE, TPacketGCWalkMode, false) \
+	X(HEADER_GC_CHANGE_SKILL_GROUP, TPacketGCChangeSkillGroup, false) \
+	X(HEADER_GC_REFINE_INFORMATION, TPacketGCRefineInformation, false) \
+	X(HEADER_GC_REFINE_INFORMATION_NEW, TPacketGCRefineInformationNew, false) \
+	X(HEADER_GC_SEPCIAL_EFFECT, TPacketGCSpecialEffect, false) \
+	X(HEADER_GC_NPC_POSITION, TPacketGCNPCPosition, true) \
+	X(HEADER_GC_CHANGE_NAME, TPacketGCChangeName, false) \
+	X(HEADER_GC_CHINA_MATRIX_CARD, TPacketGCChinaMatrixCard, false) \
+	X(HEADER_GC_RUNUP_MATRIX_QUIZ, TPacketGCRunupMatrixQuiz, false) \
+	X(HEADER_GC_LOGIN_KEY, TPacketGCLoginKey, false) \
+	X(HEADER_GC_AUTH_SUCCESS, TPacketGCAuthSuccess, false) \
+	X(HEADER_GC_CHANNEL, TPacketGCChannel, false) \
+	X(HEADER_GC_VIEW_EQUIP, TPacketGCViewEquip, false) \
+	X(HEADER_GC_LAND_LIST, TPacketGCLandList, true) \
+	X(HEADER_GC_TARGET_UPDATE, TPacketGCTargetUpdate, false) \
+	X(HEADER_GC_TARGET_DELETE, TPacketGCTargetDelete, false) \
+	X(HEADER_GC_TARGET_CREATE_NEW, TPacketGCTargetCreateNew, false) \
+	X(HEADER_GC_AFFECT_ADD, TPacketGCAffectAdd, false) \
+	X(HEADER_GC_AFFECT_REMOVE, TPacketGCAffectRemove, false) \
+	X(HEADER_GC_MALL_OPEN, TPacketGCMallOpen, false) \
+	X(HEADER_GC_MALL_SET, TPacketGCItemSet, false) \
+	X(HEADER_GC_MALL_DEL, TPacketGCItemDel, false) \
+	X(HEADER_GC_LOVER_INFO, TPacketGCLoverInfo, false) \
+	X(HEADER_GC_LOVE_POINT_UPDATE, TPacketGCLovePointUpdate, false) \
+	X(HEADER_GC_DIG_MOTION, TPacketGCDigMotion, false) \
+	X(HEADER_GC_DAMAGE_INFO, TPacketGCDamageInfo, false) \
+	X(HEADER_GC_HYBRIDCRYPT_KEYS, TPacketGCHybridCryptKeys, true) \
+	X(HEADER_GC_HYBRIDCRYPT_SDB, TPacketGCHybridSDB, true) \
+	X(HEADER_GC_SPECIFIC_EFFECT, TPacketGCSpecificEffect, false) \
+	X(HEADER_GC_DRAGON_SOUL_REFINE, TPacketGCDragonSoulRefine, false) \
+
+static volatile uint32_t s_uSink = 0;
+
+template <TPacketHeader header>
+static bool RecvPacket(const uint8_t * c_pbPacket)
+{
+	s_uSink = s_uSink + c_pbPacket[0] + header;
+	return true;
+}
+
+// the map and switch pair the client used before the table
+class COldPacketDecoder
+{
+public:
+	COldPacketDecoder()
+	{
+#define NET_DECODE_BENCH_SET(header, TPacket, isDynamicSize) m_kHeaderMap.Set(header, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacket), isDynamicSize));
+		NET_DECODE_BENCH_PACKETS(NET_DECODE_BENCH_SET)
+#undef NET_DECODE_BENCH_SET
+	}
+
+	size_t Decode(const uint8_t * c_pbPacket)
+	{
+		CNetworkPacketHeaderMap::TPacketType kType;
+		if (!m_kHeaderMap.Get(c_pbPacket[0], &kType))
+			return 0;
+
+		size_t size = kType.iPacketSize;
+		if (kType.isDynamicSizePacket)
+			size = reinterpret_cast<const TDynamicSizePacketHeader *>(c_pbPacket)->size;
+
+		switch (c_pbPacket[0])
+		{
+#define NET_DECODE_BENCH_CASE(header, TPacket, isDynamicSize) case header: RecvPacket<header>(c_pbPacket); break;
+			NET_DECODE_BENCH_PACKETS(NET_DECODE_BENCH_CASE)
+#undef NET_DECODE_BENCH_CASE
+		}
+
+		return size;
+	}
+
+private:
+	CNetworkPacketHeaderMap m_kHeaderMap;
+};
+
+struct TTablePacketDesc
+{
+	uint16_t wSize;
+	bool isDynamicSize;
+	bool (*pfnRecv)(const uint8_t *);
+};
+
+static constexpr std::array<TTablePacketDesc, 256> BuildPacketDescTable()
+{
+	std::array<TTablePacketDesc, 256> table{};
+#define NET_DECODE_BENCH_DESC(header, TPacket, isDynamicSize) table[header] = { (uint16_t) sizeof(TPacket), isDynamicSize, &RecvPacket<header> };
+	NET_DECODE_BENCH_PACKETS(NET_DECODE_BENCH_DESC)
+#undef NET_DECODE_BENCH_DESC
+	return table;
+}
+
+// the same lookup as CPythonNetworkStream::ms_kArr_kPacketDesc
+class CTablePacketDecoder
+{
+public:
+	size_t Decode(const uint8_t * c_pbPacket) const
+	{
+		const TTablePacketDesc & c_rkDesc = ms_kArr_kPacketDesc[c_pbPacket[0]];
+		if (!c_rkDesc.wSize)
+			return 0;
+
+		size_t size = c_rkDesc.wSize;
+		if (c_rkDesc.isDynamicSize)
+			size = reinterpret_cast<const TDynamicSizePacketHeader *>(c_pbPacket)->size;
+
+		c_rkDesc.pfnRecv(c_pbPacket);
+		return size;
+	}
+
+private:
+	static constexpr std::array<TTablePacketDesc, 256> ms_kArr_kPacketDesc = BuildPacketDescTable();
+};
+
+// xorshift64*, std distributions differ between standard libraries and would change the stream
+class CStreamRandom
+{
+public:
+	explicit CStreamRandom(uint64_t seed) : m_state(seed ? seed : 1) {}
+
+	uint32_t Next()
+	{
+		m_state ^= m_state >> 12;
+		m_state ^= m_state << 25;
+		m_state ^= m_state >> 27;
+		return (uint32_t) ((m_state * 2685821657736338717ull) >> 32);
+	}
+
+private:
+	uint64_t m_state;
+};
+
+struct TStreamPacket
+{
+	TPacketHeader header;
+	uint16_t size;
+	bool isDynamicSize;
+};
+
+// 80% character traffic (move, update, add, delete), the rest spread over every other header. Dynamic size
+// packets carry up to 64 bytes past their fixed part, the way chat and quest packets do.
+static std::vector<uint8_t> GenerateStream(size_t count, uint64_t seed)
+{
+	static const TStreamPacket c_akPacket[] =
+	{
+#define NET_DECODE_BENCH_PACKET(header, TPacket, isDynamicSize) { header, (uint16_t) sizeof(TPacket), isDynamicSize },
+		NET_DECODE_BENCH_PACKETS(NET_DECODE_BENCH_PACKET)
+#undef NET_DECODE_BENCH_PACKET
+	};
+
+	static const TPacketHeader c_abyCharacterHeader[] =
+	{
+		HEADER_GC_CHARACTER_MOVE, HEADER_GC_CHARACTER_MOVE, HEADER_GC_CHARACTER_MOVE, HEADER_GC_CHARACTER_MOVE,
+		HEADER_GC_CHARACTER_UPDATE2, HEADER_GC_CHARACTER_UPDATE2,
+		HEADER_GC_CHARACTER_ADD, HEADER_GC_CHAR_ADDITIONAL_INFO,
+		HEADER_GC_CHARACTER_DEL, HEADER_GC_CHARACTER_POSITION,
+	};
+
+	CStreamRandom random(seed);
+	std::vector<uint8_t> stream;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const TStreamPacket * c_pkPacket;
+		if (random.Next() % 10 < 8)
+		{
+			TPacketHeader header = c_abyCharacterHeader[random.Next() % std::size(c_abyCharacterHeader)];
+			c_pkPacket = std::find_if(std::begin(c_akPacket), std::end(c_akPacket), [header](const TStreamPacket & c_rkPacket) { return c_rkPacket.header == header; });
+		}
+		else
+		{
+			c_pkPacket = &c_akPacket[random.Next() % std::size(c_akPacket)];
+		}
+
+		size_t size = c_pkPacket->size;
+		if (c_pkPacket->isDynamicSize)
+			size += random.Next() % 64;
+
+		size_t offset = stream.size();
+		stream.resize(offset + size);
+		stream[offset] = c_pkPacket->header;
+
+		if (c_pkPacket->isDynamicSize)
+		{
+			uint16_t wSize = (uint16_t) size;
+			memcpy(&stream[offset + offsetof(TDynamicSizePacketHeader, size)], &wSize, sizeof(wSize));
+		}
+	}
+
+	return stream;
+}
+
+template <typename TDecoder>
+static double MeasureDecode(TDecoder & rkDecoder, const std::vector<uint8_t> & c_rvecStream, size_t count, int runs)
+{
+	double best = 0.0;
+
+	for (int run = 0; run < runs; ++run)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		size_t offset = 0, decoded = 0;
+		while (offset < c_rvecStream.size())
+		{
+			size_t size = rkDecoder.Decode(&c_rvecStream[offset]);
+			if (!size)
+				break;
+
+			offset += size;
+			++decoded;
+		}
+
+		double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+		if (decoded != count)
+		{
+			std::cerr << "Decoded " << decoded << " of " << count << " packets" << std::endl;
+			return -1.0;
+		}
+
+		if (run == 0 || ns < best)
+			best = ns;
+	}
+
+	return best;
+}
+
+int main(int argc, char* argv[])
+{
+	argparse::ArgumentParser program("NetDecodeBench");
+
+	program.add_argument("--packets")
+		.default_value(2000000)
+		.scan<'i', int>()
+		.help("Packets in the decoded stream");
+
+	program.add_argument("--runs")
+		.default_value(7)
+		.scan<'i', int>()
+		.help("Times each decoder goes over the stream, the best run counts");
+
+	program.add_argument("--seed")
+		.default_value(1)
+		.scan<'i', int>()
+		.help("Seed of the stream, the same seed always gives the same packets");
+
+	try {
+		program.parse_args(argc, argv);
+	}
+	catch (const std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+		std::cerr << program;
+		std::exit(EXIT_FAILURE);
+	}
+
+	size_t count = std::max(1, program.get<int>("--packets"));
+	int runs = std::max(1, program.get<int>("--runs"));
+	std::vector<uint8_t> stream = GenerateStream(count, program.get<int>("--seed"));
+
+	COldPacketDecoder old_decoder;
+	CTablePacketDecoder table_decoder;
+
+	double old_ns = MeasureDecode(old_decoder, stream, count, runs);
+	double table_ns = MeasureDecode(table_decoder, stream, count, runs);
+	if (old_ns < 0.0 || table_ns < 0.0)
+		return EXIT_FAILURE;
+
+	printf("%zu packets, %zu bytes, best of %d runs\n", count, stream.size(), runs);
+	printf("std::map + switch  %.1f ns/packet\n", old_ns);
+	printf("table              %.1f ns/packet\n", table_ns);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,481 @@
+// the client's own headers first, they decide the layout of CNetworkStream (Locale_inc.h)
+#include "EterLib/StdAfx.h"
+#include "EterLib/NetStream.h"
+#include "EterLib/NetReactor.h"
+
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <argparse.hpp>
+
+// Runs CNetworkStream against a loopback echo server, once with every stream polling its own socket and
+// once through CNetworkReactor, and checks that every message comes back whole and in order. A second
+// check closes a stream after the frame's poll and opens another one, which may get the same socket
+// handle, the reactor must not hand it the events of the closed one.
+// With --throughput-mb it measures instead how fast a stream takes game-like packets off a loopback socket.
+
+static std::atomic<bool> s_stop_server = false;
+
+// one thread, one poll over the listening socket and all accepted ones, echoes whatever arrives
+static void EchoServer(SOCKET listen_sock)
+{
+	std::vector<WSAPOLLFD> fds(1);
+	fds[0].fd = listen_sock;
+	fds[0].events = POLLRDNORM;
+
+	std::vector<char> buffer(64 * 1024);
+	while (!s_stop_server) {
+		for (WSAPOLLFD& fd : fds)
+			fd.revents = 0;
+
+		if (WSAPoll(fds.data(), (ULONG) fds.size(), 1) <= 0)
+			continue;
+
+		if (fds[0].revents & POLLRDNORM) {
+			SOCKET sock = accept(listen_sock, NULL, NULL);
+			if (sock != INVALID_SOCKET) {
+				int no_delay = 1;
+				setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char*) &no_delay, sizeof(no_delay));
+
+				WSAPOLLFD fd;
+				fd.fd = sock;
+				fd.events = POLLRDNORM;
+				fd.revents = 0;
+				fds.push_back(fd);
+			}
+		}
+
+		for (size_t i = 1; i < fds.size(); ++i) {
+			if (!(fds[i].revents & (POLLRDNORM | POLLHUP | POLLERR)))
+				continue;
+
+			int received = recv(fds[i].fd, buffer.data(), (int) buffer.size(), 0);
+			if (received <= 0) {
+				closesocket(fds[i].fd);
+				fds.erase(fds.begin() + i--);
+				continue;
+			}
+
+			// the client only ever has a few messages in flight, a blocking send never waits long
+			for (int sent = 0; sent < received;) {
+				int n = send(fds[i].fd, buffer.data() + sent, received - sent, 0);
+				if (n > 0)
+					sent += n;
+			}
+		}
+	}
+
+	for (size_t i = 1; i < fds.size(); ++i)
+		closesocket(fds[i].fd);
+}
+
+// messages are a length byte of 1..40 and that many payload bytes
+class CEchoStream : public CNetworkStream
+{
+	public:
+		void QueueMessage()
+		{
+			int length = 1 + rand() % 40;
+			std::string message(1, (char) length);
+			for (int i = 0; i < length; ++i)
+				message += (char) ('a' + m_uSequence++ % 26);
+
+			if (Send((int) message.size(), message.data()))
+				m_kDeq_kSent.push_back({ message, std::chrono::steady_clock::now() });
+		}
+
+		bool IsConnected() const			{ return m_isConnected; }
+		size_t GetInFlightCount() const		{ return m_kDeq_kSent.size(); }
+		long long GetEchoedCount() const	{ return m_llEchoed; }
+		long long GetBrokenCount() const	{ return m_llBroken; }
+		double GetRoundTripSum() const		{ return m_dRoundTripSum; }
+
+	protected:
+		void OnConnectSuccess() override
+		{
+			m_isConnected = true;
+		}
+
+		void OnConnectFailure() override
+		{
+			++m_llBroken;
+		}
+
+		void OnRemoteDisconnect() override
+		{
+			m_isConnected = false;
+			++m_llBroken;
+		}
+
+		bool OnProcess() override
+		{
+			while (true) {
+				unsigned char length;
+				if (!Peek(1, (char*) &length) || !Peek(1 + length))
+					return true;
+
+				std::string message(1 + length, 0);
+				Recv(1 + length, &message[0]);
+
+				if (m_kDeq_kSent.empty() || m_kDeq_kSent.front().first != message) {
+					++m_llBroken;
+					continue;
+				}
+
+				m_dRoundTripSum += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_kDeq_kSent.front().second).count();
+				m_kDeq_kSent.pop_front();
+				++m_llEchoed;
+			}
+		}
+
+	protected:
+		std::deque<std::pair<std::string, std::chrono::steady_clock::time_point>> m_kDeq_kSent;
+		unsigned m_uSequence = 0;
+		bool m_isConnected = false;
+		long long m_llEchoed = 0;
+		long long m_llBroken = 0;
+		double m_dRoundTripSum = 0.0;
+};
+
+// frames laid out as CPythonApplication::Process does: poll, process, queue the frame's packets, flush
+static bool RunEchoTest(bool use_reactor, int port, int stream_count, int frame_count)
+{
+	std::unique_ptr<CNetworkReactor> reactor(use_reactor ? new CNetworkReactor : NULL);
+
+	std::vector<std::unique_ptr<CEchoStream>> streams;
+	for (int i = 0; i < stream_count; ++i) {
+		streams.emplace_back(new CEchoStream);
+		streams.back()->SetSendBufferSize(1024);
+		streams.back()->SetRecvBufferSize(1024);
+		streams.back()->Connect("127.0.0.1", port);
+	}
+
+	srand(7);
+	for (int frame = 0; frame < frame_count; ++frame) {
+		if (reactor)
+			reactor->Poll();
+
+		for (auto& stream : streams)
+			stream->Process();
+
+		for (auto& stream : streams) {
+			if (stream->IsConnected() && stream->GetInFlightCount() < 4)
+				stream->QueueMessage();
+		}
+
+		if (reactor)
+			reactor->Flush();
+
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+	}
+
+	long long echoed = 0, broken = 0;
+	double round_trip = 0.0;
+	for (auto& stream : streams) {
+		echoed += stream->GetEchoedCount();
+		broken += stream->GetBrokenCount();
+		round_trip += stream->GetRoundTripSum();
+	}
+
+	printf("%-10s echoed %lld broken %lld, %.0f us round trip\n", use_reactor ? "reactor" : "per-stream", echoed, broken, echoed ? round_trip / echoed : 0.0);
+
+	if (reactor) {
+		const CNetworkReactor::TStat& stat = reactor->GetStat();
+		printf("           reactor polls %u, self polls %u, at most %u per frame\n", stat.dwPollCount, stat.dwSelfPollCount, stat.dwMaxFramePollCount);
+	}
+
+	streams.clear();
+
+	if (reactor && reactor->GetStat().dwStreamCount != 0) {
+		printf("           %u streams still registered after closing all of them\n", reactor->GetStat().dwStreamCount);
+		return false;
+	}
+
+	return echoed > 0 && broken == 0;
+}
+
+// a stream closed between the poll and its processing leaves its events behind, a socket opened right
+// after may get the same handle and must not pick them up
+static bool RunHandleReuseTest(int port)
+{
+	CNetworkReactor reactor;
+
+	CEchoStream first;
+	first.Connect("127.0.0.1", port);
+
+	for (int frame = 0; frame < 1000 && !first.IsConnected(); ++frame) {
+		reactor.Poll();
+		first.Process();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	if (!first.IsConnected()) {
+		printf("handle reuse: no connection\n");
+		return false;
+	}
+
+	reactor.Poll();
+
+	SOCKET closed_sock = first.GetSocket();
+	first.Clear();
+
+	CEchoStream second;
+	if (!second.Connect("127.0.0.1", port) || second.GetSocket() == INVALID_SOCKET) {
+		printf("handle reuse: no second socket\n");
+		return false;
+	}
+
+	short events = 0;
+	bool stale = reactor.PopEvents(second.GetSocket(), &events);
+
+	printf("handle reuse: %s handle, %s\n", second.GetSocket() == closed_sock ? "same" : "new",
+		stale ? "got the closed socket's events" : "no stale events");
+	return !stale;
+}
+
+// packets of a 2 byte size and payload, mostly small moves with the odd big character add in between
+static void MakePacketPattern(std::vector<char>& pattern)
+{
+	srand(1);
+	while (pattern.size() < 1024 * 1024) {
+		WORD size = (rand() % 4 == 0) ? 200 + rand() % 1200 : 8 + rand() % 40;
+		size_t offset = pattern.size();
+		pattern.resize(offset + size, (char) size);
+		memcpy(&pattern[offset], &size, sizeof(size));
+	}
+}
+
+static std::atomic<bool> s_throughput_done = false;
+
+// sends the pattern over and over at full speed, and keeps the socket open until the stream has read it all
+static void PacketSender(SOCKET listen_sock, const std::vector<char>& pattern, long long repeat)
+{
+	SOCKET sock = accept(listen_sock, NULL, NULL);
+	if (sock == INVALID_SOCKET)
+		return;
+
+	for (long long i = 0; i < repeat; ++i) {
+		for (size_t sent = 0; sent < pattern.size();) {
+			int n = send(sock, pattern.data() + sent, (int) (pattern.size() - sent), 0);
+			if (n <= 0) {
+				closesocket(sock);
+				return;
+			}
+
+			sent += n;
+		}
+	}
+
+	while (!s_throughput_done)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	closesocket(sock);
+}
+
+// takes whole packets off the stream, at most a frame's worth of bytes per Process as GamePhase does
+class CPacketSinkStream : public CNetworkStream
+{
+	public:
+		CPacketSinkStream(int iFrameBytes) : m_iFrameBytes(iFrameBytes)
+		{
+		}
+
+		long long GetReadBytes() const	{ return m_llReadBytes; }
+		bool IsBroken() const			{ return m_isBroken; }
+
+	protected:
+		void OnConnectFailure() override
+		{
+			m_isBroken = true;
+		}
+
+		void OnRemoteDisconnect() override
+		{
+			m_isBroken = true;
+		}
+
+		bool OnProcess() override
+		{
+			char packet[2048];
+
+			for (int iBudget = m_iFrameBytes; iBudget > 0;) {
+				WORD size;
+				if (!Peek(sizeof(size), (char*) &size) || !Peek(size))
+					return true;
+
+				if (size < sizeof(size) || size > sizeof(packet)) {
+					m_isBroken = true;
+					return false;
+				}
+
+				Recv(size, packet);
+				if (packet[size - 1] != (char) size) {
+					m_isBroken = true;
+					return false;
+				}
+
+				m_llReadBytes += size;
+				iBudget -= size;
+			}
+
+			return true;
+		}
+
+	protected:
+		int m_iFrameBytes;
+		long long m_llReadBytes = 0;
+		bool m_isBroken = false;
+};
+
+// user plus kernel time, in ms
+static double GetCpuMs(const FILETIME& kernel_time, const FILETIME& user_time)
+{
+	ULARGE_INTEGER kernel, user;
+	kernel.LowPart = kernel_time.dwLowDateTime;
+	kernel.HighPart = kernel_time.dwHighDateTime;
+	user.LowPart = user_time.dwLowDateTime;
+	user.HighPart = user_time.dwHighDateTime;
+	return (kernel.QuadPart + user.QuadPart) / 10000.0;
+}
+
+// the receiving thread alone, and the whole process, which includes the sender
+static void GetCpuTimes(double& thread_ms, double& process_ms)
+{
+	FILETIME creation_time, exit_time, kernel_time, user_time;
+
+	GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time);
+	thread_ms = GetCpuMs(kernel_time, user_time);
+
+	GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time);
+	process_ms = GetCpuMs(kernel_time, user_time);
+}
+
+static bool RunThroughputBench(SOCKET listen_sock, int port, int megabytes, int frame_kb)
+{
+	std::vector<char> pattern;
+	MakePacketPattern(pattern);
+
+	long long repeat = std::max(1LL, ((long long) megabytes << 20) / (long long) pattern.size());
+	long long total = repeat * pattern.size();
+
+	std::thread sender(PacketSender, listen_sock, std::cref(pattern), repeat);
+
+	CPacketSinkStream stream(frame_kb * 1024);
+	stream.SetRecvBufferSize(128 * 1024);
+	stream.Connect("127.0.0.1", port);
+
+	double thread_start_ms, process_start_ms;
+	GetCpuTimes(thread_start_ms, process_start_ms);
+	auto start = std::chrono::steady_clock::now();
+
+	long long frames = 0;
+	while (stream.GetReadBytes() < total && !stream.IsBroken()) {
+		stream.Process();
+		++frames;
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	double thread_end_ms, process_end_ms;
+	GetCpuTimes(thread_end_ms, process_end_ms);
+
+	s_throughput_done = true;
+	sender.join();
+
+	printf("read %lld of %lld bytes in %.2f s, %.0f MB/s, %lld frames of up to %d KB\n", stream.GetReadBytes(), total, seconds,
+		stream.GetReadBytes() / 1048576.0 / seconds, frames, frame_kb);
+
+	double megabytes_read = std::max(stream.GetReadBytes(), 1LL) / 1048576.0;
+	printf("cpu %.3f ms/MB on the receiving thread, %.3f ms/MB in the process\n", (thread_end_ms - thread_start_ms) / megabytes_read,
+		(process_end_ms - process_start_ms) / megabytes_read);
+	return stream.GetReadBytes() == total;
+}
+
+int main(int argc, char* argv[])
+{
+	argparse::ArgumentParser program("NetStreamTest");
+
+	program.add_argument("--streams")
+		.default_value(5)
+		.scan<'i', int>()
+		.help("Connections open at the same time");
+
+	program.add_argument("--frames")
+		.default_value(20000)
+		.scan<'i', int>()
+		.help("Frames each echo run lasts");
+
+	program.add_argument("--throughput-mb")
+		.default_value(0)
+		.scan<'i', int>()
+		.help("Instead of the echo tests, measure reading this many MB of packets off the loopback");
+
+	program.add_argument("--frame-kb")
+		.default_value(16)
+		.scan<'i', int>()
+		.help("Bytes of packets the throughput run takes per frame");
+
+	try {
+		program.parse_args(argc, argv);
+	}
+	catch (const std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+		std::cerr << program;
+		std::exit(EXIT_FAILURE);
+	}
+
+	WSADATA wsa_data;
+	if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+		std::cerr << "WSAStartup failed" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	SOCKET listen_sock = socket(AF_INET, SOCK_STREAM, 0);
+
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	int addr_size = sizeof(addr);
+	if (listen_sock == INVALID_SOCKET
+		|| bind(listen_sock, (sockaddr*) &addr, sizeof(addr)) == SOCKET_ERROR
+		|| listen(listen_sock, 16) == SOCKET_ERROR
+		|| getsockname(listen_sock, (sockaddr*) &addr, &addr_size) == SOCKET_ERROR) {
+		std::cerr << "Failed to listen on the loopback" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	int port = ntohs(addr.sin_port);
+
+	if (program.get<int>("--throughput-mb") > 0) {
+		bool ok = RunThroughputBench(listen_sock, port, program.get<int>("--throughput-mb"), std::max(1, program.get<int>("--frame-kb")));
+
+		closesocket(listen_sock);
+		WSACleanup();
+		return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	std::thread server(EchoServer, listen_sock);
+
+	int stream_count = std::max(1, program.get<int>("--streams"));
+	int frame_count = std::max(1, program.get<int>("--frames"));
+
+	bool ok = RunEchoTest(false, port, stream_count, frame_count);
+	ok = RunEchoTest(true, port, stream_count, frame_count) && ok;
+	ok = RunHandleReuseTest(port) && ok;
+
+	s_stop_server = true;
+	server.join();
+
+	closesocket(listen_sock);
+	WSACleanup();
+
+	std::cout << (ok ? "OK" : "FAILED") << std::endl;
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,5 +1,6 @@
 #include "Stdafx.h"
 #include "PackLib/PackManager.h"
+#include "EterBase/TimeProfiler.h"
 
 #include "terrain.h"
 #include <math.h>
@@ -73,6 +74,7 @@ void CTerrainImpl::Clear()
 
 bool CTerrainImpl::LoadHeightMap(const char*c_szFileName)
 {
+	TIME_PROFILE_SCOPE("CTerrainImpl::LoadHeightMap");
 	Tracef("LoadRawHeightMapFile %s ", c_szFileName);
 	
 	TPackFile	kMappedFile;
@@ -91,8 +93,7 @@ bool CTerrainImpl::LoadHeightMap(const char*c_szFileName)
 
 bool CTerrainImpl::LoadAttrMap(const char *c_szFileName)
 {
-	DWORD dwStart = ELTimer_GetMSec();
-	Tracef("LoadAttrMapFile %s ", c_szFileName);
+	TIME_PROFILE_SCOPE("CTerrainImpl::LoadAttrMap");
 
 	TPackFile	kMappedFile;
 
@@ -157,12 +158,12 @@ bool CTerrainImpl::LoadAttrMap(const char *c_szFileName)
 		memcpy(m_abyAttrMap, abSrcAttrData, sizeof(m_abyAttrMap));		
 	}
 
-	Tracef("%d\n", ELTimer_GetMSec() - dwStart);
 	return true;
 }
 
 bool CTerrainImpl::RAW_LoadTileMap(const char * c_szFileName)
 {
+	TIME_PROFILE_SCOPE("CTerrainImpl::RAW_LoadTileMap");
 	Tracef("LoadSplatFile %s ", c_szFileName);
 	
 	TPackFile	kMappedFile;
@@ -182,7 +183,7 @@ bool CTerrainImpl::RAW_LoadTileMap(const char * c_szFileName)
 
 bool CTerrainImpl::LoadWaterMap(const char * c_szFileName)
 {	
-	DWORD dwStart = ELTimer_GetMSec();
+	TIME_PROFILE_SCOPE("CTerrainImpl::LoadWaterMap");
 
 	if (!LoadWaterMapFile(c_szFileName))
 	{
@@ -196,7 +197,6 @@ bool CTerrainImpl::LoadWaterMap(const char * c_szFileName)
 		return false;
 	}
 
-	Tracef("LoadWaterMapFile %s %d\n", c_szFileName, ELTimer_GetMSec() - dwStart);
 	return true;
 }
 
@@ -0,0 +1,128 @@
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <filesystem>
+
+#include <argparse.hpp>
+
+#include "PackLib/Pack.h"
+
+// Compares a pack built with the trained dictionary against one built from the same input with --dict-size 0.
+// Only the entries the first pack compressed against its dictionary are measured, in both packs: the bytes
+// they take up and how fast GetFile decodes them, the rest of the pack is the same either way.
+
+struct TDictBenchResult
+{
+	uint64_t stored_size = 0;
+	uint64_t file_size = 0;
+	double seconds = 0.0;
+};
+
+static bool MeasureEntries(const CPack& pack, const std::vector<const TPackFileEntry*>& entries, int rounds, TDictBenchResult& result)
+{
+	TPackFile buffer;
+	for (const TPackFileEntry* entry : entries) {
+		result.stored_size += entry->compressed_size;
+		result.file_size += entry->file_size;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; ++round) {
+		for (const TPackFileEntry* entry : entries) {
+			if (!pack.GetFile(*entry, buffer)) {
+				std::cerr << "Failed to read entry: " << pack.GetEntryName(*entry) << std::endl;
+				return false;
+			}
+		}
+	}
+
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return true;
+}
+
+static void PrintResult(const char* label, const std::string& path, const TDictBenchResult& result, int rounds)
+{
+	std::cout << label << ": pack " << std::filesystem::file_size(path) << " bytes, entries " << result.file_size << " -> "
+		<< result.stored_size << " bytes (" << (100.0 * result.stored_size / result.file_size) << "%), decoded at "
+		<< (result.file_size * rounds / 1048576.0 / result.seconds) << " MB/s" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	argparse::ArgumentParser program("PackDictBench");
+
+	program.add_argument("--pack")
+		.required()
+		.help("Pack built with a dictionary");
+
+	program.add_argument("--baseline")
+		.required()
+		.help("Pack built from the same input with --dict-size 0");
+
+	program.add_argument("--rounds")
+		.default_value(20)
+		.scan<'i', int>()
+		.help("Times every measured entry is decoded");
+
+	try {
+		program.parse_args(argc, argv);
+	}
+	catch (const std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+		std::cerr << program;
+		std::exit(EXIT_FAILURE);
+	}
+
+	std::string pack_path = program.get<std::string>("--pack");
+	std::string baseline_path = program.get<std::string>("--baseline");
+
+	CPack pack, baseline;
+	if (!pack.Open(pack_path)) {
+		std::cerr << "Failed to open pack: " << pack_path << ": " << pack.GetError() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (!baseline.Open(baseline_path)) {
+		std::cerr << "Failed to open pack: " << baseline_path << ": " << baseline.GetError() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<const TPackFileEntry*> dict_entries, baseline_entries;
+	for (size_t i = 0; i < pack.GetEntryCount(); ++i) {
+		const TPackFileEntry& entry = pack.GetEntry(i);
+		if (entry.compression != PACK_COMPRESSION_ZSTD_DICT)
+			continue;
+
+		std::string_view name = pack.GetEntryName(entry);
+		const TPackFileEntry* baseline_entry = baseline.FindEntry(entry.hash, name);
+		if (!baseline_entry) {
+			std::cerr << "Baseline pack lacks entry: " << name << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		if (baseline_entry->compression == PACK_COMPRESSION_ZSTD_DICT) {
+			std::cerr << "Baseline pack was built with a dictionary: " << baseline_path << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		dict_entries.push_back(&entry);
+		baseline_entries.push_back(baseline_entry);
+	}
+
+	if (dict_entries.empty()) {
+		std::cerr << "Pack has no dictionary compressed entries: " << pack_path << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	int rounds = std::max(1, program.get<int>("--rounds"));
+
+	TDictBenchResult dict_result, baseline_result;
+	if (!MeasureEntries(baseline, baseline_entries, rounds, baseline_result) || !MeasureEntries(pack, dict_entries, rounds, dict_result))
+		return EXIT_FAILURE;
+
+	std::cout << dict_entries.size() << " dictionary entries, " << rounds << " rounds" << std::endl;
+	PrintResult("without dictionary", baseline_path, baseline_result, rounds);
+	PrintResult("with dictionary", pack_path, dict_result, rounds);
+
+	return EXIT_SUCCESS;
+}
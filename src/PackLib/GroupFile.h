@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+// Pre-parsed form of a CTextFileLoader group file (.msa, .msm, ...), written by PackMaker --compile-groups
+// in place of the text under the same name. CTextFileLoader::Load tells the two apart by the magic and reads
+// the compiled one in place, no tokenizing and no number parsing left to do on the client.
+// Layout: header | nodes[node_count] | ranges[range_count] | tokens[token_count] | string table
+constexpr uint8_t GROUP_FILE_MAGIC[4] = { 0, 'T', 'G', 'F' };	// no text file starts with a null byte
+constexpr uint32_t GROUP_FILE_VERSION = 1;
+
+enum EGroupFileFlags : uint32_t
+{
+	GROUP_FILE_FLAG_COMPLETE = 1,	// the text parsed with balanced braces, what CTextFileLoader::Load returns
+};
+
+#pragma pack(push, 1)
+struct TGroupFileHeader
+{
+	uint8_t		magic[4];
+	uint32_t	version;
+	uint32_t	flags;
+	uint32_t	node_count;
+	uint32_t	range_count;
+	uint32_t	token_count;
+	uint32_t	strings_size;
+};
+// offset into the string table, every string is followed by a null byte not counted in size
+struct TGroupFileString
+{
+	uint32_t	offset;
+	uint32_t	size;
+};
+// Nodes in the order the text opens them, node 0 is the global scope and every parent comes before
+// its children. Names and keys keep their original case, the reader derives the lower case keys.
+struct TGroupFileNode
+{
+	uint32_t			parent;
+	TGroupFileString	name;
+	uint32_t			first_range;
+	uint32_t			range_count;
+};
+// a key and its values in the order they appear in the text, the first of equal keys wins
+struct TGroupFileRange
+{
+	TGroupFileString	key;
+	uint32_t			first_token;
+	uint32_t			token_count;
+};
+// every value keeps its text next to what atof and atoi make of it
+struct TGroupFileToken
+{
+	TGroupFileString	text;
+	float				value;
+	int32_t				integer;
+};
+#pragma pack(pop)
+
+inline bool IsGroupFile(std::span<const uint8_t> data)
+{
+	return data.size() >= sizeof(TGroupFileHeader) && memcmp(data.data(), GROUP_FILE_MAGIC, sizeof(GROUP_FILE_MAGIC)) == 0;
+}
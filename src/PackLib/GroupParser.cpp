@@ -0,0 +1,167 @@
+#include "GroupParser.h"
+#include <algorithm>
+
+static bool IsKeyword(std::string_view token, std::string_view keyword)
+{
+	return token.size() == keyword.size() && std::equal(token.begin(), token.end(), keyword.begin(), [](char a, char b) {
+		return (a >= 'A' && a <= 'Z' ? char(a - 'A' + 'a') : a) == b;
+	});
+}
+
+// 0 ok, -1 blank line, -2 unterminated quote
+static int SplitTokens(std::string_view line, std::vector<std::string_view>& tokens)
+{
+	constexpr const char* delimiters = " \t";
+
+	tokens.clear();
+
+	size_t base = 0;
+	do {
+		size_t begin = line.find_first_not_of(delimiters, base);
+		if (begin == std::string_view::npos) {
+			return -1;
+		}
+
+		size_t end;
+		if (line[begin] == '"') {
+			++begin;
+			end = line.find('"', begin);
+			if (end == std::string_view::npos) {
+				return -2;
+			}
+
+			base = end + 1;
+		}
+		else {
+			end = line.find_first_of(delimiters, begin);
+			base = end;
+		}
+
+		tokens.push_back(line.substr(begin, end - begin));
+
+		// trailing delimiters don't make another token
+		if (line.find_first_not_of(delimiters, base) == std::string_view::npos) {
+			break;
+		}
+	} while (base < line.size());
+
+	return 0;
+}
+
+bool CGroupParser::Parse(std::string_view text)
+{
+	nodes.clear();
+	ranges.clear();
+	tokens.clear();
+	errors.clear();
+
+	m_text = text;
+	m_position = 0;
+	m_lines_read = 0;
+
+	nodes.push_back(TGroupParseNode{ 0, "global" });
+	return ParseGroup(0);
+}
+
+bool CGroupParser::NextLine(std::string_view& line)
+{
+	if (m_position > m_text.size()) {
+		return false;
+	}
+
+	const char* begin = m_text.data() + m_position;
+	const char* end = m_text.data() + m_text.size();
+	const char* line_break = std::find_if(begin, end, [](char c) { return c == '\n' || c == '\r'; });
+
+	line = std::string_view(begin, line_break - begin);
+	++m_lines_read;
+
+	// any pair of line break characters ("\r\n", "\n\n", ...) counts as a single break, text without a final
+	// break still ends in a line
+	m_position = line_break - m_text.data() + 1;
+	if (m_position < m_text.size() && (m_text[m_position] == '\n' || m_text[m_position] == '\r')) {
+		++m_position;
+	}
+
+	return true;
+}
+
+bool CGroupParser::ParseGroup(uint32_t node)
+{
+	int depth = 0;
+
+	std::string_view line;
+	while (NextLine(line)) {
+		int ret = SplitTokens(line, m_line_tokens);
+		if (ret != 0) {
+			if (ret == -2) {
+				errors.push_back("cannot find \" in line " + std::to_string(m_lines_read - 1));
+			}
+			continue;
+		}
+
+		std::string_view key = m_line_tokens[0];
+
+		if (key.starts_with('{')) {
+			depth++;
+			continue;
+		}
+
+		if (key.starts_with('}')) {
+			depth--;
+			break;
+		}
+
+		if (IsKeyword(key, "group")) {
+			if (m_line_tokens.size() != 2) {
+				errors.push_back("group without a name in line " + std::to_string(m_lines_read - 1));
+				continue;
+			}
+
+			uint32_t child = (uint32_t) nodes.size();
+			nodes.push_back(TGroupParseNode{ node, m_line_tokens[1] });
+
+			if (!ParseGroup(child)) {
+				return false;
+			}
+		}
+		else if (IsKeyword(key, "list")) {
+			if (m_line_tokens.size() != 2) {
+				errors.push_back("list without a name in line " + std::to_string(m_lines_read - 1));
+				continue;
+			}
+
+			TGroupParseRange range{ node, m_line_tokens[1], (uint32_t) tokens.size(), 0 };
+
+			while (NextLine(line)) {
+				if (SplitTokens(line, m_line_tokens) != 0) {
+					continue;
+				}
+
+				if (m_line_tokens[0].starts_with('{')) {
+					continue;
+				}
+
+				if (m_line_tokens[0].starts_with('}')) {
+					break;
+				}
+
+				tokens.insert(tokens.end(), m_line_tokens.begin(), m_line_tokens.end());
+			}
+
+			range.token_count = (uint32_t) (tokens.size() - range.first_token);
+			ranges.push_back(range);
+		}
+		else {
+			if (m_line_tokens.size() == 1) {
+				errors.push_back("must have a value (line: " + std::to_string(m_lines_read - 1) + " key: " + std::string(key) + ")");
+				break;
+			}
+
+			ranges.push_back(TGroupParseRange{ node, key, (uint32_t) tokens.size(), (uint32_t) (m_line_tokens.size() - 1) });
+			tokens.insert(tokens.end(), m_line_tokens.begin() + 1, m_line_tokens.end());
+		}
+	}
+
+	return depth == 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <string_view>
+
+// The grammar of CTextFileLoader group files (.msa, .msm, ...), in one place for the client, which parses the
+// text form on load, and PackMaker, which stores the result pre-parsed (see GroupFile.h). Lines end at any pair
+// of line break characters, tokens are separated by spaces and tabs and may be "quoted". A line starting with
+// "group <name>" opens a child node, "list <key>" collects every token up to its closing brace, any other line
+// is a key and its values. A key without a value ends the node it is in.
+struct TGroupParseNode
+{
+	uint32_t			parent;		// node 0 is the global scope, every parent comes before its children
+	std::string_view	name;
+};
+
+// a key and its values in the order they appear in the text, the first of equal keys of a node wins
+struct TGroupParseRange
+{
+	uint32_t			node;
+	std::string_view	key;
+	uint32_t			first_token;
+	uint32_t			token_count;
+};
+
+class CGroupParser
+{
+public:
+	// Everything points into text, which has to outlive the result. Returns whether the braces were balanced,
+	// what CTextFileLoader::Load returns; what could be parsed is kept either way.
+	bool Parse(std::string_view text);
+
+	std::vector<TGroupParseNode> nodes;
+	std::vector<TGroupParseRange> ranges;
+	std::vector<std::string_view> tokens;
+	std::vector<std::string> errors;	// lines that were skipped or ended a node early, for the caller to report
+
+private:
+	bool ParseGroup(uint32_t node);
+	bool NextLine(std::string_view& line);
+
+private:
+	std::string_view m_text;
+	size_t m_position = 0;		// start of the next line, past the end once the last one was read
+	size_t m_lines_read = 0;
+	std::vector<std::string_view> m_line_tokens;
+};
@@ -1,43 +1,293 @@
 #include "Pack.h"
+#include <algorithm>
+
+// the vendored zstd is linked statically, so the stable-output-buffer parameter is safe to use
+#define ZSTD_STATIC_LINKING_ONLY
 #include <zstd.h>
 
-bool CPack::Open(const std::string& path, TPackFileMap& entries)
+// encrypted entries are decrypted this many bytes at a time on their way into the decoder
+constexpr size_t PACK_STREAM_WINDOW = 64 * 1024;
+
+void CPack::TDDictDeleter::operator()(ZSTD_DDict_s* ddict) const
+{
+	ZSTD_freeDDict(ddict);
+}
+
+static ZSTD_DCtx* GetThreadDCtx()
+{
+	thread_local std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> dctx(ZSTD_createDCtx(), &ZSTD_freeDCtx);
+	return dctx.get();
+}
+
+bool CPack::Open(const std::string& path)
 {
 	std::error_code ec;
 	m_file.map(path, ec);
 	
 	if (ec) {
+		m_error = "cannot be mapped: " + ec.message();
 		return false;
 	}
 
 	size_t file_size = m_file.size();
 	if (file_size < sizeof(TPackFileHeader)) {
+		m_error = "too small for a pack header";
 		return false;
 	}
 
 	memcpy(&m_header, m_file.data(), sizeof(TPackFileHeader));
-	m_decryption.SetKeyWithIV(PACK_KEY.data(), PACK_KEY.size(), m_header.iv, CryptoPP::Camellia::BLOCKSIZE);
 
-	if (file_size < sizeof(TPackFileHeader) + m_header.entry_num * sizeof(TPackFileEntry)) {
+	// checked before anything else in the header is trusted, an old pack has no magic at all
+	if (m_header.magic != PACK_MAGIC) {
+		m_error = "not a pack file or made by an old PackMaker, rebuild it";
 		return false;
 	}
 
-	for (size_t i = 0; i < m_header.entry_num; i++) {
-		TPackFileEntry entry;
-		memcpy(&entry, m_file.data() + sizeof(TPackFileHeader) + i * sizeof(TPackFileEntry), sizeof(TPackFileEntry));
-		m_decryption.ProcessData((CryptoPP::byte*)&entry, (CryptoPP::byte*)&entry, sizeof(TPackFileEntry));
+	if (m_header.version != PACK_VERSION) {
+		m_error = "pack version " + std::to_string(m_header.version) + ", this build reads version " + std::to_string(PACK_VERSION) + ", rebuild it";
+		return false;
+	}
+
+	size_t names_begin = sizeof(TPackFileHeader) + m_header.entry_num * sizeof(TPackFileEntry);
+	if (file_size < names_begin + m_header.names_size || m_header.data_begin < names_begin + m_header.names_size) {
+		m_error = "entry or name table out of bounds";
+		return false;
+	}
+
+	if (m_header.dict_size) {
+		if (file_size < m_header.dict_offset + m_header.dict_size) {
+			m_error = "dictionary out of bounds";
+			return false;
+		}
 
-		entries[entry.file_name] = std::make_pair(shared_from_this(), entry);
+		m_ddict.reset(ZSTD_createDDict(m_file.data() + m_header.dict_offset, m_header.dict_size));
+		if (!m_ddict) {
+			m_error = "invalid dictionary";
+			return false;
+		}
+	}
+
+	CryptoPP::CTR_Mode<CryptoPP::Camellia>::Decryption decryption;
+	decryption.SetKeyWithIV(PACK_KEY.data(), PACK_KEY.size(), m_header.iv, CryptoPP::Camellia::BLOCKSIZE);
+
+	m_names.resize(m_header.names_size);
+	decryption.ProcessData((CryptoPP::byte*)m_names.data(), (const CryptoPP::byte*)m_file.data() + names_begin, m_names.size());
+
+	m_entries = reinterpret_cast<const TPackFileEntry*>(m_file.data() + sizeof(TPackFileHeader));
+
+	for (size_t i = 0; i < m_header.entry_num; i++) {
+		const TPackFileEntry& entry = m_entries[i];
 
 		if (file_size < m_header.data_begin + entry.offset + entry.compressed_size) {
+			m_error = "entry data out of bounds";
+			return false;
+		}
+
+		if (m_header.names_size < (uint64_t) entry.name_offset + entry.name_size) {
+			m_error = "entry name out of bounds";
+			return false;
+		}
+
+		if (i > 0 && m_entries[i - 1].hash > entry.hash) {
+			m_error = "entry table not sorted by hash";
+			return false;
+		}
+	}
+
+	m_error.clear();
+	return true;
+}
+
+std::string_view CPack::GetEntryName(const TPackFileEntry& entry) const
+{
+	return std::string_view(m_names).substr(entry.name_offset, entry.name_size);
+}
+
+const TPackFileEntry* CPack::FindEntry(uint64_t hash, std::string_view name) const
+{
+	const TPackFileEntry* end = m_entries + m_header.entry_num;
+	const TPackFileEntry* it = std::lower_bound(m_entries, end, hash, [](const TPackFileEntry& entry, uint64_t hash) {
+		return entry.hash < hash;
+	});
+
+	for (; it != end && it->hash == hash; ++it) {
+		if (GetEntryName(*it) == name) {
+			return it;
+		}
+	}
+
+	return nullptr;
+}
+
+bool CPack::Decompress(const TPackFileEntry& entry, const uint8_t* data, TPackFile& result) const
+{
+	switch (entry.compression)
+	{
+		case PACK_COMPRESSION_ZSTD: {
+			size_t decompressed_size = ZSTD_decompressDCtx(GetThreadDCtx(), result.data(), result.size(), data, entry.compressed_size);
+			if (decompressed_size != entry.file_size) {
+				return false;
+			}
+		} break;
+
+		case PACK_COMPRESSION_ZSTD_DICT: {
+			if (!m_ddict) {
+				return false;
+			}
+
+			size_t decompressed_size = ZSTD_decompress_usingDDict(GetThreadDCtx(), result.data(), result.size(), data, entry.compressed_size, m_ddict.get());
+			if (decompressed_size != entry.file_size) {
+				return false;
+			}
+		} break;
+
+		case PACK_COMPRESSION_STORED: {
+			if (entry.compressed_size != entry.file_size) {
+				return false;
+			}
+
+			memcpy(result.data(), data, entry.file_size);
+		} break;
+
+		case PACK_COMPRESSION_ZSTD_CHUNKED: {
+			return DecompressChunks(entry, data, 0, entry.file_size, result.data());
+		}
+
+		default: return false;
+	}
+
+	return true;
+}
+
+static bool IsValidChunkHeader(const TPackFileEntry& entry, const TPackChunkHeader& header)
+{
+	uint64_t table_size = (uint64_t(header.chunk_count) + 1) * sizeof(uint64_t);
+	if (header.chunk_size == 0 || entry.compressed_size < sizeof(header) + table_size) {
+		return false;
+	}
+
+	return uint64_t(header.chunk_count) * header.chunk_size >= entry.file_size;
+}
+
+bool CPack::DecompressChunks(const TPackFileEntry& entry, const uint8_t* data, uint64_t offset, uint64_t size, uint8_t* result, uint64_t skipped) const
+{
+	if (size == 0) {
+		return true;
+	}
+
+	TPackChunkHeader header;
+	if (entry.compressed_size < sizeof(header)) {
+		return false;
+	}
+
+	memcpy(&header, data, sizeof(header));
+	if (!IsValidChunkHeader(entry, header)) {
+		return false;
+	}
+
+	const uint8_t* table = data + sizeof(header);
+	uint64_t chunks_begin = sizeof(header) + (uint64_t(header.chunk_count) + 1) * sizeof(uint64_t) + skipped;
+
+	thread_local std::vector<uint8_t> chunk_buffer;
+
+	uint64_t first = offset / header.chunk_size;
+	uint64_t last = (offset + size - 1) / header.chunk_size;
+	for (uint64_t chunk = first; chunk <= last; chunk++) {
+		uint64_t begin, end;
+		memcpy(&begin, table + chunk * sizeof(uint64_t), sizeof(uint64_t));
+		memcpy(&end, table + (chunk + 1) * sizeof(uint64_t), sizeof(uint64_t));
+		if (begin < chunks_begin || begin > end || end > entry.compressed_size) {
 			return false;
 		}
+
+		// data holds the chunks shifted down by what the caller left out after the table
+		const uint8_t* compressed = data + (begin - skipped);
+
+		uint64_t chunk_begin = chunk * header.chunk_size;
+		uint64_t raw_size = std::min<uint64_t>(header.chunk_size, entry.file_size - chunk_begin);
+
+		// the part of this chunk that falls into the requested range
+		uint64_t copy_begin = std::max(offset, chunk_begin) - chunk_begin;
+		uint64_t copy_end = std::min(offset + size, chunk_begin + raw_size) - chunk_begin;
+		uint8_t* dest = result + (chunk_begin + copy_begin - offset);
+
+		if (end - begin == raw_size) {
+			memcpy(dest, compressed + copy_begin, copy_end - copy_begin);
+			continue;
+		}
+
+		// fully covered chunks go straight into the result, partial ones through a scratch buffer
+		bool whole = copy_begin == 0 && copy_end == raw_size;
+		if (!whole) {
+			chunk_buffer.resize(raw_size);
+		}
+
+		uint8_t* target = whole ? dest : chunk_buffer.data();
+		size_t decompressed_size = ZSTD_decompressDCtx(GetThreadDCtx(), target, raw_size, compressed, end - begin);
+		if (decompressed_size != raw_size) {
+			return false;
+		}
+
+		if (!whole) {
+			memcpy(dest, chunk_buffer.data() + copy_begin, copy_end - copy_begin);
+		}
 	}
 
 	return true;
 }
 
-bool CPack::GetFile(const TPackFileEntry& entry, TPackFile& result)
+bool CPack::DecryptDecompressChunks(const TPackFileEntry& entry, const uint8_t* data, uint64_t offset, uint64_t size, uint8_t* result) const
+{
+	if (size == 0) {
+		return true;
+	}
+
+	CryptoPP::CTR_Mode<CryptoPP::Camellia>::Decryption decryption;
+	decryption.SetKeyWithIV(PACK_KEY.data(), PACK_KEY.size(), entry.iv, sizeof(entry.iv));
+
+	TPackChunkHeader header;
+	if (entry.compressed_size < sizeof(header)) {
+		return false;
+	}
+
+	decryption.ProcessData((uint8_t*) &header, data, sizeof(header));
+	if (!IsValidChunkHeader(entry, header)) {
+		return false;
+	}
+
+	uint64_t table_end = sizeof(header) + (uint64_t(header.chunk_count) + 1) * sizeof(uint64_t);
+
+	// header and table first, then the chunks of the range right behind them
+	thread_local std::vector<uint8_t> decrypted;
+	decrypted.resize(table_end);
+	memcpy(decrypted.data(), &header, sizeof(header));
+	decryption.ProcessData(decrypted.data() + sizeof(header), data + sizeof(header), table_end - sizeof(header));
+
+	uint64_t first = offset / header.chunk_size;
+	uint64_t last = (offset + size - 1) / header.chunk_size;
+
+	uint64_t span_begin = UINT64_MAX, span_end = 0;
+	for (uint64_t chunk = first; chunk <= last; chunk++) {
+		uint64_t begin, end;
+		memcpy(&begin, decrypted.data() + sizeof(header) + chunk * sizeof(uint64_t), sizeof(uint64_t));
+		memcpy(&end, decrypted.data() + sizeof(header) + (chunk + 1) * sizeof(uint64_t), sizeof(uint64_t));
+		span_begin = std::min(span_begin, begin);
+		span_end = std::max(span_end, end);
+	}
+
+	if (span_begin < table_end || span_begin > span_end || span_end > entry.compressed_size) {
+		return false;
+	}
+
+	// CTR seeks like the stored path, the chunks outside the range are never decrypted
+	decrypted.resize(table_end + (span_end - span_begin));
+	decryption.Seek(span_begin);
+	decryption.ProcessData(decrypted.data() + table_end, data + span_begin, span_end - span_begin);
+
+	return DecompressChunks(entry, decrypted.data(), offset, size, result, span_begin - table_end);
+}
+
+bool CPack::GetFile(const TPackFileEntry& entry, TPackFile& result) const
 {
 	result.resize(entry.file_size);
 
@@ -45,27 +295,205 @@ bool CPack::GetFile(const TPackFileEntry& entry, TPackFile& result)
 	switch (entry.encryption)
 	{
 		case 0: {
-			size_t decompressed_size = ZSTD_decompress(result.data(), result.size(), m_file.data() + offset, entry.compressed_size);
-			if (decompressed_size != entry.file_size) {
+			return Decompress(entry, (const uint8_t*)m_file.data() + offset, result);
+		}
+
+		case 1: {
+			return DecryptDecompress(entry, result);
+		}
+
+		default: return false;
+	}
+}
+
+bool CPack::DecryptDecompress(const TPackFileEntry& entry, TPackFile& result) const
+{
+	const uint8_t* data = (const uint8_t*)m_file.data() + m_header.data_begin + entry.offset;
+
+	CryptoPP::CTR_Mode<CryptoPP::Camellia>::Decryption decryption;
+	decryption.SetKeyWithIV(PACK_KEY.data(), PACK_KEY.size(), entry.iv, sizeof(entry.iv));
+
+	thread_local std::vector<uint8_t> window;
+
+	switch (entry.compression)
+	{
+		case PACK_COMPRESSION_STORED: {
+			if (entry.compressed_size != entry.file_size) {
 				return false;
 			}
-		} break;
 
-		case 1: {
-			std::vector<uint8_t> compressed_data(entry.compressed_size);
-			memcpy(compressed_data.data(), m_file.data() + offset, entry.compressed_size);
+			decryption.ProcessData(result.data(), data, entry.file_size);
+			return true;
+		}
 
-			m_decryption.Resynchronize(entry.iv, sizeof(entry.iv));
-			m_decryption.ProcessData(compressed_data.data(), compressed_data.data(), entry.compressed_size);
+		case PACK_COMPRESSION_ZSTD:
+		case PACK_COMPRESSION_ZSTD_DICT: {
+			if (entry.compression == PACK_COMPRESSION_ZSTD_DICT && !m_ddict) {
+				return false;
+			}
 
-			size_t decompressed_size = ZSTD_decompress(result.data(), result.size(), compressed_data.data(), compressed_data.size());
-			if (decompressed_size != entry.file_size) {
+			// the output never moves, which lets zstd decode into it directly instead of through a window of its own
+			ZSTD_DCtx* dctx = GetThreadDCtx();
+			ZSTD_DCtx_reset(dctx, ZSTD_reset_session_and_parameters);
+			ZSTD_DCtx_setParameter(dctx, ZSTD_d_stableOutBuffer, 1);
+			if (entry.compression == PACK_COMPRESSION_ZSTD_DICT) {
+				ZSTD_DCtx_refDDict(dctx, m_ddict.get());
+			}
+
+			window.resize(PACK_STREAM_WINDOW);
+
+			ZSTD_outBuffer out = { result.data(), result.size(), 0 };
+			size_t status = 1;
+			bool success = true;
+
+			for (uint64_t pos = 0; success && pos < entry.compressed_size;) {
+				size_t len = (size_t) std::min<uint64_t>(window.size(), entry.compressed_size - pos);
+				decryption.ProcessData(window.data(), data + pos, len);
+				pos += len;
+
+				ZSTD_inBuffer in = { window.data(), len, 0 };
+				while (in.pos < in.size) {
+					size_t in_pos = in.pos, out_pos = out.pos;
+					status = ZSTD_decompressStream(dctx, &out, &in);
+					if (ZSTD_isError(status) || (in.pos == in_pos && out.pos == out_pos)) {
+						success = false;
+						break;
+					}
+				}
+			}
+
+			// the one-shot paths share this context and must not inherit the dictionary or the stable buffer
+			ZSTD_DCtx_reset(dctx, ZSTD_reset_session_and_parameters);
+			return success && status == 0 && out.pos == entry.file_size;
+		}
+
+		case PACK_COMPRESSION_ZSTD_CHUNKED: {
+			TPackChunkHeader header;
+			if (entry.compressed_size < sizeof(header)) {
 				return false;
 			}
-		} break;
+
+			decryption.ProcessData((uint8_t*) &header, data, sizeof(header));
+			if (!IsValidChunkHeader(entry, header)) {
+				return false;
+			}
+
+			std::vector<uint64_t> table(uint64_t(header.chunk_count) + 1);
+			decryption.ProcessData((uint8_t*) table.data(), data + sizeof(header), table.size() * sizeof(uint64_t));
+
+			// chunks follow the table back to back, so the keystream simply runs on from chunk to chunk
+			uint64_t pos = sizeof(header) + table.size() * sizeof(uint64_t);
+			for (uint64_t chunk_begin = 0, chunk = 0; chunk_begin < entry.file_size; chunk_begin += header.chunk_size, chunk++) {
+				uint64_t begin = table[chunk], end = table[chunk + 1];
+				if (begin != pos || begin > end || end > entry.compressed_size) {
+					return false;
+				}
+
+				window.resize(end - begin);
+				decryption.ProcessData(window.data(), data + begin, window.size());
+				pos = end;
+
+				uint64_t raw_size = std::min<uint64_t>(header.chunk_size, entry.file_size - chunk_begin);
+				if (window.size() == raw_size) {
+					memcpy(result.data() + chunk_begin, window.data(), raw_size);
+					continue;
+				}
+
+				size_t decompressed_size = ZSTD_decompressDCtx(GetThreadDCtx(), result.data() + chunk_begin, raw_size, window.data(), window.size());
+				if (decompressed_size != raw_size) {
+					return false;
+				}
+			}
+
+			return true;
+		}
 
 		default: return false;
 	}
+}
+
+bool CPack::ReadRange(const TPackFileEntry& entry, uint64_t offset, uint64_t size, TPackFile& result) const
+{
+	if (offset > entry.file_size || size > entry.file_size - offset) {
+		return false;
+	}
+
+	result.resize(size);
+
+	const uint8_t* data = (const uint8_t*)m_file.data() + m_header.data_begin + entry.offset;
+
+	switch (entry.compression)
+	{
+		case PACK_COMPRESSION_STORED: {
+			if (entry.compressed_size != entry.file_size) {
+				return false;
+			}
+
+			switch (entry.encryption)
+			{
+				case 0: {
+					memcpy(result.data(), data + offset, size);
+				} break;
+
+				// CTR can start anywhere in the keystream, only the range itself gets decrypted
+				case 1: {
+					CryptoPP::CTR_Mode<CryptoPP::Camellia>::Decryption decryption;
+					decryption.SetKeyWithIV(PACK_KEY.data(), PACK_KEY.size(), entry.iv, sizeof(entry.iv));
+					decryption.Seek(offset);
+					decryption.ProcessData(result.data(), data + offset, size);
+				} break;
+
+				default: return false;
+			}
+
+			return true;
+		}
+
+		case PACK_COMPRESSION_ZSTD_CHUNKED: {
+			switch (entry.encryption)
+			{
+				case 0: return DecompressChunks(entry, data, offset, size, result.data());
+				case 1: return DecryptDecompressChunks(entry, data, offset, size, result.data());
+				default: return false;
+			}
+		}
+
+		// single frame entries have no random access, decode all of it and cut the range out
+		default: {
+			TPackFile whole;
+			if (!GetFile(entry, whole)) {
+				return false;
+			}
+
+			memcpy(result.data(), whole.data() + offset, size);
+			return true;
+		}
+	}
+}
+
+bool CPack::GetFileView(const TPackFileEntry& entry, TPackFileView& result) const
+{
+	if (entry.encryption != 0 || entry.compression != PACK_COMPRESSION_STORED) {
+		return false;
+	}
+
+	if (entry.compressed_size != entry.file_size) {
+		return false;
+	}
 
+	size_t offset = m_header.data_begin + entry.offset;
+	result = TPackFileView((const uint8_t*)m_file.data() + offset, entry.file_size);
 	return true;
 }
+
+void CPack::Prefetch(const TPackFileEntry& entry) const
+{
+	constexpr size_t page_size = 4096;
+
+	const volatile uint8_t* data = (const uint8_t*)m_file.data() + m_header.data_begin + entry.offset;
+	uint8_t sink = 0;
+	for (size_t i = 0; i < entry.compressed_size; i += page_size) {
+		sink ^= data[i];
+	}
+	(void)sink;
+}
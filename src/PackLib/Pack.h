@@ -4,18 +4,59 @@
 
 #include "config.h"
 
-class CPack : public std::enable_shared_from_this<CPack>
+struct ZSTD_DDict_s;
+
+class CPack
 {
 public:
 	CPack() = default;
 	~CPack() = default;
 
-	bool Open(const std::string& path, TPackFileMap& entries);
-	bool GetFile(const TPackFileEntry& entry, TPackFile& result);
+	bool Open(const std::string& path);
+	// why the last Open failed
+	const std::string& GetError() const { return m_error; }
+
+	// The entry table is used straight from the mapping, nothing is copied per entry.
+	size_t GetEntryCount() const { return m_header.entry_num; }
+	const TPackFileEntry& GetEntry(size_t index) const { return m_entries[index]; }
+	std::string_view GetEntryName(const TPackFileEntry& entry) const;
+
+	// name must already be normalized (see PackNormalizePath)
+	const TPackFileEntry* FindEntry(uint64_t hash, std::string_view name) const;
+
+	// Holds no mutable state once opened, every call uses its own cipher context
+	// so any number of threads may read from the same pack at once.
+	bool GetFile(const TPackFileEntry& entry, TPackFile& result) const;
+
+	// Points result straight into the mapped archive, only possible for unencrypted stored entries.
+	// The view stays valid for as long as the pack is alive.
+	bool GetFileView(const TPackFileEntry& entry, TPackFileView& result) const;
+
+	// Reads [offset, offset + size) of the file. Chunked entries only decompress the chunks the range touches.
+	bool ReadRange(const TPackFileEntry& entry, uint64_t offset, uint64_t size, TPackFile& result) const;
+
+	// touches every page of the entry's stored bytes so a later GetFile doesn't wait on disk
+	void Prefetch(const TPackFileEntry& entry) const;
+
+private:
+	bool Decompress(const TPackFileEntry& entry, const uint8_t* data, TPackFile& result) const;
+	// skipped: bytes between the chunk table and the first chunk that data leaves out
+	bool DecompressChunks(const TPackFileEntry& entry, const uint8_t* data, uint64_t offset, uint64_t size, uint8_t* result, uint64_t skipped = 0) const;
+	// decrypts the chunk table and the chunks of the range only, then decodes those
+	bool DecryptDecompressChunks(const TPackFileEntry& entry, const uint8_t* data, uint64_t offset, uint64_t size, uint8_t* result) const;
+	// decrypts through a small window straight into the decoder, result is the only full size buffer
+	bool DecryptDecompress(const TPackFileEntry& entry, TPackFile& result) const;
 
 private:
-	TPackFileHeader m_header;
+	struct TDDictDeleter { void operator()(ZSTD_DDict_s* ddict) const; };
+
+	TPackFileHeader m_header{};
 	mio::mmap_source m_file;
 
-	CryptoPP::CTR_Mode<CryptoPP::Camellia>::Decryption m_decryption;
+	const TPackFileEntry* m_entries = nullptr;
+	std::string m_names;	// decrypted name table, one buffer per pack
+	std::string m_error;
+
+	// digested once at open, ZSTD_DDict is read-only afterwards and can be shared between threads
+	std::unique_ptr<ZSTD_DDict_s, TDDictDeleter> m_ddict;
 };
\ No newline at end of file
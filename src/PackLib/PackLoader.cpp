@@ -0,0 +1,189 @@
+#include "PackLoader.h"
+#include "PackManager.h"
+#include <algorithm>
+
+CPackLoader::CPackLoader(const CPackManager& manager) : m_manager(manager)
+{
+}
+
+CPackLoader::~CPackLoader()
+{
+	Stop();
+}
+
+void CPackLoader::Start(size_t worker_count)
+{
+	Stop();
+
+	m_stopping = false;
+	for (size_t i = 0; i < worker_count; i++) {
+		m_workers.emplace_back(&CPackLoader::WorkerLoop, this);
+	}
+}
+
+void CPackLoader::Stop()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_stopping = true;
+	}
+	m_cv.notify_all();
+
+	for (std::thread& worker : m_workers) {
+		worker.join();
+	}
+	m_workers.clear();
+
+	std::lock_guard lock(m_mutex);
+	m_queue.clear();
+	m_queued_priority.clear();
+	m_in_flight.clear();
+	m_completions.clear();
+}
+
+TPackRequestID CPackLoader::Request(std::string_view path, TPackRequestCallback callback, int priority, TPackRequestDecoder decoder, bool loose_file)
+{
+	return Enqueue(path, std::move(callback), std::move(decoder), priority, false, loose_file);
+}
+
+void CPackLoader::Prefetch(std::string_view path, int priority)
+{
+	Enqueue(path, nullptr, nullptr, priority, true, false);
+}
+
+TPackRequestID CPackLoader::Enqueue(std::string_view path, TPackRequestCallback callback, TPackRequestDecoder decoder, int priority, bool prefetch, bool loose_file)
+{
+	TPackRequestID id;
+	{
+		std::lock_guard lock(m_mutex);
+		id = m_next_id++;
+		m_queue.emplace(TQueueKey(priority, id), TRequest{ id, std::string(path), std::move(callback), std::move(decoder), prefetch, loose_file });
+		m_queued_priority.emplace(id, priority);
+	}
+	m_cv.notify_one();
+	return id;
+}
+
+bool CPackLoader::Cancel(TPackRequestID id)
+{
+	std::lock_guard lock(m_mutex);
+
+	auto queued = m_queued_priority.find(id);
+	if (queued != m_queued_priority.end()) {
+		m_queue.erase(TQueueKey(queued->second, id));
+		m_queued_priority.erase(queued);
+		return true;
+	}
+
+	auto in_flight = m_in_flight.find(id);
+	if (in_flight != m_in_flight.end()) {
+		in_flight->second = true;
+		return true;
+	}
+
+	auto completed = std::find_if(m_completions.begin(), m_completions.end(), [id](const TCompletion& completion) {
+		return completion.request.id == id;
+	});
+
+	if (completed != m_completions.end()) {
+		m_completions.erase(completed);
+		return true;
+	}
+
+	return false;
+}
+
+void CPackLoader::CancelAll()
+{
+	std::lock_guard lock(m_mutex);
+
+	m_queue.clear();
+	m_queued_priority.clear();
+	m_completions.clear();
+
+	for (auto& [id, cancelled] : m_in_flight) {
+		cancelled = true;
+	}
+}
+
+size_t CPackLoader::DispatchCompletions(size_t max_count)
+{
+	// hand the whole batch over under a single lock, callbacks run unlocked so they may issue new requests
+	std::vector<TCompletion> batch;
+	{
+		std::lock_guard lock(m_mutex);
+		if (m_completions.empty()) {
+			return 0;
+		}
+
+		if (m_completions.size() <= max_count) {
+			batch.swap(m_completions);
+		}
+		else {
+			batch.assign(std::make_move_iterator(m_completions.begin()), std::make_move_iterator(m_completions.begin() + max_count));
+			m_completions.erase(m_completions.begin(), m_completions.begin() + max_count);
+		}
+	}
+
+	for (TCompletion& completion : batch) {
+		completion.request.callback(completion.request.path, completion.success, completion.file);
+	}
+
+	return batch.size();
+}
+
+bool CPackLoader::IsCancelled(TPackRequestID id)
+{
+	std::lock_guard lock(m_mutex);
+
+	auto in_flight = m_in_flight.find(id);
+	return in_flight == m_in_flight.end() || in_flight->second;
+}
+
+void CPackLoader::WorkerLoop()
+{
+	while (true) {
+		TRequest request;
+		{
+			std::unique_lock lock(m_mutex);
+			m_cv.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+			if (m_stopping) {
+				return;
+			}
+
+			auto it = m_queue.begin();
+			request = std::move(it->second);
+			m_queue.erase(it);
+			m_queued_priority.erase(request.id);
+
+			if (!request.prefetch) {
+				m_in_flight.emplace(request.id, false);
+			}
+		}
+
+		if (request.prefetch) {
+			m_manager.PrefetchFile(request.path);
+			continue;
+		}
+
+		TCompletion completion;
+		completion.success = m_manager.GetFile(request.path, completion.file, request.loose_file);
+
+		if (completion.success && request.decoder && !IsCancelled(request.id)) {
+			request.decoder(request.path, completion.file);
+		}
+
+		std::lock_guard lock(m_mutex);
+
+		auto in_flight = m_in_flight.find(request.id);
+		bool cancelled = in_flight == m_in_flight.end() || in_flight->second;
+		if (in_flight != m_in_flight.end()) {
+			m_in_flight.erase(in_flight);
+		}
+
+		if (!cancelled) {
+			completion.request = std::move(request);
+			m_completions.push_back(std::move(completion));
+		}
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <thread>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+
+#include "config.h"
+
+class CPackManager;
+
+using TPackRequestID = uint64_t;
+// Always invoked from DispatchCompletions, i.e. on the thread that pumps the loader (the main thread), never on a worker.
+using TPackRequestCallback = std::function<void(const std::string& path, bool success, TPackFile& file)>;
+// Optional step run on the worker right after a successful read, before the completion is queued. It gets the
+// file the callback will see and must be thread safe, it's meant for CPU work like decoding what was read.
+using TPackRequestDecoder = std::function<void(const std::string& path, TPackFile& file)>;
+
+// Pool of worker threads serving file requests against a CPackManager. Requests with the lowest
+// priority value are served first (pass e.g. the distance to the camera), equal priorities in FIFO order.
+class CPackLoader
+{
+public:
+	explicit CPackLoader(const CPackManager& manager);
+	~CPackLoader();
+
+	void Start(size_t worker_count);
+	void Stop();
+
+	// loose_file reads the path from the disk instead of the packs, see CPackManager::GetFile
+	TPackRequestID Request(std::string_view path, TPackRequestCallback callback, int priority, TPackRequestDecoder decoder = nullptr, bool loose_file = false);
+	// warms the pages of the entry's stored bytes without decompressing, no completion is reported
+	void Prefetch(std::string_view path, int priority);
+
+	// Drops a request that is queued, being loaded or waiting for dispatch; its callback won't run.
+	bool Cancel(TPackRequestID id);
+	void CancelAll();
+
+	size_t DispatchCompletions(size_t max_count);
+
+private:
+	struct TRequest
+	{
+		TPackRequestID id;
+		std::string path;
+		TPackRequestCallback callback;
+		TPackRequestDecoder decoder;
+		bool prefetch;
+		bool loose_file;
+	};
+
+	struct TCompletion
+	{
+		TRequest request;
+		bool success;
+		TPackFile file;
+	};
+
+	using TQueueKey = std::pair<int, TPackRequestID>;
+
+	TPackRequestID Enqueue(std::string_view path, TPackRequestCallback callback, TPackRequestDecoder decoder, int priority, bool prefetch, bool loose_file);
+	bool IsCancelled(TPackRequestID id);
+	void WorkerLoop();
+
+private:
+	const CPackManager& m_manager;
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_stopping = false;
+	TPackRequestID m_next_id = 1;
+
+	std::map<TQueueKey, TRequest> m_queue;
+	std::unordered_map<TPackRequestID, int> m_queued_priority;
+	std::unordered_map<TPackRequestID, bool> m_in_flight;	// id -> cancelled
+	std::vector<TCompletion> m_completions;
+
+	std::vector<std::thread> m_workers;
+};
@@ -1,61 +1,272 @@
 #include "PackManager.h"
 #include <fstream>
+#include <algorithm>
 #include <filesystem>
 
-bool CPackManager::AddPack(const std::string& path)
+static bool ReadLooseFile(const std::filesystem::path& path, TPackFile& result)
 {
-	std::shared_ptr<CPack> pack = std::make_shared<CPack>();
-	return pack->Open(path, m_entries);
+	std::ifstream ifs(path, std::ios::binary);
+	if (!ifs.is_open()) {
+		return false;
+	}
+
+	ifs.seekg(0, std::ios::end);
+	size_t size = ifs.tellg();
+	ifs.seekg(0, std::ios::beg);
+	result.resize(size);
+	return (bool) ifs.read((char*)result.data(), size);
 }
 
-bool CPackManager::GetFile(std::string_view path, TPackFile& result)
+static bool ReadLooseRange(const std::filesystem::path& path, uint64_t offset, uint64_t len, TPackFile& result)
 {
-	thread_local std::string buf;
-	NormalizePath(path, buf);
+	std::ifstream ifs(path, std::ios::binary);
+	if (!ifs.is_open()) {
+		return false;
+	}
+
+	ifs.seekg(0, std::ios::end);
+	uint64_t size = ifs.tellg();
+	if (offset > size || len > size - offset) {
+		return false;
+	}
 
-	if (m_load_from_pack) {
-		auto it = m_entries.find(buf);
-		if (it != m_entries.end()) {
-			return it->second.first->GetFile(it->second.second, result);
+	ifs.seekg(offset, std::ios::beg);
+	result.resize(len);
+	return (bool) ifs.read((char*)result.data(), len);
+}
+
+CPackManager::~CPackManager()
+{
+	m_loader.Stop();
+	m_overlay.Close();
+}
+
+bool CPackManager::AddPack(const std::string& path, std::string* error)
+{
+	std::unique_ptr<CPack> pack = std::make_unique<CPack>();
+	if (!pack->Open(path)) {
+		if (error) {
+			*error = pack->GetError();
 		}
+
+		return false;
 	}
-	else {
-		std::ifstream ifs(buf, std::ios::binary);
-		if (ifs.is_open()) {
-			ifs.seekg(0, std::ios::end);
-			size_t size = ifs.tellg();
-			ifs.seekg(0, std::ios::beg);
-			result.resize(size);
-			if (ifs.read((char*)result.data(), size)) {
+
+	const CPack& added = *pack;
+	uint32_t pack_index = (uint32_t) m_packs.size();
+	m_packs.push_back(std::move(pack));
+
+	// the pack's own table is already sorted by hash, so appending and merging keeps m_index sorted
+	// and, being stable, leaves the newer pack last within equal hashes
+	size_t old_size = m_index.size();
+	m_index.reserve(old_size + added.GetEntryCount());
+	for (size_t i = 0; i < added.GetEntryCount(); i++) {
+		m_index.push_back({ added.GetEntry(i).hash, pack_index, (uint32_t) i });
+	}
+
+	auto by_hash = [](const TPackIndexRef& a, const TPackIndexRef& b) { return a.hash < b.hash; };
+	std::inplace_merge(m_index.begin(), m_index.begin() + old_size, m_index.end(), by_hash);
+
+	// drop entries overridden by the new pack so a lookup never has to look past a name match
+	auto name_of = [this](const TPackIndexRef& ref) {
+		return m_packs[ref.pack]->GetEntryName(m_packs[ref.pack]->GetEntry(ref.entry));
+	};
+
+	auto shadowed = [&](size_t i) {
+		for (size_t j = i + 1; j < m_index.size() && m_index[j].hash == m_index[i].hash; j++) {
+			if (name_of(m_index[j]) == name_of(m_index[i]))
 				return true;
-			}
 		}
+		return false;
+	};
+
+	size_t out = 0;
+	for (size_t i = 0; i < m_index.size(); i++) {
+		bool same_hash_follows = i + 1 < m_index.size() && m_index[i + 1].hash == m_index[i].hash;
+		if (same_hash_follows && shadowed(i))
+			continue;
+
+		m_index[out++] = m_index[i];
+	}
+	m_index.resize(out);
+
+	return true;
+}
+
+const TPackFileEntry* CPackManager::FindEntry(std::string_view normalized_path, const CPack** pack) const
+{
+	uint64_t hash = PackPathHash(normalized_path);
+
+	auto it = std::lower_bound(m_index.begin(), m_index.end(), hash, [](const TPackIndexRef& ref, uint64_t hash) {
+		return ref.hash < hash;
+	});
+
+	for (; it != m_index.end() && it->hash == hash; ++it) {
+		const CPack* candidate = m_packs[it->pack].get();
+		const TPackFileEntry& entry = candidate->GetEntry(it->entry);
+		if (candidate->GetEntryName(entry) == normalized_path) {
+			*pack = candidate;
+			return &entry;
+		}
+	}
+
+	return nullptr;
+}
+
+bool CPackManager::GetFile(std::string_view path, TPackFile& result, bool loose_file) const
+{
+	thread_local std::string buf;
+	NormalizePath(path, buf);
+
+	if (loose_file) {
+		return ReadLooseFile(buf, result);
+	}
+
+	std::filesystem::path disk_path;
+	if (m_overlay.Find(buf, disk_path)) {
+		return ReadLooseFile(disk_path, result);
+	}
+
+	const CPack* pack;
+	if (const TPackFileEntry* entry = FindEntry(buf, &pack)) {
+		return pack->GetFile(*entry, result);
 	}
 
 	return false;
 }
 
-bool CPackManager::IsExist(std::string_view path) const
+bool CPackManager::ReadRange(std::string_view path, uint64_t offset, uint64_t len, TPackFile& result) const
 {
 	thread_local std::string buf;
 	NormalizePath(path, buf);
 
-	if (m_load_from_pack) {
-		auto it = m_entries.find(buf);
-		return it != m_entries.end();
+	std::filesystem::path disk_path;
+	if (m_overlay.Find(buf, disk_path)) {
+		return ReadLooseRange(disk_path, offset, len, result);
 	}
-	else {
+
+	const CPack* pack;
+	if (const TPackFileEntry* entry = FindEntry(buf, &pack)) {
+		return pack->ReadRange(*entry, offset, len, result);
+	}
+
+	return false;
+}
+
+bool CPackManager::GetFileView(std::string_view path, TPackFileView& result) const
+{
+	thread_local std::string buf;
+	NormalizePath(path, buf);
+
+	// overlay files have no mapping to point into, the GetFile fallback reads them
+	if (m_overlay.Contains(buf)) {
+		return false;
+	}
+
+	const CPack* pack;
+	const TPackFileEntry* entry = FindEntry(buf, &pack);
+	if (!entry) {
+		return false;
+	}
+
+	return pack->GetFileView(*entry, result);
+}
+
+bool CPackManager::GetFileView(std::string_view path, TPackFileView& result, TPackFile& storage, bool loose_file) const
+{
+	if (!loose_file && GetFileView(path, result)) {
+		return true;
+	}
+
+	if (!GetFile(path, storage, loose_file)) {
+		return false;
+	}
+
+	result = storage;
+	return true;
+}
+
+bool CPackManager::IsExist(std::string_view path, bool loose_file) const
+{
+	thread_local std::string buf;
+	NormalizePath(path, buf);
+
+	if (loose_file) {
 		return std::filesystem::exists(buf);
 	}
+
+	const CPack* pack;
+	return m_overlay.Contains(buf) || FindEntry(buf, &pack) != nullptr;
 }
 
-void CPackManager::NormalizePath(std::string_view in, std::string& out) const
+void CPackManager::PrefetchFile(std::string_view path) const
 {
-	out.resize(in.size());
-	for (std::size_t i = 0; i < out.size(); ++i) {
-		if (in[i] == '\\')
-			out[i] = '/';
-		else
-			out[i] = static_cast<char>(std::tolower(in[i]));
+	thread_local std::string buf;
+	NormalizePath(path, buf);
+
+	if (m_overlay.Contains(buf)) {
+		return;
 	}
+
+	const CPack* pack;
+	if (const TPackFileEntry* entry = FindEntry(buf, &pack)) {
+		pack->Prefetch(*entry);
+	}
+}
+
+bool CPackManager::SetOverlay(const std::string& directory, bool watch)
+{
+	return m_overlay.Open(directory, watch);
+}
+
+void CPackManager::ClearOverlay()
+{
+	m_overlay.Close();
+}
+
+void CPackManager::FetchChangedFiles(std::vector<std::string>& names)
+{
+	m_overlay.FetchChanged(names);
+}
+
+void CPackManager::StartAsyncLoading(size_t worker_count)
+{
+	m_loader.Start(worker_count);
+}
+
+void CPackManager::StopAsyncLoading()
+{
+	m_loader.Stop();
+}
+
+TPackRequestID CPackManager::RequestAsync(std::string_view path, TPackRequestCallback callback, int priority, TPackRequestDecoder decoder, bool loose_file)
+{
+	return m_loader.Request(path, std::move(callback), priority, std::move(decoder), loose_file);
+}
+
+void CPackManager::Prefetch(const std::vector<std::string>& paths, int priority)
+{
+	for (const std::string& path : paths) {
+		m_loader.Prefetch(path, priority);
+	}
+}
+
+bool CPackManager::CancelAsync(TPackRequestID id)
+{
+	return m_loader.Cancel(id);
+}
+
+void CPackManager::CancelAllAsync()
+{
+	m_loader.CancelAll();
+}
+
+size_t CPackManager::DispatchAsyncCompletions(size_t max_count)
+{
+	return m_loader.DispatchCompletions(max_count);
+}
+
+void CPackManager::NormalizePath(std::string_view in, std::string& out) const
+{
+	PackNormalizePath(in, out);
 }
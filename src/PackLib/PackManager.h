@@ -1,26 +1,76 @@
 #pragma once
-#include <unordered_map>
+#include <atomic>
+#include <vector>
 
 #include "EterBase/Singleton.h"
 #include "Pack.h"
+#include "PackLoader.h"
+#include "PackOverlay.h"
 
 class CPackManager : public CSingleton<CPackManager>
 {
 public:
 	CPackManager() = default;
-	virtual ~CPackManager() = default;
+	virtual ~CPackManager();
 
-	bool AddPack(const std::string& path);
-	bool GetFile(std::string_view path, TPackFile& result);
-	bool IsExist(std::string_view path) const;
+	// AddPack must only be called during startup, before any reader thread is running.
+	// error, if given, receives why the pack was rejected.
+	bool AddPack(const std::string& path, std::string* error = nullptr);
 
-	void SetPackLoadMode() { m_load_from_pack = true; }
-	void SetFileLoadMode() { m_load_from_pack = false; }
+	// GetFile and IsExist only read the pack index and never modify shared state,
+	// so they are safe to call from many threads at once (loader threads included).
+	// loose_file reads path straight from the disk instead, for files the client writes itself (guild marks).
+	bool GetFile(std::string_view path, TPackFile& result, bool loose_file = false) const;
+	bool IsExist(std::string_view path, bool loose_file = false) const;
+
+	// Reads len bytes at offset; chunked pack entries only decompress the blocks the range touches.
+	bool ReadRange(std::string_view path, uint64_t offset, uint64_t len, TPackFile& result) const;
+
+	// Zero-copy access for stored entries: result points into the pack mapping. Fails for
+	// compressed/encrypted entries, use GetFile for those.
+	bool GetFileView(std::string_view path, TPackFileView& result) const;
+	// Same as above, but falls back to GetFile into storage (and points result at it) when no view is possible.
+	bool GetFileView(std::string_view path, TPackFileView& result, TPackFile& storage, bool loose_file = false) const;
+
+	// Asynchronous loading on a pool of worker threads, lowest priority value first (e.g. distance to the camera).
+	// Completions are queued and handed to their callbacks in batches by DispatchAsyncCompletions on the main thread.
+	// A decoder passed along runs on the worker after the read, see TPackRequestDecoder.
+	void StartAsyncLoading(size_t worker_count);
+	void StopAsyncLoading();
+	TPackRequestID RequestAsync(std::string_view path, TPackRequestCallback callback, int priority = 0, TPackRequestDecoder decoder = nullptr, bool loose_file = false);
+	void Prefetch(const std::vector<std::string>& paths, int priority = 0);
+	bool CancelAsync(TPackRequestID id);
+	void CancelAllAsync();
+	size_t DispatchAsyncCompletions(size_t max_count = SIZE_MAX);
+
+	// pulls the stored bytes of a pack entry into memory without decompressing them
+	void PrefetchFile(std::string_view path) const;
+
+	// Loose files below directory take precedence over pack entries of the same name
+	// ("ymir work/..." maps to "d:/ymir work/..." as in PackMaker). With watch set, edits are picked up
+	// while running and reported through FetchChangedFiles. Like AddPack, call only while no reader is running.
+	bool SetOverlay(const std::string& directory, bool watch);
+	void ClearOverlay();
+	// normalized names of overlay files that changed since the last call, for the main thread to reload
+	void FetchChangedFiles(std::vector<std::string>& names);
 
 private:
+	// one per entry of every pack, sorted by hash; later packs shadow earlier ones with the same name
+	struct TPackIndexRef
+	{
+		uint64_t hash;
+		uint32_t pack;
+		uint32_t entry;
+	};
+
 	void NormalizePath(std::string_view in, std::string& out) const;
+	const TPackFileEntry* FindEntry(std::string_view normalized_path, const CPack** pack) const;
 
 private:
-	bool m_load_from_pack = true;
-	TPackFileMap m_entries;
+	std::vector<std::unique_ptr<CPack>> m_packs;
+	std::vector<TPackIndexRef> m_index;
+	CPackOverlay m_overlay;
+
+	// last, so the workers are stopped before the packs they read from go away
+	CPackLoader m_loader{ *this };
 };
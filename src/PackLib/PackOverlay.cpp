@@ -0,0 +1,298 @@
+#include "PackOverlay.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+// how long a file has to stay untouched before its change is reported
+constexpr auto OVERLAY_SETTLE_TIME = std::chrono::milliseconds(250);
+// the watcher checks for a stop request at least this often
+constexpr int OVERLAY_WATCH_TIMEOUT_MS = 200;
+
+CPackOverlay::~CPackOverlay()
+{
+	Close();
+}
+
+bool CPackOverlay::Open(const std::filesystem::path& directory, bool watch)
+{
+	Close();
+
+	std::error_code ec;
+	if (!std::filesystem::is_directory(directory, ec)) {
+		return false;
+	}
+
+	m_directory = directory;
+	Scan();
+	m_open.store(true, std::memory_order_release);
+
+	if (watch) {
+		m_watcher = std::jthread([this](std::stop_token stop) { WatchLoop(stop); });
+	}
+
+	return true;
+}
+
+void CPackOverlay::Close()
+{
+	m_open.store(false, std::memory_order_release);
+
+	if (m_watcher.joinable()) {
+		m_watcher.request_stop();
+		m_watcher.join();
+	}
+
+	std::unique_lock lock(m_mutex);
+	m_files.clear();
+	m_changed.clear();
+}
+
+bool CPackOverlay::Find(const std::string& name, std::filesystem::path& disk_path) const
+{
+	if (!m_open.load(std::memory_order_acquire)) {
+		return false;
+	}
+
+	std::shared_lock lock(m_mutex);
+	auto it = m_files.find(name);
+	if (it == m_files.end()) {
+		return false;
+	}
+
+	disk_path = it->second;
+	return true;
+}
+
+bool CPackOverlay::Contains(const std::string& name) const
+{
+	if (!m_open.load(std::memory_order_acquire)) {
+		return false;
+	}
+
+	std::shared_lock lock(m_mutex);
+	return m_files.contains(name);
+}
+
+void CPackOverlay::FetchChanged(std::vector<std::string>& names)
+{
+	names.clear();
+
+	if (!m_open.load(std::memory_order_acquire)) {
+		return;
+	}
+
+	TClock::time_point settled = TClock::now() - OVERLAY_SETTLE_TIME;
+
+	std::unique_lock lock(m_mutex);
+	for (auto it = m_changed.begin(); it != m_changed.end();) {
+		if (it->second <= settled) {
+			names.push_back(it->first);
+			it = m_changed.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void CPackOverlay::Scan()
+{
+	std::unordered_map<std::string, std::filesystem::path> files;
+
+	std::error_code ec;
+	for (auto it = std::filesystem::recursive_directory_iterator(m_directory, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+		if (!it->is_regular_file(ec)) {
+			continue;
+		}
+
+		std::string name;
+		PackEntryName(it->path().lexically_relative(m_directory).generic_string(), name);
+		files.emplace(std::move(name), it->path());
+	}
+
+	std::unique_lock lock(m_mutex);
+
+	// a rescan only learns about files that appeared or went away, report both
+	if (m_open.load(std::memory_order_relaxed)) {
+		TClock::time_point now = TClock::now();
+		for (auto& [name, disk_path] : files) {
+			if (!m_files.contains(name)) {
+				m_changed[name] = now;
+			}
+		}
+
+		for (auto& [name, disk_path] : m_files) {
+			if (!files.contains(name)) {
+				m_changed[name] = now;
+			}
+		}
+	}
+
+	m_files.swap(files);
+}
+
+void CPackOverlay::OnChanged(const std::filesystem::path& relative_path)
+{
+	std::filesystem::path disk_path = m_directory / relative_path;
+
+	std::error_code ec;
+	std::filesystem::file_status status = std::filesystem::status(disk_path, ec);
+	if (std::filesystem::is_directory(status)) {
+		Scan();
+		return;
+	}
+
+	std::string name;
+	PackEntryName(relative_path.generic_string(), name);
+
+	std::unique_lock lock(m_mutex);
+	if (std::filesystem::is_regular_file(status)) {
+		m_files[name] = disk_path;
+	}
+	else if (!m_files.erase(name)) {
+		// nothing we knew of, most likely a directory that was removed or renamed away
+		lock.unlock();
+		Scan();
+		return;
+	}
+
+	m_changed[name] = TClock::now();
+}
+
+#ifdef _WIN32
+void CPackOverlay::WatchLoop(std::stop_token stop)
+{
+	HANDLE directory = CreateFileW(m_directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+	if (directory == INVALID_HANDLE_VALUE) {
+		return;
+	}
+
+	OVERLAPPED overlapped{};
+	overlapped.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+
+	constexpr DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+	std::vector<DWORD> buffer(16 * 1024);	// FILE_NOTIFY_INFORMATION records have to be DWORD aligned
+
+	while (!stop.stop_requested()) {
+		ResetEvent(overlapped.hEvent);
+		if (!ReadDirectoryChangesW(directory, buffer.data(), (DWORD) (buffer.size() * sizeof(DWORD)), TRUE, filter, NULL, &overlapped, NULL)) {
+			break;
+		}
+
+		DWORD wait;
+		while ((wait = WaitForSingleObject(overlapped.hEvent, OVERLAY_WATCH_TIMEOUT_MS)) == WAIT_TIMEOUT && !stop.stop_requested()) {
+		}
+
+		DWORD bytes = 0;
+		if (wait != WAIT_OBJECT_0) {
+			CancelIoEx(directory, &overlapped);
+			GetOverlappedResult(directory, &overlapped, &bytes, TRUE);
+			break;
+		}
+
+		if (!GetOverlappedResult(directory, &overlapped, &bytes, FALSE)) {
+			break;
+		}
+
+		// the buffer overflowed and the individual changes are lost
+		if (bytes == 0) {
+			Scan();
+			continue;
+		}
+
+		const uint8_t* record = (const uint8_t*) buffer.data();
+		while (true) {
+			const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*) record;
+			OnChanged(std::filesystem::path(std::wstring_view(info->FileName, info->FileNameLength / sizeof(WCHAR))));
+
+			if (!info->NextEntryOffset) {
+				break;
+			}
+			record += info->NextEntryOffset;
+		}
+	}
+
+	CloseHandle(overlapped.hEvent);
+	CloseHandle(directory);
+}
+#else
+// inotify is not recursive, every directory below the overlay root needs a watch of its own
+static void AddOverlayWatches(int fd, const std::filesystem::path& root, std::unordered_map<int, std::filesystem::path>& watches)
+{
+	constexpr uint32_t mask = IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+	auto add = [&](const std::filesystem::path& directory) {
+		int wd = inotify_add_watch(fd, directory.c_str(), mask);
+		if (wd >= 0) {
+			watches[wd] = directory == root ? std::filesystem::path() : directory.lexically_relative(root);
+		}
+	};
+
+	add(root);
+
+	std::error_code ec;
+	for (auto it = std::filesystem::recursive_directory_iterator(root, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+		if (it->is_directory(ec)) {
+			add(it->path());
+		}
+	}
+}
+
+void CPackOverlay::WatchLoop(std::stop_token stop)
+{
+	int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd < 0) {
+		return;
+	}
+
+	std::unordered_map<int, std::filesystem::path> watches;	// watch descriptor -> directory relative to the root
+	AddOverlayWatches(fd, m_directory, watches);
+
+	alignas(inotify_event) char buffer[16 * 1024];
+
+	while (!stop.stop_requested()) {
+		pollfd pfd{ fd, POLLIN, 0 };
+		if (poll(&pfd, 1, OVERLAY_WATCH_TIMEOUT_MS) <= 0) {
+			continue;
+		}
+
+		ssize_t len = read(fd, buffer, sizeof(buffer));
+		for (ssize_t i = 0; i < len;) {
+			const inotify_event* event = (const inotify_event*) (buffer + i);
+			i += sizeof(inotify_event) + event->len;
+
+			if (event->mask & IN_Q_OVERFLOW) {
+				Scan();
+				continue;
+			}
+
+			if (event->mask & IN_IGNORED) {
+				watches.erase(event->wd);
+				continue;
+			}
+
+			auto directory = watches.find(event->wd);
+			if (directory == watches.end() || !event->len) {
+				continue;
+			}
+
+			// a directory appearing or going away can carry a whole tree with it
+			if (event->mask & IN_ISDIR) {
+				AddOverlayWatches(fd, m_directory, watches);
+				Scan();
+				continue;
+			}
+
+			OnChanged(directory->second / event->name);
+		}
+	}
+
+	close(fd);
+}
+#endif
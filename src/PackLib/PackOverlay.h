@@ -0,0 +1,51 @@
+#pragma once
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <filesystem>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "config.h"
+
+// Directory of loose files shadowing pack entries of the same name, so content can be iterated on
+// without repacking. The directory is scanned once on Open and from then on kept current by a watcher
+// thread (ReadDirectoryChangesW on Windows, inotify elsewhere), lookups never touch the disk.
+class CPackOverlay
+{
+public:
+	CPackOverlay() = default;
+	~CPackOverlay();
+
+	bool Open(const std::filesystem::path& directory, bool watch);
+	void Close();
+
+	// name must already be normalized, disk_path receives the loose file to read instead of the pack entry
+	bool Find(const std::string& name, std::filesystem::path& disk_path) const;
+	bool Contains(const std::string& name) const;
+
+	// Names of the files added, modified or removed since the last call. A change is only reported
+	// once the file has been left alone for a moment, editors tend to write in several steps.
+	void FetchChanged(std::vector<std::string>& names);
+
+private:
+	using TClock = std::chrono::steady_clock;
+
+	void Scan();
+	void OnChanged(const std::filesystem::path& relative_path);
+	void WatchLoop(std::stop_token stop);
+
+private:
+	std::filesystem::path m_directory;
+	std::atomic<bool> m_open = false;
+
+	mutable std::shared_mutex m_mutex;
+	std::unordered_map<std::string, std::filesystem::path> m_files;	// name -> path on disk
+	std::map<std::string, TClock::time_point> m_changed;			// name -> time of the last change
+
+	std::jthread m_watcher;
+};
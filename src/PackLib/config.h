@@ -1,10 +1,12 @@
 #pragma once
+#include <cctype>
 #include <cstdint>
 #include <array>
+#include <span>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <memory>
-#include <unordered_map>
 
 #include <gcm.h>
 #include <modes.h>
@@ -19,25 +21,85 @@ constexpr std::array<uint8_t, 32> PACK_KEY = {
 	0xFE,0xDC,0xBA,0x98, 0x76,0x54,0x32,0x10
 };
 
+enum EPackFileCompression : uint8_t
+{
+	PACK_COMPRESSION_ZSTD = 0,
+	PACK_COMPRESSION_STORED = 1,	// raw bytes, used for formats zstd can't shrink (dds, jpg, mp3, ...)
+	PACK_COMPRESSION_ZSTD_DICT = 2,	// zstd frame compressed against the pack dictionary
+	PACK_COMPRESSION_ZSTD_CHUNKED = 3,	// independently compressed fixed size chunks, see TPackChunkHeader
+};
+
+// first bytes of every pack, "MPCK"; a pack of another version is rejected as a whole, not read field by field
+constexpr uint32_t PACK_MAGIC = 'M' | ('P' << 8) | ('C' << 16) | ('K' << 24);
+constexpr uint32_t PACK_VERSION = 1;
+
 #pragma pack(push, 1)
+// Layout: header | entries[entry_num] sorted by hash | name table (encrypted) | dictionary | data
 struct TPackFileHeader
 {
+	uint32_t	magic;			// PACK_MAGIC
+	uint32_t	version;		// PACK_VERSION
 	uint64_t	entry_num;
+	uint64_t	names_size;
 	uint64_t	data_begin;
+	uint64_t	dict_offset;	// zstd dictionary shared by PACK_COMPRESSION_ZSTD_DICT entries, 0 if none
+	uint64_t	dict_size;
 	uint8_t     iv[CryptoPP::Camellia::BLOCKSIZE];
 };
+// fixed size record, looked up in place from the mapped file with a binary search on hash
 struct TPackFileEntry
 {
-	char		file_name[FILENAME_MAX+1];
+	uint64_t	hash;			// PackPathHash of the normalized file name
 	uint64_t	offset;
 	uint64_t	file_size;
 	uint64_t	compressed_size;
+	uint32_t	name_offset;	// into the name table, used to reject hash collisions
+	uint16_t	name_size;
 	uint8_t		encryption;
+	uint8_t		compression;
 	uint8_t     iv[CryptoPP::Camellia::BLOCKSIZE];
 };
+// A PACK_COMPRESSION_ZSTD_CHUNKED blob starts with this header, followed by chunk_count + 1 uint64 offsets
+// (relative to the blob start) delimiting the chunks. A chunk whose stored size equals its raw size is kept as is.
+struct TPackChunkHeader
+{
+	uint32_t	chunk_size;
+	uint32_t	chunk_count;
+};
 #pragma pack(pop)
 
-class CPack;
+// lower case with forward slashes, the form every pack name is stored and looked up in
+inline void PackNormalizePath(std::string_view in, std::string& out)
+{
+	out.resize(in.size());
+	for (std::size_t i = 0; i < out.size(); ++i) {
+		if (in[i] == '\\')
+			out[i] = '/';
+		else
+			out[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(in[i])));
+	}
+}
+
+// in-pack name of a file given its path relative to the pack's source directory,
+// "ymir work/..." content is addressed by the client as "d:/ymir work/..."
+inline void PackEntryName(std::string_view relative_path, std::string& out)
+{
+	PackNormalizePath(relative_path, out);
+	if (out.starts_with("ymir work/")) {
+		out.insert(0, "d:/");
+	}
+}
+
+// 64-bit FNV-1a over an already normalized path
+inline uint64_t PackPathHash(std::string_view normalized)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (char c : normalized) {
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
 using TPackFile = std::vector<uint8_t>;
-using TPackFileMapEntry = std::pair<std::shared_ptr<CPack>, TPackFileEntry>;
-using TPackFileMap = std::unordered_map<std::string, TPackFileMapEntry>;
\ No newline at end of file
+using TPackFileView = std::span<const uint8_t>;
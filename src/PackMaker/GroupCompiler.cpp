@@ -0,0 +1,95 @@
+#include "GroupCompiler.h"
+#include "PackLib/GroupParser.h"
+#include <set>
+#include <limits>
+#include <algorithm>
+#include <iostream>
+#include <string_view>
+#include <unordered_map>
+
+bool IsGroupExtension(const std::filesystem::path& path)
+{
+	static const std::set<std::string> group_extensions = {
+		".msm", ".msa", ".mse", ".mss", ".msf",
+	};
+
+	std::string ext = path.extension().string();
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+	return group_extensions.contains(ext);
+}
+
+bool CompileGroupFile(const std::string& file_name, const std::vector<char>& text, std::vector<char>& result)
+{
+	CGroupParser parser;
+	bool complete = parser.Parse(std::string_view(text.data(), text.size()));
+
+	for (const std::string& error : parser.errors) {
+		std::cerr << file_name << ": " << error << std::endl;
+	}
+
+	TGroupFileHeader header{};
+	memcpy(header.magic, GROUP_FILE_MAGIC, sizeof(header.magic));
+	header.version = GROUP_FILE_VERSION;
+	header.flags = complete ? static_cast<uint32_t>(GROUP_FILE_FLAG_COMPLETE) : 0u;
+
+	// identical names, keys and values are stored once
+	std::string strings;
+	std::unordered_map<std::string_view, TGroupFileString> interned;
+	auto intern = [&](std::string_view s) {
+		auto [it, inserted] = interned.try_emplace(s);
+		if (inserted) {
+			it->second.offset = (uint32_t) strings.size();
+			it->second.size = (uint32_t) s.size();
+			strings.append(s);
+			strings.push_back('\0');
+		}
+		return it->second;
+	};
+
+	// the file keeps the ranges of a node together, in the order they were parsed
+	std::vector<std::vector<const TGroupParseRange*>> node_ranges(parser.nodes.size());
+	for (const TGroupParseRange& range : parser.ranges) {
+		node_ranges[range.node].push_back(&range);
+	}
+
+	std::vector<TGroupFileNode> nodes;
+	std::vector<TGroupFileRange> ranges;
+	for (size_t i = 0; i < parser.nodes.size(); ++i) {
+		nodes.push_back(TGroupFileNode{ parser.nodes[i].parent, intern(parser.nodes[i].name), (uint32_t) ranges.size(), (uint32_t) node_ranges[i].size() });
+		for (const TGroupParseRange* range : node_ranges[i]) {
+			ranges.push_back(TGroupFileRange{ intern(range->key), range->first_token, range->token_count });
+		}
+	}
+
+	std::vector<TGroupFileToken> tokens;
+	tokens.reserve(parser.tokens.size());
+	for (std::string_view token : parser.tokens) {
+		// the client's number getters are atoi/atof on the token, evaluate them the same way
+		std::string terminated(token);
+		tokens.push_back(TGroupFileToken{ intern(token), (float) atof(terminated.c_str()), atoi(terminated.c_str()) });
+	}
+
+	if (strings.size() > std::numeric_limits<uint32_t>::max()) {
+		return false;
+	}
+
+	header.node_count = (uint32_t) nodes.size();
+	header.range_count = (uint32_t) ranges.size();
+	header.token_count = (uint32_t) tokens.size();
+	header.strings_size = (uint32_t) strings.size();
+
+	result.clear();
+	result.reserve(sizeof(header) + nodes.size() * sizeof(TGroupFileNode) + ranges.size() * sizeof(TGroupFileRange)
+		+ tokens.size() * sizeof(TGroupFileToken) + strings.size());
+
+	auto append = [&result](const void* data, size_t size) {
+		result.insert(result.end(), (const char*) data, (const char*) data + size);
+	};
+
+	append(&header, sizeof(header));
+	append(nodes.data(), nodes.size() * sizeof(TGroupFileNode));
+	append(ranges.data(), ranges.size() * sizeof(TGroupFileRange));
+	append(tokens.data(), tokens.size() * sizeof(TGroupFileToken));
+	append(strings.data(), strings.size());
+	return true;
+}
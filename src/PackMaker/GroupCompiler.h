@@ -0,0 +1,13 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include "PackLib/GroupFile.h"
+
+// files only ever read through CTextFileLoader, these can be replaced by their compiled form
+bool IsGroupExtension(const std::filesystem::path& path);
+
+// Parses text with the client's CGroupParser and writes the result as a compiled group file (see GroupFile.h).
+// Parse errors are reported and carried over like the client would see them, false means text can't be represented.
+bool CompileGroupFile(const std::string& file_name, const std::vector<char>& text, std::vector<char>& result);
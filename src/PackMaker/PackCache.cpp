@@ -0,0 +1,130 @@
+#include "PackCache.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+#include <blake2.h>
+
+std::filesystem::path CPackCache::GetManifestPath(const std::filesystem::path& pack_path)
+{
+	std::filesystem::path manifest_path = pack_path;
+	manifest_path += ".manifest";
+	return manifest_path;
+}
+
+std::string CPackCache::HashContent(const std::vector<char>& data)
+{
+	CryptoPP::BLAKE2b blake(false, 16);
+	uint8_t digest[16];
+	blake.CalculateDigest(digest, (const CryptoPP::byte*) data.data(), data.size());
+
+	static constexpr char hex[] = "0123456789abcdef";
+
+	std::string result;
+	result.reserve(sizeof(digest) * 2);
+	for (uint8_t b : digest) {
+		result.push_back(hex[b >> 4]);
+		result.push_back(hex[b & 0xF]);
+	}
+
+	return result;
+}
+
+int64_t CPackCache::GetWriteTime(const std::filesystem::path& path)
+{
+	std::error_code ec;
+	auto time = std::filesystem::last_write_time(path, ec);
+	return ec ? 0 : (int64_t) time.time_since_epoch().count();
+}
+
+bool CPackCache::WriteManifest(std::ostream& os, const std::map<std::string, TPackCacheFile>& files)
+{
+	// hash, size, write time, compiled, then the file name last since it may contain spaces
+	for (auto& [file_name, file] : files) {
+		os << file.hash << '\t' << file.file_size << '\t' << file.write_time << '\t' << file.compiled << '\t' << file_name << '\n';
+	}
+
+	return os.good();
+}
+
+bool CPackCache::Load(const std::filesystem::path& pack_path)
+{
+	std::ifstream manifest(GetManifestPath(pack_path), std::ios::binary);
+	std::ifstream pack(pack_path, std::ios::binary);
+	if (!manifest.is_open() || !pack.is_open()) {
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(manifest, line)) {
+		std::istringstream iss(line);
+
+		TPackCacheFile file;
+		std::string file_name;
+		if (!(iss >> file.hash >> file.file_size >> file.write_time >> file.compiled)) {
+			return false;
+		}
+
+		iss.ignore(1);
+		std::getline(iss, file_name);
+		m_files[file_name] = file;
+	}
+
+	// a pack of an older format is simply rebuilt in full
+	if (!pack.read((char*) &m_header, sizeof(m_header)) || m_header.magic != PACK_MAGIC || m_header.version != PACK_VERSION) {
+		return false;
+	}
+
+	std::vector<TPackFileEntry> entries(m_header.entry_num);
+	std::string names(m_header.names_size, '\0');
+	if (!pack.read((char*) entries.data(), entries.size() * sizeof(TPackFileEntry)) || !pack.read(names.data(), names.size())) {
+		return false;
+	}
+
+	CryptoPP::CTR_Mode<CryptoPP::Camellia>::Decryption decryption;
+	decryption.SetKeyWithIV(PACK_KEY.data(), PACK_KEY.size(), m_header.iv, CryptoPP::Camellia::BLOCKSIZE);
+	decryption.ProcessData((CryptoPP::byte*) names.data(), (const CryptoPP::byte*) names.data(), names.size());
+
+	for (const TPackFileEntry& entry : entries) {
+		if (names.size() < (size_t) entry.name_offset + entry.name_size) {
+			return false;
+		}
+
+		m_entries[names.substr(entry.name_offset, entry.name_size)] = entry;
+	}
+
+	if (m_header.dict_size) {
+		m_dictionary.resize(m_header.dict_size);
+		pack.seekg(m_header.dict_offset, std::ios::beg);
+		if (!pack.read(m_dictionary.data(), m_dictionary.size())) {
+			return false;
+		}
+	}
+
+	m_pack_path = pack_path;
+	return true;
+}
+
+const TPackCacheFile* CPackCache::FindFile(const std::string& file_name) const
+{
+	auto it = m_files.find(file_name);
+	return it != m_files.end() ? &it->second : nullptr;
+}
+
+const TPackFileEntry* CPackCache::FindEntry(const std::string& file_name) const
+{
+	auto it = m_entries.find(file_name);
+	return it != m_entries.end() ? &it->second : nullptr;
+}
+
+bool CPackCache::ReadBlob(const TPackFileEntry& entry, std::vector<char>& result) const
+{
+	std::ifstream pack(m_pack_path, std::ios::binary);
+	if (!pack.is_open()) {
+		return false;
+	}
+
+	result.resize(entry.compressed_size);
+	pack.seekg(m_header.data_begin + entry.offset, std::ios::beg);
+	return (bool) pack.read(result.data(), result.size());
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <filesystem>
+
+#include "PackLib/config.h"
+
+// What the previous build knew about one input file, keyed by its in-pack file name.
+struct TPackCacheFile
+{
+	std::string		hash;
+	uint64_t		file_size = 0;
+	int64_t			write_time = 0;
+	bool			compiled = false;	// stored as a compiled group file instead of the text
+};
+
+// Previous pack + manifest pair used by incremental builds. Entries whose content did not change
+// have their compressed (and encrypted) bytes copied over from the old pack instead of being recompressed.
+class CPackCache
+{
+public:
+	static std::filesystem::path GetManifestPath(const std::filesystem::path& pack_path);
+	static std::string HashContent(const std::vector<char>& data);
+	static int64_t GetWriteTime(const std::filesystem::path& path);
+
+	// the caller writes to a temporary file and swaps it in together with the pack, see GetManifestPath
+	static bool WriteManifest(std::ostream& os, const std::map<std::string, TPackCacheFile>& files);
+
+	bool Load(const std::filesystem::path& pack_path);
+
+	const TPackCacheFile* FindFile(const std::string& file_name) const;
+	const TPackFileEntry* FindEntry(const std::string& file_name) const;
+
+	// safe to call from several threads, every call opens its own stream
+	bool ReadBlob(const TPackFileEntry& entry, std::vector<char>& result) const;
+
+	const std::vector<char>& GetDictionary() const { return m_dictionary; }
+
+private:
+	std::filesystem::path m_pack_path;
+	TPackFileHeader m_header{};
+
+	std::map<std::string, TPackCacheFile> m_files;
+	std::map<std::string, TPackFileEntry> m_entries;
+	std::vector<char> m_dictionary;
+};
@@ -1,12 +1,293 @@
 #include <map>
+#include <set>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <condition_variable>
 
 #include <zstd.h>
+#include <zdict.h>
 #include <argparse.hpp>
+#include <randpool.h>
 
 #include "PackLib/config.h"
+#include "PackCache.h"
+#include "GroupCompiler.h"
+
+// formats that are already compressed, running zstd on them only costs time on both ends
+static bool IsStoredExtension(const std::filesystem::path& path)
+{
+	static const std::set<std::string> stored_extensions = {
+		".dds", ".jpg", ".jpeg", ".mp3", ".ogg", ".wav",
+	};
+
+	std::string ext = path.extension().string();
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+	return stored_extensions.contains(ext);
+}
+
+// small, similar text formats, compressed one by one they barely shrink without a shared dictionary
+static bool IsDictionaryExtension(const std::filesystem::path& path)
+{
+	static const std::set<std::string> dictionary_extensions = {
+		".msm", ".msa", ".mse", ".txt", ".prt", ".py",
+	};
+
+	std::string ext = path.extension().string();
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+	return dictionary_extensions.contains(ext);
+}
+
+// sources are shipped encrypted, so they must never end up in anything written out in the clear
+static bool IsEncryptedExtension(const std::filesystem::path& path)
+{
+	return path.has_extension() && path.extension() == ".py";
+}
+
+static bool ReadInputFile(const std::filesystem::path& path, size_t size, std::vector<char>& buffer)
+{
+	std::ifstream ifs(path, std::ios::binary);
+	if (!ifs.is_open()) {
+		std::cerr << "Failed to open input file: " << path << std::endl;
+		return false;
+	}
+
+	buffer.resize(size);
+	if (!ifs.read(buffer.data(), size)) {
+		std::cerr << "Failed to read input file: " << path << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+static bool TrainDictionary(const std::filesystem::path& input, const std::map<std::filesystem::path, TPackFileEntry>& entries, size_t dict_capacity, bool compile_groups, std::vector<char>& dictionary)
+{
+	// zstd recommends ~100x the dictionary size worth of samples, more only slows down training
+	const size_t max_samples_size = dict_capacity * 100;
+
+	std::vector<char> samples;
+	std::vector<size_t> sample_sizes;
+	std::vector<char> buffer;
+
+	for (auto& [path, entry] : entries) {
+		if (!IsDictionaryExtension(path) || entry.file_size == 0)
+			continue;
+
+		// the dictionary is stored unencrypted, trained on sources it would hand out pieces of them
+		if (IsEncryptedExtension(path))
+			continue;
+
+		// compiled group files are stored as they are, the dictionary would never see them
+		if (compile_groups && IsGroupExtension(path))
+			continue;
+
+		// a big file must not end the sampling, smaller ones further on may still fit
+		if (samples.size() + entry.file_size > max_samples_size)
+			continue;
+
+		if (!ReadInputFile(input / path, entry.file_size, buffer))
+			return false;
+
+		samples.insert(samples.end(), buffer.begin(), buffer.end());
+		sample_sizes.push_back(buffer.size());
+	}
+
+	// not enough material to learn from, these packs are simply compressed without a dictionary
+	if (sample_sizes.size() < 8) {
+		dictionary.clear();
+		return true;
+	}
+
+	dictionary.resize(dict_capacity);
+	size_t dict_size = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), samples.data(), sample_sizes.data(), (unsigned) sample_sizes.size());
+	if (ZDICT_isError(dict_size)) {
+		std::cerr << "Dictionary training skipped: " << ZDICT_getErrorName(dict_size) << std::endl;
+		dictionary.clear();
+		return true;
+	}
+
+	dictionary.resize(dict_size);
+	std::cout << "Trained " << dict_size << " byte dictionary from " << sample_sizes.size() << " files" << std::endl;
+	return true;
+}
+
+// Removes a half written pack or manifest when packing bails out, so a failed run leaves no .tmp behind
+struct TTempOutputGuard
+{
+	std::ofstream& ofs;
+	std::filesystem::path path;
+	bool keep = false;
+
+	~TTempOutputGuard()
+	{
+		if (keep)
+			return;
+
+		// the stream has to let go of the file before it can be removed on windows
+		ofs.close();
+
+		std::error_code ec;
+		std::filesystem::remove(path, ec);
+	}
+};
+
+struct TCompressSettings
+{
+	const ZSTD_CDict* cdict = nullptr;
+	uint32_t chunk_size = 0;			// 0 disables chunked entries
+	uint64_t chunk_threshold = 0;		// files at least this big are chunked
+	bool compile_groups = false;		// replace group files by their compiled form, see GroupFile.h
+};
+
+// Compresses buffer as independent chunk_size blocks behind a TPackChunkHeader and offset table,
+// so the client can decode any range without touching the rest of the file.
+static size_t CompressChunked(ZSTD_CCtx* cctx, uint32_t chunk_size, const std::vector<char>& buffer, std::vector<char>& compressed_buffer)
+{
+	TPackChunkHeader header;
+	header.chunk_size = chunk_size;
+	header.chunk_count = (uint32_t) ((buffer.size() + chunk_size - 1) / chunk_size);
+
+	size_t table_size = (size_t(header.chunk_count) + 1) * sizeof(uint64_t);
+	compressed_buffer.resize(sizeof(header) + table_size + ZSTD_compressBound(chunk_size) * header.chunk_count);
+	memcpy(compressed_buffer.data(), &header, sizeof(header));
+
+	std::vector<uint64_t> table;
+	uint64_t position = sizeof(header) + table_size;
+	for (uint32_t chunk = 0; chunk < header.chunk_count; chunk++) {
+		size_t chunk_begin = size_t(chunk) * chunk_size;
+		size_t raw_size = std::min<size_t>(chunk_size, buffer.size() - chunk_begin);
+
+		table.push_back(position);
+
+		size_t size = ZSTD_compressCCtx(cctx, compressed_buffer.data() + position, compressed_buffer.size() - position, buffer.data() + chunk_begin, raw_size, 17);
+		if (ZSTD_isError(size)) {
+			return size;
+		}
+
+		// incompressible chunk, keep it raw (the client tells by stored size == raw size)
+		if (size >= raw_size) {
+			memcpy(compressed_buffer.data() + position, buffer.data() + chunk_begin, raw_size);
+			size = raw_size;
+		}
+
+		position += size;
+	}
+
+	table.push_back(position);
+	memcpy(compressed_buffer.data() + sizeof(header), table.data(), table_size);
+	return position;
+}
+
+static bool CompressBuffer(const std::filesystem::path& input, const std::filesystem::path& path, TPackFileEntry& entry, bool store,
+	ZSTD_CCtx* cctx, const TCompressSettings& settings, const std::vector<char>& buffer, std::vector<char>& compressed_buffer)
+{
+	entry.compression = PACK_COMPRESSION_ZSTD;
+	if (!store) {
+		size_t compress_bound = ZSTD_compressBound(entry.file_size);
+		compressed_buffer.resize(compress_bound);
+
+		if (settings.cdict && IsDictionaryExtension(path)) {
+			entry.compression = PACK_COMPRESSION_ZSTD_DICT;
+			entry.compressed_size = ZSTD_compress_usingCDict(cctx, compressed_buffer.data(), compress_bound, buffer.data(), entry.file_size, settings.cdict);
+		}
+		else if (settings.chunk_size && entry.file_size >= settings.chunk_threshold) {
+			entry.compression = PACK_COMPRESSION_ZSTD_CHUNKED;
+			entry.compressed_size = CompressChunked(cctx, settings.chunk_size, buffer, compressed_buffer);
+		}
+		else {
+			entry.compressed_size = ZSTD_compressCCtx(cctx, compressed_buffer.data(), compress_bound, buffer.data(), entry.file_size, 17);
+		}
+
+		if(ZSTD_isError(entry.compressed_size)) {
+			std::cerr << "Failed to compress input file: " << (input / path) << " error: " << ZSTD_getErrorName(entry.compressed_size) << std::endl;
+			return false;
+		}
+	}
+
+	// keep the raw bytes if compression didn't help, the client can then read them in place
+	if (store || entry.compressed_size >= entry.file_size) {
+		entry.compression = PACK_COMPRESSION_STORED;
+		entry.compressed_size = entry.file_size;
+		compressed_buffer.assign(buffer.begin(), buffer.end());
+	}
+
+	compressed_buffer.resize(entry.compressed_size);
+	return true;
+}
+
+static bool ReuseCachedEntry(const CPackCache& cache, const TPackFileEntry& cached_entry, TPackFileEntry& entry, std::vector<char>& compressed_buffer)
+{
+	entry.file_size = cached_entry.file_size;
+	entry.compression = cached_entry.compression;
+	entry.compressed_size = cached_entry.compressed_size;
+	entry.encryption = cached_entry.encryption;
+	memcpy(entry.iv, cached_entry.iv, sizeof(entry.iv));
+
+	return cache.ReadBlob(cached_entry, compressed_buffer);
+}
+
+// Produces the stored bytes of a single input file, called from the worker threads. Unchanged files
+// are copied over from the previous pack when a cache is given, everything else is read and compressed.
+static bool ProcessInputFile(const std::filesystem::path& input, const std::filesystem::path& path, const std::string& file_name, TPackFileEntry& entry,
+	TPackCacheFile& file, const CPackCache* cache, ZSTD_CCtx* cctx, const TCompressSettings& settings, std::vector<char>& buffer, std::vector<char>& compressed_buffer, bool& reused)
+{
+	file.file_size = entry.file_size;
+	file.write_time = CPackCache::GetWriteTime(input / path);
+	file.compiled = settings.compile_groups && IsGroupExtension(path);
+
+	// a compiled entry differs in size from its input, it is only good for a build that compiles as well
+	const TPackCacheFile* cached_file = cache ? cache->FindFile(file_name) : nullptr;
+	const TPackFileEntry* cached_entry = cache ? cache->FindEntry(file_name) : nullptr;
+	bool has_cached = cached_file && cached_entry && cached_file->file_size == entry.file_size && cached_file->compiled == file.compiled
+		&& (file.compiled || cached_entry->file_size == entry.file_size);
+
+	// same size and write time as in the last build, trust it without reading the file
+	if (has_cached && cached_file->write_time == file.write_time) {
+		file.hash = cached_file->hash;
+		reused = true;
+		return ReuseCachedEntry(*cache, *cached_entry, entry, compressed_buffer);
+	}
+
+	if (!ReadInputFile(input / path, entry.file_size, buffer)) {
+		return false;
+	}
+
+	file.hash = CPackCache::HashContent(buffer);
+
+	// touched but not modified (e.g. checked out again)
+	if (has_cached && cached_file->hash == file.hash) {
+		reused = true;
+		return ReuseCachedEntry(*cache, *cached_entry, entry, compressed_buffer);
+	}
+
+	reused = false;
+
+	// compiled group files stay uncompressed so the client can read them straight from the mapping
+	if (file.compiled) {
+		std::vector<char> compiled;
+		if (CompileGroupFile(file_name, buffer, compiled)) {
+			buffer.swap(compiled);
+			entry.file_size = buffer.size();
+		}
+		else {
+			std::cerr << "Failed to compile group file, keeping the text: " << (input / path) << std::endl;
+			file.compiled = false;
+		}
+	}
+
+	return CompressBuffer(input, path, entry, IsStoredExtension(path) || file.compiled, cctx, settings, buffer, compressed_buffer);
+}
+
+static int64_t ElapsedMs(std::chrono::steady_clock::time_point since)
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - since).count();
+}
 
 int main(int argc, char* argv[])
 {
@@ -22,6 +303,39 @@ int main(int argc, char* argv[])
 		.default_value("")
 		.help("Output path to place newly created pack file");
 
+	program.add_argument("--dict-size")
+		.default_value(112640)
+		.scan<'i', int>()
+		.help("Maximum size of the zstd dictionary trained for text files, 0 disables it");
+
+	program.add_argument("--chunk-size")
+		.default_value(65536)
+		.scan<'i', int>()
+		.help("Block size of chunked entries, which allow reading a range without decoding the whole file, 0 disables them");
+
+	program.add_argument("--chunk-threshold")
+		.default_value(1024 * 1024)
+		.scan<'i', int>()
+		.help("Minimum file size to store a file as chunked entry");
+
+	program.add_argument("--compile-groups")
+		.default_value(false)
+		.implicit_value(true)
+		.help("Store group files (.msm, .msa, .mse, ...) pre-parsed, so the client doesn't tokenize them on load");
+
+	program.add_argument("--jobs")
+		.default_value((int) std::max(1u, std::thread::hardware_concurrency()))
+		.scan<'i', int>()
+		.help("Number of threads reading and compressing input files");
+
+	program.add_argument("--incremental")
+		.default_value(false)
+		.implicit_value(true)
+		.help("Reuse the compressed bytes of unchanged files from the existing pack and its manifest");
+
+	program.add_argument("--seed")
+		.help("Fixed seed for the pack IVs, the same input and seed always produce the same pack");
+
 	try {
 		program.parse_args(argc, argv);
 	}
@@ -41,13 +355,31 @@ int main(int argc, char* argv[])
 
 	output /= input.filename().replace_extension(".pck");
 
-	std::ofstream ofs(output, std::ios::binary);
+	// the previous pack may be read while the new one is written, so build next to it and swap at the end
+	std::filesystem::path temp_output = output;
+	temp_output += ".tmp";
+
+	std::ofstream ofs(temp_output, std::ios::binary);
 	if (!ofs.is_open()) {
-		std::cerr << "Failed to open output file: " << output << std::endl;
+		std::cerr << "Failed to open output file: " << temp_output << std::endl;
 		return EXIT_FAILURE;
 	}
 
+	TTempOutputGuard temp_output_guard{ ofs, temp_output };
+
+	std::unique_ptr<CPackCache> cache;
+	if (program.get<bool>("--incremental")) {
+		cache = std::make_unique<CPackCache>();
+		if (!cache->Load(output)) {
+			std::cout << "No usable previous pack/manifest for " << output << ", doing a full build" << std::endl;
+			cache.reset();
+		}
+	}
+
+	auto total_start = std::chrono::steady_clock::now();
+
 	std::map<std::filesystem::path, TPackFileEntry> entries;
+	std::map<std::filesystem::path, std::string> file_names;
 
 	for (auto entry : std::filesystem::recursive_directory_iterator(input)) {
 		if (!entry.is_regular_file())
@@ -59,78 +391,275 @@ int main(int argc, char* argv[])
 		memset(&file_entry, 0, sizeof(file_entry));
 		file_entry.file_size = entry.file_size();
 
-		constexpr std::string_view ymir_work_prefix = "ymir work/";
-		std::string rp_str = relative_path.generic_string();
-		if (rp_str.compare(0, ymir_work_prefix.size(), ymir_work_prefix) == 0) {
-			rp_str = (std::filesystem::path("d:/ymir work/") / rp_str.substr(ymir_work_prefix.size())).generic_string();
-		}
+		PackEntryName(relative_path.generic_string(), file_names[relative_path]);
+	}
 
-		rp_str.copy(file_entry.file_name, sizeof(file_entry.file_name) - 1);
+	// names live in a separate table, the fixed size records only point into it
+	std::string name_table;
+	for (auto& [path, entry] : entries) {
+		const std::string& file_name = file_names[path];
+		entry.hash = PackPathHash(file_name);
+		entry.name_offset = (uint32_t) name_table.size();
+		entry.name_size = (uint16_t) file_name.size();
+		name_table += file_name;
+	}
+
+	int64_t scan_ms = ElapsedMs(total_start);
+	auto dict_start = std::chrono::steady_clock::now();
+
+	// an incremental build keeps the previous dictionary, otherwise the reused entries couldn't be decoded
+	std::vector<char> dictionary;
+	int dict_capacity = program.get<int>("--dict-size");
+	if (cache) {
+		dictionary = cache->GetDictionary();
+	}
+	else if (dict_capacity > 0 && !TrainDictionary(input, entries, dict_capacity, program.get<bool>("--compile-groups"), dictionary)) {
+		return EXIT_FAILURE;
 	}
 
+	int64_t dict_ms = ElapsedMs(dict_start);
+
 	TPackFileHeader header;
 	memset(&header, 0, sizeof(header));
+	header.magic = PACK_MAGIC;
+	header.version = PACK_VERSION;
 	header.entry_num = entries.size();
-	header.data_begin = sizeof(TPackFileHeader) + sizeof(TPackFileEntry) * entries.size();
+	header.names_size = name_table.size();
+	header.dict_offset = dictionary.empty() ? 0 : sizeof(TPackFileHeader) + sizeof(TPackFileEntry) * entries.size() + name_table.size();
+	header.dict_size = dictionary.size();
+	header.data_begin = sizeof(TPackFileHeader) + sizeof(TPackFileEntry) * entries.size() + name_table.size() + dictionary.size();
+
+	std::unique_ptr<ZSTD_CDict, decltype(&ZSTD_freeCDict)> cdict(nullptr, &ZSTD_freeCDict);
+	if (!dictionary.empty()) {
+		cdict.reset(ZSTD_createCDict(dictionary.data(), dictionary.size(), 17));
+	}
 
-	CryptoPP::AutoSeededRandomPool rnd;
-	rnd.GenerateBlock(header.iv, sizeof(header.iv));
+	TCompressSettings settings;
+	settings.cdict = cdict.get();
+	settings.chunk_size = (uint32_t) std::max(0, program.get<int>("--chunk-size"));
+	settings.chunk_threshold = (uint64_t) std::max(0, program.get<int>("--chunk-threshold"));
+	settings.compile_groups = program.get<bool>("--compile-groups");
+
+	std::unique_ptr<CryptoPP::RandomNumberGenerator> rnd;
+	if (auto seed = program.present<std::string>("--seed")) {
+		auto pool = std::make_unique<CryptoPP::OldRandomPool>();
+		pool->IncorporateEntropy((const CryptoPP::byte*) seed->data(), seed->size());
+		rnd = std::move(pool);
+	}
+	else {
+		rnd = std::make_unique<CryptoPP::AutoSeededRandomPool>();
+	}
+
+	rnd->GenerateBlock(header.iv, sizeof(header.iv));
 
 	ofs.write((const char*) &header, sizeof(header));
+
+	if (!dictionary.empty()) {
+		ofs.seekp(header.dict_offset, std::ios::beg);
+		ofs.write(dictionary.data(), dictionary.size());
+	}
+
 	ofs.seekp(header.data_begin, std::ios::beg);
 
 	CryptoPP::CTR_Mode<CryptoPP::Camellia>::Encryption encryption;
 	encryption.SetKeyWithIV(PACK_KEY.data(), PACK_KEY.size(), header.iv, CryptoPP::Camellia::BLOCKSIZE);
 
-	uint64_t offset = 0;
-	for (auto& [path, entry] : entries) {
-		std::ifstream ifs(input / path, std::ios::binary);
-		if (!ifs.is_open()) {
-			std::cerr << "Failed to open input file: " << (input / path) << std::endl;
-			return EXIT_FAILURE;
-		}
+	// Workers read and compress files in parallel, the writer below takes the results strictly in
+	// entry order, so offsets, IVs and encryption come out exactly as in a single threaded run.
+	// Workers may only run a bounded window ahead of the writer to cap memory use.
+	struct TCompressResult
+	{
+		std::vector<char> data;
+		bool ready = false;
+		bool failed = false;
+		bool reused = false;
+	};
+
+	auto pack_start = std::chrono::steady_clock::now();
+
+	std::vector<std::pair<const std::filesystem::path, TPackFileEntry>*> jobs;
+	std::vector<const std::string*> job_names;
+	for (auto& it : entries) {
+		jobs.push_back(&it);
+		job_names.push_back(&file_names[it.first]);
+	}
+
+	const size_t job_threads = std::max(1, program.get<int>("--jobs"));
+	const size_t window = job_threads * 4;
+
+	std::vector<TCompressResult> results(jobs.size());
+	std::vector<TPackCacheFile> job_files(jobs.size());
+	std::mutex mutex;
+	std::condition_variable cv;
+	size_t next_job = 0, written = 0;
+	bool abort = false;
+	std::atomic<int64_t> worker_busy_ms = 0;
 
-		static std::vector<char> buffer;
-		buffer.resize(entry.file_size);
+	auto worker = [&]() {
+		std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+		std::vector<char> buffer;
 
-		if (!ifs.read(buffer.data(), entry.file_size)) {
-			std::cerr << "Failed to read input file: " << (input / path) << std::endl;
-			return EXIT_FAILURE;
+		while (true) {
+			size_t index;
+			{
+				std::unique_lock lock(mutex);
+				cv.wait(lock, [&]() { return abort || next_job >= jobs.size() || next_job < written + window; });
+				if (abort || next_job >= jobs.size())
+					break;
+
+				index = next_job++;
+			}
+
+			auto job_start = std::chrono::steady_clock::now();
+
+			auto& [path, entry] = *jobs[index];
+			std::vector<char> compressed;
+			bool reused = false;
+			bool ok = ProcessInputFile(input, path, *job_names[index], entry, job_files[index], cache.get(), cctx.get(), settings, buffer, compressed, reused);
+
+			worker_busy_ms += ElapsedMs(job_start);
+
+			{
+				std::lock_guard lock(mutex);
+				results[index].data = std::move(compressed);
+				results[index].failed = !ok;
+				results[index].reused = reused;
+				results[index].ready = true;
+			}
+			cv.notify_all();
 		}
+	};
 
-		size_t compress_bound = ZSTD_compressBound(entry.file_size);
-		static std::vector<char> compressed_buffer;
-		compressed_buffer.resize(compress_bound);
+	// declared after the sync objects so the threads are joined before those go away
+	std::vector<std::jthread> workers;
+	for (size_t i = 0; i < job_threads; ++i) {
+		workers.emplace_back(worker);
+	}
 
-		entry.compressed_size = ZSTD_compress(compressed_buffer.data(), compress_bound, buffer.data(), entry.file_size, 17);
-		if(ZSTD_isError(entry.compressed_size)) {
-			std::cerr << "Failed to compress input file: " << (input / path) << " error: " << ZSTD_getErrorName(entry.compressed_size) << std::endl;
-			return EXIT_FAILURE;
+	int64_t writer_wait_ms = 0;
+	uint64_t offset = 0, total_size = 0;
+	size_t reused_count = 0;
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		auto& [path, entry] = *jobs[i];
+		std::vector<char> compressed_buffer;
+		bool reused;
+
+		{
+			auto wait_start = std::chrono::steady_clock::now();
+
+			std::unique_lock lock(mutex);
+			cv.wait(lock, [&]() { return results[i].ready; });
+
+			writer_wait_ms += ElapsedMs(wait_start);
+
+			if (results[i].failed) {
+				abort = true;
+				lock.unlock();
+				cv.notify_all();
+				return EXIT_FAILURE;
+			}
+
+			compressed_buffer = std::move(results[i].data);
+			reused = results[i].reused;
+			++written;
 		}
+		cv.notify_all();
 
 		entry.offset = offset;
 
-		entry.encryption = 0;
-		if (path.has_extension() && path.extension() == ".py") {
+		// reused bytes come already encrypted with the IV taken over from the previous pack
+		if (reused) {
+			++reused_count;
+		}
+		else if (IsEncryptedExtension(path)) {
 			entry.encryption = 1;
 
-			rnd.GenerateBlock(entry.iv, sizeof(entry.iv));
+			rnd->GenerateBlock(entry.iv, sizeof(entry.iv));
 			encryption.Resynchronize(entry.iv, sizeof(entry.iv));
 			encryption.ProcessData((uint8_t*)compressed_buffer.data(), (uint8_t*)compressed_buffer.data(), entry.compressed_size);
 		}
 
 		ofs.write(compressed_buffer.data(), entry.compressed_size);
 		offset += entry.compressed_size;
+		total_size += entry.file_size;
 	}
 
+	workers.clear();
+
+	int64_t pack_ms = ElapsedMs(pack_start);
+
+	// the client binary searches the records in place, so they go out ordered by hash
+	std::vector<TPackFileEntry> index;
+	for (auto& [path, entry] : entries) {
+		index.push_back(entry);
+	}
+
+	std::stable_sort(index.begin(), index.end(), [](const TPackFileEntry& a, const TPackFileEntry& b) {
+		return a.hash < b.hash;
+	});
+
 	ofs.seekp(sizeof(TPackFileHeader), std::ios::beg);
+	ofs.write((const char*)index.data(), index.size() * sizeof(TPackFileEntry));
+
 	encryption.Resynchronize(header.iv, sizeof(header.iv));
-	
-	for (auto& [path, entry] : entries) {
-		TPackFileEntry tmp = entry;
-		encryption.ProcessData((uint8_t*)&tmp, (uint8_t*)&tmp, sizeof(TPackFileEntry));
-		ofs.write((const char*)&tmp, sizeof(TPackFileEntry));
+	encryption.ProcessData((uint8_t*)name_table.data(), (const uint8_t*)name_table.data(), name_table.size());
+	ofs.write(name_table.data(), name_table.size());
+
+	ofs.close();
+	if (!ofs) {
+		std::cerr << "Failed to write output file: " << temp_output << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::map<std::string, TPackCacheFile> manifest;
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		manifest[*job_names[i]] = job_files[i];
+	}
+
+	// the manifest is written before anything is replaced, a run that fails here keeps the old pack and manifest
+	std::filesystem::path manifest_output = CPackCache::GetManifestPath(output);
+	std::filesystem::path temp_manifest_output = manifest_output;
+	temp_manifest_output += ".tmp";
+
+	std::ofstream manifest_ofs(temp_manifest_output, std::ios::binary);
+	TTempOutputGuard temp_manifest_output_guard{ manifest_ofs, temp_manifest_output };
+
+	if (!manifest_ofs.is_open() || !CPackCache::WriteManifest(manifest_ofs, manifest) || (manifest_ofs.close(), !manifest_ofs)) {
+		std::cerr << "Failed to write manifest: " << temp_manifest_output << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// without a manifest the next incremental run rebuilds in full, so the old one must never outlive its pack
+	std::error_code ec;
+	std::filesystem::remove(manifest_output, ec);
+	if (ec) {
+		std::cerr << "Failed to remove old manifest: " << manifest_output << " error: " << ec.message() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::filesystem::rename(temp_output, output, ec);
+	if (ec) {
+		std::cerr << "Failed to replace output file: " << output << " error: " << ec.message() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	temp_output_guard.keep = true;
+
+	std::filesystem::rename(temp_manifest_output, manifest_output, ec);
+	if (ec) {
+		std::cerr << "Failed to replace manifest: " << manifest_output << " error: " << ec.message() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	temp_manifest_output_guard.keep = true;
+
+	std::cout << "Packed " << entries.size() << " files: " << total_size << " -> " << offset << " bytes of data" << std::endl;
+	if (cache) {
+		std::cout << "Reused " << reused_count << " unchanged files from the previous pack" << std::endl;
 	}
 
+	std::cout << "Timings: scan " << scan_ms << " ms, dictionary " << dict_ms << " ms, pack " << pack_ms << " ms"
+		<< " (" << job_threads << " jobs, workers busy " << worker_busy_ms << " ms, writer waited " << writer_wait_ms << " ms)"
+		<< ", total " << ElapsedMs(total_start) << " ms" << std::endl;
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,112 @@
+#include <vector>
+#include <chrono>
+#include <string>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <argparse.hpp>
+
+#include "PackLib/PackManager.h"
+
+// Measures what the client pays at startup for its packs: the time CPackManager::AddPack takes for each of them,
+// the resident memory the process grows by while they're added, and then the time of an IsExist for every
+// entry of every pack, which is the lookup the loaders do most.
+
+static size_t GetResidentBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters{};
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	return counters.WorkingSetSize;
+#else
+	size_t total_pages = 0, resident_pages = 0;
+	std::ifstream statm("/proc/self/statm");
+	statm >> total_pages >> resident_pages;
+	return resident_pages * (size_t) sysconf(_SC_PAGESIZE);
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+	argparse::ArgumentParser program("PackStartupBench");
+
+	program.add_argument("--pack")
+		.required()
+		.nargs(argparse::nargs_pattern::at_least_one)
+		.help("Pack files, added in the given order as the client does");
+
+	program.add_argument("--rounds")
+		.default_value(5)
+		.scan<'i', int>()
+		.help("Times every entry name is looked up, the best round counts");
+
+	try {
+		program.parse_args(argc, argv);
+	}
+	catch (const std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+		std::cerr << program;
+		std::exit(EXIT_FAILURE);
+	}
+
+	std::vector<std::string> pack_paths = program.get<std::vector<std::string>>("--pack");
+
+	// the names are read up front, so collecting them doesn't count towards the pack manager's memory
+	std::vector<std::string> names;
+	for (const std::string& path : pack_paths) {
+		CPack pack;
+		if (!pack.Open(path)) {
+			std::cerr << "Failed to open pack: " << path << ": " << pack.GetError() << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		for (size_t i = 0; i < pack.GetEntryCount(); ++i) {
+			names.emplace_back(pack.GetEntryName(pack.GetEntry(i)));
+		}
+	}
+
+	CPackManager manager;
+
+	size_t resident_before = GetResidentBytes();
+	auto add_start = std::chrono::steady_clock::now();
+
+	for (const std::string& path : pack_paths) {
+		std::string error;
+		if (!manager.AddPack(path, &error)) {
+			std::cerr << "Failed to add pack: " << path << ": " << error << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	double add_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - add_start).count();
+	size_t resident_after = GetResidentBytes();
+
+	double best_lookup_ms = 0.0;
+	size_t missing = 0;
+	for (int round = 0, rounds = std::max(1, program.get<int>("--rounds")); round < rounds; ++round) {
+		auto lookup_start = std::chrono::steady_clock::now();
+
+		missing = 0;
+		for (const std::string& name : names) {
+			if (!manager.IsExist(name))
+				++missing;
+		}
+
+		double lookup_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - lookup_start).count();
+		if (round == 0 || lookup_ms < best_lookup_ms)
+			best_lookup_ms = lookup_ms;
+	}
+
+	std::cout << pack_paths.size() << " packs, " << names.size() << " entries" << std::endl;
+	std::cout << "AddPack " << add_ms << " ms, +" << (resident_after - (std::min)(resident_before, resident_after)) / 1048576.0 << " MB resident" << std::endl;
+	std::cout << names.size() << " IsExist " << best_lookup_ms << " ms, " << missing << " not found" << std::endl;
+
+	return missing == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
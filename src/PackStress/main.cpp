@@ -0,0 +1,128 @@
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <argparse.hpp>
+
+#include "PackLib/Pack.h"
+
+// Reads one mapped pack from many threads at once and checks every GetFile and ReadRange result against
+// what a single thread decoded beforehand. CPack promises that a const pack can be read from any number of
+// threads, this is what catches a decoder context or buffer shared between them.
+
+// splitmix64, every thread walks the entries in its own order
+static uint64_t NextRandom(uint64_t& state)
+{
+	uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+int main(int argc, char* argv[])
+{
+	argparse::ArgumentParser program("PackStress");
+
+	program.add_argument("--pack")
+		.required()
+		.help("Pack file to read");
+
+	program.add_argument("--threads")
+		.default_value((int) std::max(2u, std::thread::hardware_concurrency()))
+		.scan<'i', int>()
+		.help("Number of threads reading at the same time");
+
+	program.add_argument("--reads")
+		.default_value(20000)
+		.scan<'i', int>()
+		.help("Reads per thread, a third of them are ranges");
+
+	try {
+		program.parse_args(argc, argv);
+	}
+	catch (const std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+		std::cerr << program;
+		std::exit(EXIT_FAILURE);
+	}
+
+	std::string pack_path = program.get<std::string>("--pack");
+
+	CPack pack;
+	if (!pack.Open(pack_path)) {
+		std::cerr << "Failed to open pack: " << pack_path << ": " << pack.GetError() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (pack.GetEntryCount() == 0) {
+		std::cerr << "Pack has no entries: " << pack_path << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<TPackFile> reference(pack.GetEntryCount());
+	uint64_t total_size = 0;
+	for (size_t i = 0; i < pack.GetEntryCount(); ++i) {
+		if (!pack.GetFile(pack.GetEntry(i), reference[i])) {
+			std::cerr << "Failed to read entry: " << pack.GetEntryName(pack.GetEntry(i)) << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		total_size += reference[i].size();
+	}
+
+	int thread_count = std::max(1, program.get<int>("--threads"));
+	int read_count = std::max(1, program.get<int>("--reads"));
+
+	std::cout << "Reading " << pack.GetEntryCount() << " entries (" << total_size << " bytes) from " << thread_count << " threads" << std::endl;
+
+	std::atomic<uint64_t> failed_count = 0, read_bytes = 0;
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < thread_count; ++t) {
+		threads.emplace_back([&, t]() {
+			uint64_t random = t + 1;
+			uint64_t bytes = 0;
+			TPackFile result;
+
+			for (int n = 0; n < read_count; ++n) {
+				size_t index = NextRandom(random) % reference.size();
+				const TPackFileEntry& entry = pack.GetEntry(index);
+				const TPackFile& expected = reference[index];
+
+				bool ok;
+				if (n % 3 == 2) {
+					uint64_t offset = NextRandom(random) % (expected.size() + 1);
+					uint64_t size = NextRandom(random) % (expected.size() - offset + 1);
+
+					ok = pack.ReadRange(entry, offset, size, result) && result.size() == size
+						&& (size == 0 || memcmp(result.data(), expected.data() + offset, size) == 0);
+				}
+				else {
+					ok = pack.GetFile(entry, result) && result == expected;
+				}
+
+				if (!ok && failed_count++ < 10) {
+					std::cerr << "Mismatch on thread " << t << ": " << pack.GetEntryName(entry) << std::endl;
+				}
+
+				bytes += result.size();
+			}
+
+			read_bytes += bytes;
+		});
+	}
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Read " << read_bytes << " bytes in " << seconds << " s (" << (read_bytes / 1048576.0 / seconds) << " MB/s), "
+		<< failed_count << " mismatches" << std::endl;
+
+	return failed_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,199 @@
+#include <windows.h>
+
+#include <map>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <argparse.hpp>
+
+#include "EterBase/CRC32.h"
+#include "EterLib/ResourceNameMap.h"
+
+// Looks up generated resource paths the way CResourceManager::GetResourcePointer did before CResourceNameMap
+// (normalize a copy of the name into a static buffer, CRC32 it, find it in a std::map) and the way it does now,
+// and prints the best ns per lookup of each, once for mixed case paths with '/' like the scripts pass them and
+// once for names that are normalized already like CResource::GetFileName returns them. Before that, random
+// inserts and erases are run against a std::map of the normalized names and every lookup has to agree with it.
+
+// CResourceManager::__GetFileCRC as it was
+static DWORD GetOldFileCRC(const char * c_szFileName)
+{
+	static char s_szFullPathFileName[MAX_PATH];
+	const char * src = c_szFileName;
+	char * dst = s_szFullPathFileName;
+	int	len = 0;
+
+	while (src[len])
+	{
+		if (src[len]=='/')
+			dst[len] = '\\';
+		else
+			dst[len] = (char) korean_tolower(src[len]);
+
+		++len;
+	}
+
+	dst[len] = '\0';
+
+	return (GetCRC32(s_szFullPathFileName, len));
+}
+
+static std::string Normalize(const std::string& name)
+{
+	std::string normalized;
+	for (char c : name)
+		normalized += CResourceNameMap<size_t>::NormalizeChar(c);
+
+	return normalized;
+}
+
+static bool CheckAgainstMap(const std::vector<std::string>& names, std::mt19937& rng, int operations)
+{
+	CResourceNameMap<size_t> name_map;
+	std::map<std::string, size_t> reference;
+
+	for (int i = 0; i < operations; ++i) {
+		const std::string& name = names[rng() % names.size()];
+		std::string normalized = Normalize(name);
+		uint64_t hash = CResourceNameMap<size_t>::Hash(name.c_str());
+
+		if (rng() % 2) {
+			if (name_map.Erase(hash, name.c_str()) != (reference.erase(normalized) != 0))
+				return false;
+		}
+		else {
+			name_map.Insert(hash, normalized, i);
+			reference.emplace(normalized, i);
+		}
+	}
+
+	for (const std::string& name : names) {
+		const size_t* value = name_map.Find(CResourceNameMap<size_t>::Hash(name.c_str()), name.c_str());
+		auto it = reference.find(Normalize(name));
+
+		if ((value != nullptr) != (it != reference.end()))
+			return false;
+
+		if (value && *value != it->second)
+			return false;
+	}
+
+	return name_map.Size() == reference.size();
+}
+
+template <typename TLookup>
+static double MeasureBest(int rounds, TLookup lookup)
+{
+	double best_ns = 0.0;
+
+	for (int round = 0; round < rounds; ++round) {
+		auto start = std::chrono::steady_clock::now();
+		lookup();
+
+		double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		if (round == 0 || ns < best_ns)
+			best_ns = ns;
+	}
+
+	return best_ns;
+}
+
+int main(int argc, char* argv[])
+{
+	argparse::ArgumentParser program("ResourceNameBench");
+
+	program.add_argument("--names")
+		.default_value(20000)
+		.scan<'i', int>()
+		.help("Number of distinct resource paths");
+
+	program.add_argument("--lookups")
+		.default_value(2000000)
+		.scan<'i', int>()
+		.help("Number of lookups per round, all of them hits");
+
+	program.add_argument("--rounds")
+		.default_value(5)
+		.scan<'i', int>()
+		.help("Times the lookups are repeated, the best round counts");
+
+	program.add_argument("--seed")
+		.default_value(1)
+		.scan<'i', int>()
+		.help("Seed of the insert and erase check and of the lookup order");
+
+	try {
+		program.parse_args(argc, argv);
+	}
+	catch (const std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+		std::cerr << program;
+		std::exit(EXIT_FAILURE);
+	}
+
+	int name_count = std::max(1, program.get<int>("--names"));
+	int lookup_count = std::max(1, program.get<int>("--lookups"));
+	int rounds = std::max(1, program.get<int>("--rounds"));
+	std::mt19937 rng(program.get<int>("--seed"));
+
+	static const char* directories[] = {
+		"d:/ymir work/pc/warrior/",
+		"d:/ymir work/monster/",
+		"d:/ymir work/effect/hit/",
+		"d:/ymir work/ui/game/",
+	};
+
+	std::vector<std::string> names;
+	std::vector<std::string> normalized_names;
+	for (int i = 0; i < name_count; ++i) {
+		char name[MAX_PATH];
+		snprintf(name, sizeof(name), "%s%s_%05d.%s", directories[i % 4], i % 3 ? "Texture" : "model", i, i % 2 ? "dds" : "gr2");
+
+		names.emplace_back(name);
+		normalized_names.emplace_back(Normalize(name));
+	}
+
+	if (!CheckAgainstMap(names, rng, name_count * 10)) {
+		std::cerr << "CResourceNameMap disagrees with std::map" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::map<DWORD, size_t> old_map;
+	CResourceNameMap<size_t> name_map;
+	for (size_t i = 0; i < normalized_names.size(); ++i) {
+		old_map[GetOldFileCRC(names[i].c_str())] = i;
+		name_map.Insert(CResourceNameMap<size_t>::Hash(normalized_names[i].c_str()), normalized_names[i], i);
+	}
+
+	for (const std::vector<std::string>* lookup_names : { &names, &normalized_names }) {
+		std::vector<const char*> order(lookup_count);
+		for (const char*& name : order)
+			name = (*lookup_names)[rng() % lookup_names->size()].c_str();
+
+		size_t old_sum = 0, new_sum = 0;
+
+		double old_ns = MeasureBest(rounds, [&]() {
+			for (const char* name : order)
+				old_sum += old_map.find(GetOldFileCRC(name))->second;
+		});
+
+		double new_ns = MeasureBest(rounds, [&]() {
+			for (const char* name : order)
+				new_sum += *name_map.Find(CResourceNameMap<size_t>::Hash(name), name);
+		});
+
+		if (old_sum != new_sum) {
+			std::cerr << "the lookups found different resources" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		printf("%-10s std::map %.1f ns, CResourceNameMap %.1f ns per lookup\n",
+			lookup_names == &names ? "mixed" : "normalized", old_ns / order.size(), new_ns / order.size());
+	}
+
+	return EXIT_SUCCESS;
+}
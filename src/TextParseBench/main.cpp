@@ -0,0 +1,253 @@
+#include "EterLib/StdAfx.h"
+#include "EterLib/TextFileLoader.h"
+#include "PackLib/PackManager.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+#include <argparse.hpp>
+
+// Loads every group file of the given packs through CTextFileLoader and asks it for the keys the motion, effect
+// and model loaders read, then binds every other file to a CMemoryTextFileLoader and splits all its lines by tab,
+// once into a CTokenVector and once into a CTokenViewVector. Prints the best ms per pass and the allocations per
+// pass of each, counted by the operator new below. A checksum of everything read keeps the queries from being
+// dropped and shows that two builds parsed the same thing.
+
+static std::atomic<size_t> s_allocations = 0;
+
+void* operator new(size_t size)
+{
+	++s_allocations;
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	std::free(p);
+}
+
+// the extensions PackMaker --compile-groups stores pre-parsed, the rest are read line by line
+static bool IsGroupName(const std::string& name)
+{
+	static const char* group_extensions[] = { ".msm", ".msa", ".mse", ".mss", ".msf" };
+
+	for (const char* ext : group_extensions) {
+		size_t len = std::strlen(ext);
+		if (name.size() >= len && name.compare(name.size() - len, len, ext) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+struct TChecksum
+{
+	double sum = 0.0;
+	size_t length = 0;
+};
+
+static void QueryGroup(CTextFileLoader& loader, TChecksum& checksum)
+{
+	float value;
+	int integer;
+	D3DXVECTOR3 vector3;
+	D3DXCOLOR color;
+	std::string string;
+	CTokenVector* tokens;
+
+	for (const char* key : { "motionduration", "starttime", "startingtime", "cyclelength", "radius", "rotationspeed", "preinputtime", "boundingsphereradius" }) {
+		if (loader.GetTokenFloat(key, &value))
+			checksum.sum += value;
+	}
+
+	for (const char* key : { "accumulation", "effectposition", "position", "emittingdirection", "boundingsphereposition" }) {
+		if (loader.GetTokenVector3(key, &vector3))
+			checksum.sum += vector3.x + vector3.y + vector3.z;
+	}
+
+	for (const char* key : { "motionfilename", "effectfilename", "model", "sourceskin", "basemodelfilename", "attachingbonename" }) {
+		if (loader.GetTokenString(key, &string))
+			checksum.length += string.size();
+	}
+
+	for (const char* key : { "motioneventtype", "maxemissioncount", "shapeindex", "shapedatacount" }) {
+		if (loader.GetTokenInteger(key, &integer))
+			checksum.sum += integer;
+	}
+
+	if (loader.GetTokenColor("color", &color))
+		checksum.sum += color.r + color.a;
+
+	for (const char* key : { "timeeventposition", "timeeventemittingsize", "texturefiles" }) {
+		if (loader.GetTokenVector(key, &tokens)) {
+			for (const std::string& token : *tokens)
+				checksum.length += token.size();
+		}
+	}
+
+	for (DWORD i = 0; i < loader.GetChildNodeCount(); ++i) {
+		CTextFileLoader::CGotoChild child(&loader, i);
+		QueryGroup(loader, checksum);
+	}
+}
+
+template <typename TTokens>
+static void SplitLines(const std::vector<TPackFile>& files, TChecksum& checksum)
+{
+	CMemoryTextFileLoader loader;
+	TTokens tokens;
+
+	for (const TPackFile& file : files) {
+		loader.Bind(file.size(), file.data());
+
+		for (DWORD i = 0; i < loader.GetLineCount(); ++i) {
+			if (!loader.SplitLine(i, &tokens, "\t"))
+				continue;
+
+			for (const auto& token : tokens)
+				checksum.length += token.size();
+		}
+	}
+}
+
+struct TResult
+{
+	double best_ms = 0.0;
+	size_t allocations = 0;
+	TChecksum checksum;
+};
+
+template <typename TPass>
+static TResult Measure(int rounds, TPass pass)
+{
+	TResult result;
+
+	for (int round = 0; round < rounds; ++round) {
+		TChecksum checksum;
+		size_t allocations = s_allocations;
+		auto start = std::chrono::steady_clock::now();
+
+		pass(checksum);
+
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (round == 0 || ms < result.best_ms)
+			result.best_ms = ms;
+
+		result.allocations = s_allocations - allocations;
+		result.checksum = checksum;
+	}
+
+	return result;
+}
+
+static void Print(const char* label, size_t files, const TResult& result)
+{
+	std::printf("%-24s %6zu files %9.3f ms/pass %9zu allocations/pass checksum %.3f %zu\n",
+		label, files, result.best_ms, result.allocations, result.checksum.sum, result.checksum.length);
+}
+
+int main(int argc, char* argv[])
+{
+	argparse::ArgumentParser program("TextParseBench");
+
+	program.add_argument("--pack")
+		.required()
+		.nargs(argparse::nargs_pattern::at_least_one)
+		.help("Pack files whose group and text files are parsed");
+
+	program.add_argument("--rounds")
+		.default_value(10)
+		.scan<'i', int>()
+		.help("Times every file is parsed, the best round counts");
+
+	try {
+		program.parse_args(argc, argv);
+	}
+	catch (const std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+		std::cerr << program;
+		std::exit(EXIT_FAILURE);
+	}
+
+	std::vector<std::string> pack_paths = program.get<std::vector<std::string>>("--pack");
+	int rounds = std::max(1, program.get<int>("--rounds"));
+
+	// CTextFileLoader::Load reads through the pack manager singleton
+	CPackManager manager;
+
+	std::vector<std::string> group_names;
+	std::vector<std::string> line_names;
+	for (const std::string& path : pack_paths) {
+		CPack pack;
+		if (!pack.Open(path)) {
+			std::cerr << "Failed to open pack: " << path << ": " << pack.GetError() << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		for (size_t i = 0; i < pack.GetEntryCount(); ++i) {
+			std::string name(pack.GetEntryName(pack.GetEntry(i)));
+			(IsGroupName(name) ? group_names : line_names).push_back(std::move(name));
+		}
+
+		std::string error;
+		if (!manager.AddPack(path, &error)) {
+			std::cerr << "Failed to add pack: " << path << ": " << error << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::sort(group_names.begin(), group_names.end());
+	std::sort(line_names.begin(), line_names.end());
+
+	// reading and decompressing alone, the part of the group pass that isn't parsing
+	TResult read = Measure(rounds, [&](TChecksum& checksum) {
+		for (const std::string& name : group_names) {
+			TPackFile file;
+			if (manager.GetFile(name, file))
+				checksum.length += file.size();
+		}
+	});
+
+	TResult group = Measure(rounds, [&](TChecksum& checksum) {
+		for (const std::string& name : group_names) {
+			CTextFileLoader loader;
+			if (loader.Load(name.c_str()))
+				QueryGroup(loader, checksum);
+		}
+	});
+
+	// the line files are read once, only binding and splitting is measured
+	std::vector<TPackFile> line_files(line_names.size());
+	for (size_t i = 0; i < line_names.size(); ++i)
+		manager.GetFile(line_names[i], line_files[i]);
+
+	TResult split = Measure(rounds, [&](TChecksum& checksum) {
+		SplitLines<CTokenVector>(line_files, checksum);
+	});
+
+	TResult split_views = Measure(rounds, [&](TChecksum& checksum) {
+		SplitLines<CTokenViewVector>(line_files, checksum);
+	});
+
+	Print("group read", group_names.size(), read);
+	Print("group load and query", group_names.size(), group);
+	Print("line split", line_files.size(), split);
+	Print("line split views", line_files.size(), split_views);
+
+	CTextFileLoader::DestroySystem();
+	return EXIT_SUCCESS;
+}
@@ -1,5 +1,7 @@
 #include "StdAfx.h"
 #include "eterBase/Error.h"
+#include "eterBase/TaskGraph.h"
+#include "eterBase/TimeProfiler.h"
 #include "eterlib/Camera.h"
 #include "eterlib/AttributeInstance.h"
 #include "eterlib/ImGuiManager.h"
@@ -12,6 +14,8 @@
 
 #include "ProcessScanner.h"
 
+#include <thread>
+
 extern void GrannyCreateSharedDeformBuffer();
 extern void GrannyDestroySharedDeformBuffer();
 
@@ -305,6 +309,8 @@ bool CPythonApplication::Process()
 	DWORD dwUpdateTime2=ELTimer_GetMSec();
 #endif
 	// Network I/O	
+	m_kNetReactor.Poll();
+
 	m_pyNetworkStream.Process();	
 	//m_pyNetworkDatagram.Process();
 
@@ -366,6 +372,9 @@ bool CPythonApplication::Process()
 #endif
 	OnUIUpdate();
 
+	// the packets the input and the UI queued this frame leave together, not at the next frame's Process
+	m_kNetReactor.Flush();
+
 #ifdef __PERFORMANCE_CHECK__		
 	DWORD dwUpdateTime10=ELTimer_GetMSec();
 
@@ -878,6 +887,8 @@ void CPythonApplication::Loop()
 // SUPPORT_NEW_KOREA_SERVER
 bool LoadLocaleData(const char* localePath)
 {
+	TIME_PROFILE_SCOPE("LoadLocaleData", localePath);
+
 	NANOBEGIN
 		CPythonNonPlayer&	rkNPCMgr	= CPythonNonPlayer::Instance();
 	CItemManager&		rkItemMgr	= CItemManager::Instance();	
@@ -903,58 +914,104 @@ bool LoadLocaleData(const char* localePath)
 	rkItemMgr.Destroy();	
 	rkSkillMgr.Destroy();
 
-	if (!rkItemMgr.LoadItemList(szItemList))
+	// Each manager is filled by one chain of tasks, the chains run side by side. The skill icons go through
+	// CResourceManager, which isn't thread safe, so the skill chain stays on this thread.
+	CTaskGraph kGraph;
+
+	DWORD dwItemList = kGraph.AddTask("item_list", [&]()
 	{
-		TraceError("LoadLocaleData - LoadItemList(%s) Error", szItemList);
-	}	
+		if (!rkItemMgr.LoadItemList(szItemList))
+			TraceError("LoadLocaleData - LoadItemList(%s) Error", szItemList);
+		return true;
+	});
 
-	if (!rkItemMgr.LoadItemTable(szItemProto))
+	DWORD dwItemProto = kGraph.AddTask("item_proto", [&]()
 	{
-		TraceError("LoadLocaleData - LoadItemProto(%s) Error", szItemProto);
-		return false;
-	}
+		if (!rkItemMgr.LoadItemTable(szItemProto))
+		{
+			TraceError("LoadLocaleData - LoadItemProto(%s) Error", szItemProto);
+			return false;
+		}
+		return true;
+	});
 
-	if (!rkItemMgr.LoadItemDesc(szItemDesc))
+	DWORD dwItemDesc = kGraph.AddTask("item_desc", [&]()
 	{
-		Tracenf("LoadLocaleData - LoadItemDesc(%s) Error", szItemDesc);	
-	}
+		if (!rkItemMgr.LoadItemDesc(szItemDesc))
+			Tracenf("LoadLocaleData - LoadItemDesc(%s) Error", szItemDesc);
+		return true;
+	});
 
-	if (!rkNPCMgr.LoadNonPlayerData(szMobProto))
+	kGraph.AddTask("mob_proto", [&]()
 	{
-		TraceError("LoadLocaleData - LoadMobProto(%s) Error", szMobProto);
-		return false;
-	}
+		if (!rkNPCMgr.LoadNonPlayerData(szMobProto))
+		{
+			TraceError("LoadLocaleData - LoadMobProto(%s) Error", szMobProto);
+			return false;
+		}
+		return true;
+	});
 
-	if (!rkSkillMgr.RegisterSkillDesc(szSkillDescFileName))
+	DWORD dwSkillDesc = kGraph.AddTask("skill_desc", [&]()
 	{
-		TraceError("LoadLocaleData - RegisterSkillDesc(%s) Error", szMobProto);
-		return false;
-	}
+		if (!rkSkillMgr.RegisterSkillDesc(szSkillDescFileName))
+		{
+			TraceError("LoadLocaleData - RegisterSkillDesc(%s) Error", szMobProto);
+			return false;
+		}
+		return true;
+	}, true);
 
-	if (!rkSkillMgr.RegisterSkillTable(szSkillTableFileName))
+	DWORD dwSkillTable = kGraph.AddTask("skill_table", [&]()
 	{
-		TraceError("LoadLocaleData - RegisterSkillTable(%s) Error", szMobProto);
-		return false;
-	}
+		if (!rkSkillMgr.RegisterSkillTable(szSkillTableFileName))
+		{
+			TraceError("LoadLocaleData - RegisterSkillTable(%s) Error", szMobProto);
+			return false;
+		}
+		return true;
+	}, true);
 
-	if (!rkNetStream.LoadInsultList(szInsultList))
+	kGraph.AddTask("insult_list", [&]()
 	{
-		Tracenf("CPythonApplication - CPythonNetworkStream::LoadInsultList(%s)", szInsultList);				
-	}
+		if (!rkNetStream.LoadInsultList(szInsultList))
+			Tracenf("CPythonApplication - CPythonNetworkStream::LoadInsultList(%s)", szInsultList);
+		return true;
+	});
 
 	if (LocaleService_IsYMIR())
-	{	
-		char szEmpireTextConvFile[256];
+	{
+		// every empire has its own table, nothing shared
 		for (DWORD dwEmpireID=1; dwEmpireID<=3; ++dwEmpireID)
-		{			
-			sprintf(szEmpireTextConvFile, "%s/lang%d.cvt", localePath, dwEmpireID);
-			if (!rkNetStream.LoadConvertTable(dwEmpireID, szEmpireTextConvFile))
+		{
+			// one name per empire, the timeline and the critical path tell them apart
+			char szTaskName[32];
+			sprintf(szTaskName, "empire_text_conv%u", dwEmpireID);
+
+			kGraph.AddTask(szTaskName, [&rkNetStream, localePath, dwEmpireID]()
 			{
-				TraceError("LoadLocaleData - CPythonNetworkStream::LoadConvertTable(%d, %s) FAILURE", dwEmpireID, szEmpireTextConvFile);			
-			}
+				char szEmpireTextConvFile[256];
+				sprintf(szEmpireTextConvFile, "%s/lang%d.cvt", localePath, dwEmpireID);
+				if (!rkNetStream.LoadConvertTable(dwEmpireID, szEmpireTextConvFile))
+				{
+					TraceError("LoadLocaleData - CPythonNetworkStream::LoadConvertTable(%d, %s) FAILURE", dwEmpireID, szEmpireTextConvFile);
+				}
+				return true;
+			});
 		}
 	}
 
+	// item_proto fills the items item_list made, item_desc annotates them, skill_table the skills of skill_desc
+	kGraph.AddDependency(dwItemProto, dwItemList);
+	kGraph.AddDependency(dwItemDesc, dwItemProto);
+	kGraph.AddDependency(dwSkillTable, dwSkillDesc);
+
+	bool bLoaded = kGraph.Run(std::clamp(std::thread::hardware_concurrency(), 2u, 4u) - 1);
+	kGraph.TraceTimeline("LoadLocaleData");
+
+	if (!bLoaded)
+		return false;
+
 	NANOEND
 		return true;
 }
@@ -970,6 +1027,8 @@ unsigned __GetWindowMode(bool windowed)
 
 bool CPythonApplication::Create(PyObject * poSelf, const char * c_szName, int width, int height, int Windowed)
 {
+	TIME_PROFILE_SCOPE("CPythonApplication::Create");
+
 	NANOBEGIN
 		Windowed = CPythonSystem::Instance().IsWindowed() ? 1 : 0;
 
@@ -5,6 +5,7 @@
 #include "eterLib/Profiler.h"
 #include "eterLib/GrpDevice.h"
 #include "eterLib/NetDevice.h"
+#include "eterLib/NetReactor.h"
 #include "eterLib/GrpLightManager.h"
 #include "EffectLib/EffectManager.h"
 #include "gamelib/RaceManager.h"
@@ -321,6 +322,7 @@ class CPythonApplication : public CMSApplication, public CInputKeyboard, public
 		CEffectManager				m_kEftMgr;
 		CPythonCharacterManager		m_kChrMgr;
 
+		CNetworkReactor				m_kNetReactor;		// before every stream, they unregister when destroyed
 		CServerStateChecker			m_kServerStateChecker;
 		CPythonGraphic				m_pyGraphic;
 		CPythonNetworkStream		m_pyNetworkStream;
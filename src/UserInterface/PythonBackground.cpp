@@ -5,6 +5,8 @@
 #include "stdafx.h"
 #include "EterLib/CullingManager.h"
 #include "EterLib/Camera.h"
+#include "EterLib/ResourceManager.h"
+#include "EterBase/TimeProfiler.h"
 #include "PackLib/PackManager.h"
 #include "GameLib/MapOutDoor.h"
 #include "GameLib/PropertyLoader.h"
@@ -730,6 +732,8 @@ CPythonBackground::TMapInfo* CPythonBackground::GlobalPositionToMapInfo(DWORD dw
 
 void CPythonBackground::Warp(DWORD dwX, DWORD dwY)
 {
+	TIME_PROFILE_SCOPE("CPythonBackground::Warp");
+
 	TMapInfo* pkMapInfo = GlobalPositionToMapInfo(dwX, dwY);
 	if (!pkMapInfo)
 	{
@@ -741,6 +745,9 @@ void CPythonBackground::Warp(DWORD dwX, DWORD dwY)
 	TMapInfo & rMapInfo = *pkMapInfo;
 	assert( (dwX >= rMapInfo.m_dwBaseX) && (dwY >= rMapInfo.m_dwBaseY) );
 
+	// whatever was still streaming in for the previous location is useless now
+	CResourceManager::Instance().CancelBackgroundLoading();
+
 	if (!LoadMap(rMapInfo.m_strName, float(dwX - rMapInfo.m_dwBaseX), float(dwY - rMapInfo.m_dwBaseY), 0))
 	{
 		// LOAD_MAP_ERROR_HANDLING
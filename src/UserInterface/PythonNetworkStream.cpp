@@ -1,6 +1,4 @@
 #include "StdAfx.h"
-#include "EterLib/NetPacketHeaderMap.h"
-
 #include "PythonNetworkStream.h"
 #include "Packet.h"
 #include "NetworkActorManager.h"
@@ -16,171 +14,194 @@ static DWORD gs_nextDownloadMarkTime = 0;
 // END_OF_MARK_BUG_FIX
 
 // Packet ---------------------------------------------------------------------------
-class CMainPacketHeaderMap : public CNetworkPacketHeaderMap
+static constexpr bool STATIC_SIZE_PACKET = false;
+static constexpr bool DYNAMIC_SIZE_PACKET = true;
+static constexpr bool LEAVE_GAME_PHASE = true;
+
+template <typename TPacket, bool isDynamicSize>
+constexpr CPythonNetworkStream::TPacketDesc CPythonNetworkStream::__MakePacketDesc(TRecvFunction pfnGameRecv, bool isLeavingGamePhase)
 {
-	public:
-		enum
-		{
-			STATIC_SIZE_PACKET = false,
-			DYNAMIC_SIZE_PACKET = true,
-		};
+	static_assert(sizeof(TPacket) <= UINT16_MAX, "the packet doesn't fit the size field");
+	static_assert(!isDynamicSize || sizeof(TPacket) >= sizeof(TDynamicSizePacketHeader), "a dynamic size packet begins with TDynamicSizePacketHeader");
 
-	public:
-		CMainPacketHeaderMap()
-		{
-			Set(HEADER_GC_EMPIRE,				CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCEmpire), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_WARP,					CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCWarp), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_SKILL_COOLTIME_END,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCSkillCoolTimeEnd), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_QUEST_INFO,			CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCQuestInfo), DYNAMIC_SIZE_PACKET));
-			Set(HEADER_GC_REQUEST_MAKE_GUILD,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCBlank), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_PVP,					CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCPVP), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_DUEL_START,			CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCDuelStart), DYNAMIC_SIZE_PACKET));
-			Set(HEADER_GC_CHARACTER_ADD,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCCharacterAdd), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_CHAR_ADDITIONAL_INFO,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCCharacterAdditionalInfo), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_CHARACTER_ADD2,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCCharacterAdd2), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_CHARACTER_UPDATE,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCCharacterUpdate), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_CHARACTER_UPDATE2,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCCharacterUpdate2), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_CHARACTER_DEL,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCCharacterDelete), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_CHARACTER_MOVE,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCMove), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_CHAT,					CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCChat), DYNAMIC_SIZE_PACKET));
-
-			Set(HEADER_GC_SYNC_POSITION,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCC2C), DYNAMIC_SIZE_PACKET));
-
-			Set(HEADER_GC_LOGIN_SUCCESS3,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCLoginSuccess3), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_LOGIN_SUCCESS4,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCLoginSuccess4), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_LOGIN_FAILURE,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCLoginFailure), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_PLAYER_CREATE_SUCCESS,		 CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCPlayerCreateSuccess), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_PLAYER_CREATE_FAILURE,		 CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCCreateFailure), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_PLAYER_DELETE_SUCCESS,		 CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCBlank), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_PLAYER_DELETE_WRONG_SOCIAL_ID, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCBlank), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_STUN,					CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCStun), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_DEAD,					CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCDead), STATIC_SIZE_PACKET));
-			
-			Set(HEADER_GC_MAIN_CHARACTER,			CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCMainCharacter), STATIC_SIZE_PACKET));
-
-			// SUPPORT_BGM
-			Set(HEADER_GC_MAIN_CHARACTER2_EMPIRE,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCMainCharacter2_EMPIRE), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_MAIN_CHARACTER3_BGM,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCMainCharacter3_BGM), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_MAIN_CHARACTER4_BGM_VOL,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCMainCharacter4_BGM_VOL), STATIC_SIZE_PACKET));
-			// END_OFSUPPORT_BGM
-
-			Set(HEADER_GC_PLAYER_POINTS,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCPoints), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_PLAYER_POINT_CHANGE,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCPointChange), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_ITEM_DEL,				CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCItemDel), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_ITEM_SET,				CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCItemSet), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_ITEM_USE,				CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCItemUse), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_ITEM_UPDATE,			CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCItemUpdate), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_ITEM_GROUND_ADD,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCItemGroundAdd), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_ITEM_GROUND_DEL,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCItemGroundDel), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_ITEM_OWNERSHIP,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCItemOwnership), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_QUICKSLOT_ADD,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCQuickSlotAdd), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_QUICKSLOT_DEL,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCQuickSlotDel), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_QUICKSLOT_SWAP,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCQuickSlotSwap), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_WHISPER,				CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCWhisper), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_CHARACTER_POSITION,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCPosition), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_MOTION,				CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCMotion), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_SHOP,			CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCShop), DYNAMIC_SIZE_PACKET));
-			Set(HEADER_GC_SHOP_SIGN,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCShopSign), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_EXCHANGE,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCExchange), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_PING,			CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCPing), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_SCRIPT,			CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCScript), DYNAMIC_SIZE_PACKET));
-			Set(HEADER_GC_QUEST_CONFIRM,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCQuestConfirm), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_TARGET,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCTarget), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_MOUNT,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCMount), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_CHANGE_SPEED,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCChangeSpeed), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_HANDSHAKE,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCHandshake), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_HANDSHAKE_OK,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCBlank), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_BINDUDP,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCBindUDP), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_OWNERSHIP,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCOwnership), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_CREATE_FLY,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCCreateFly), STATIC_SIZE_PACKET));
+	return { (uint16_t) sizeof(TPacket), isDynamicSize, isLeavingGamePhase, pfnGameRecv };
+}
+
+// every header the server sends with the size of its packet and what the game phase receives it with, the other
+// phases switch over the few headers they know themselves
+constexpr std::array<CPythonNetworkStream::TPacketDesc, 256> CPythonNetworkStream::__BuildPacketDescTable()
+{
+	static_assert(sizeof(TPacketHeader) == 1, "the table has one entry per header value");
+
+	const TPacketEntry c_akEntry[] =
+	{
+		{ HEADER_GC_EMPIRE,							__MakePacketDesc<TPacketGCEmpire, STATIC_SIZE_PACKET>() },
+		{ HEADER_GC_WARP,							__MakePacketDesc<TPacketGCWarp, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvWarpPacket) },
+		{ HEADER_GC_SKILL_COOLTIME_END,				__MakePacketDesc<TPacketGCSkillCoolTimeEnd, STATIC_SIZE_PACKET>() },
+		{ HEADER_GC_QUEST_INFO,						__MakePacketDesc<TPacketGCQuestInfo, DYNAMIC_SIZE_PACKET>(&CPythonNetworkStream::RecvQuestInfoPacket) },
+		{ HEADER_GC_REQUEST_MAKE_GUILD,				__MakePacketDesc<TPacketGCBlank, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvRequestMakeGuild) },
+		{ HEADER_GC_PVP,							__MakePacketDesc<TPacketGCPVP, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvPVPPacket) },
+		{ HEADER_GC_DUEL_START,						__MakePacketDesc<TPacketGCDuelStart, DYNAMIC_SIZE_PACKET>(&CPythonNetworkStream::RecvDuelStartPacket) },
+		{ HEADER_GC_CHARACTER_ADD,					__MakePacketDesc<TPacketGCCharacterAdd, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvCharacterAppendPacket) },
+		{ HEADER_GC_CHAR_ADDITIONAL_INFO,			__MakePacketDesc<TPacketGCCharacterAdditionalInfo, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvCharacterAdditionalInfo) },
+		{ HEADER_GC_CHARACTER_ADD2,					__MakePacketDesc<TPacketGCCharacterAdd2, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvCharacterAppendPacketNew) },
+		{ HEADER_GC_CHARACTER_UPDATE,				__MakePacketDesc<TPacketGCCharacterUpdate, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvCharacterUpdatePacket) },
+		{ HEADER_GC_CHARACTER_UPDATE2,				__MakePacketDesc<TPacketGCCharacterUpdate2, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvCharacterUpdatePacketNew) },
+		{ HEADER_GC_CHARACTER_DEL,					__MakePacketDesc<TPacketGCCharacterDelete, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvCharacterDeletePacket) },
+		{ HEADER_GC_CHARACTER_MOVE,					__MakePacketDesc<TPacketGCMove, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvCharacterMovePacket) },
+		{ HEADER_GC_CHAT,							__MakePacketDesc<TPacketGCChat, DYNAMIC_SIZE_PACKET>(&CPythonNetworkStream::RecvChatPacket) },
+
+		{ HEADER_GC_SYNC_POSITION,					__MakePacketDesc<TPacketGCC2C, DYNAMIC_SIZE_PACKET>(&CPythonNetworkStream::RecvSyncPositionPacket) },
+
+		{ HEADER_GC_LOGIN_SUCCESS3,					__MakePacketDesc<TPacketGCLoginSuccess3, STATIC_SIZE_PACKET>() },
+		{ HEADER_GC_LOGIN_SUCCESS4,					__MakePacketDesc<TPacketGCLoginSuccess4, STATIC_SIZE_PACKET>() },
+		{ HEADER_GC_LOGIN_FAILURE,					__MakePacketDesc<TPacketGCLoginFailure, STATIC_SIZE_PACKET>() },
+
+		{ HEADER_GC_PLAYER_CREATE_SUCCESS,			__MakePacketDesc<TPacketGCPlayerCreateSuccess, STATIC_SIZE_PACKET>() },
+		{ HEADER_GC_PLAYER_CREATE_FAILURE,			__MakePacketDesc<TPacketGCCreateFailure, STATIC_SIZE_PACKET>() },
+		{ HEADER_GC_PLAYER_DELETE_SUCCESS,			__MakePacketDesc<TPacketGCBlank, STATIC_SIZE_PACKET>() },
+		{ HEADER_GC_PLAYER_DELETE_WRONG_SOCIAL_ID,	__MakePacketDesc<TPacketGCBlank, STATIC_SIZE_PACKET>() },
+
+		{ HEADER_GC_STUN,							__MakePacketDesc<TPacketGCStun, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvStunPacket) },
+		{ HEADER_GC_DEAD,							__MakePacketDesc<TPacketGCDead, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvDeadPacket) },
+
+		{ HEADER_GC_MAIN_CHARACTER,					__MakePacketDesc<TPacketGCMainCharacter, STATIC_SIZE_PACKET>() },
+
+		// SUPPORT_BGM
+		{ HEADER_GC_MAIN_CHARACTER2_EMPIRE,			__MakePacketDesc<TPacketGCMainCharacter2_EMPIRE, STATIC_SIZE_PACKET>() },
+		{ HEADER_GC_MAIN_CHARACTER3_BGM,			__MakePacketDesc<TPacketGCMainCharacter3_BGM, STATIC_SIZE_PACKET>() },
+		{ HEADER_GC_MAIN_CHARACTER4_BGM_VOL,		__MakePacketDesc<TPacketGCMainCharacter4_BGM_VOL, STATIC_SIZE_PACKET>() },
+		// END_OFSUPPORT_BGM
+
+		{ HEADER_GC_PLAYER_POINTS,					__MakePacketDesc<TPacketGCPoints, STATIC_SIZE_PACKET>(&CPythonNetworkStream::__RecvPlayerPoints) },
+		{ HEADER_GC_PLAYER_POINT_CHANGE,			__MakePacketDesc<TPacketGCPointChange, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvPointChange) },
+
+		{ HEADER_GC_ITEM_DEL,						__MakePacketDesc<TPacketGCItemDel, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvItemDelPacket) },
+		{ HEADER_GC_ITEM_SET,						__MakePacketDesc<TPacketGCItemSet, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvItemSetPacket) },
+
+		{ HEADER_GC_ITEM_USE,						__MakePacketDesc<TPacketGCItemUse, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvItemUsePacket) },
+		{ HEADER_GC_ITEM_UPDATE,					__MakePacketDesc<TPacketGCItemUpdate, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvItemUpdatePacket) },
+
+		{ HEADER_GC_ITEM_GROUND_ADD,				__MakePacketDesc<TPacketGCItemGroundAdd, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvItemGroundAddPacket) },
+		{ HEADER_GC_ITEM_GROUND_DEL,				__MakePacketDesc<TPacketGCItemGroundDel, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvItemGroundDelPacket) },
+		{ HEADER_GC_ITEM_OWNERSHIP,					__MakePacketDesc<TPacketGCItemOwnership, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvItemOwnership) },
+
+		{ HEADER_GC_QUICKSLOT_ADD,					__MakePacketDesc<TPacketGCQuickSlotAdd, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvQuickSlotAddPacket) },
+		{ HEADER_GC_QUICKSLOT_DEL,					__MakePacketDesc<TPacketGCQuickSlotDel, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvQuickSlotDelPacket) },
+		{ HEADER_GC_QUICKSLOT_SWAP,					__MakePacketDesc<TPacketGCQuickSlotSwap, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvQuickSlotMovePacket) },
+
+		{ HEADER_GC_WHISPER,						__MakePacketDesc<TPacketGCWhisper, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvWhisperPacket) },
+
+		{ HEADER_GC_CHARACTER_POSITION,				__MakePacketDesc<TPacketGCPosition, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvCharacterPositionPacket) },
+		{ HEADER_GC_MOTION,							__MakePacketDesc<TPacketGCMotion, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvMotionPacket) },
+
+		{ HEADER_GC_SHOP,							__MakePacketDesc<TPacketGCShop, DYNAMIC_SIZE_PACKET>(&CPythonNetworkStream::RecvShopPacket) },
+		{ HEADER_GC_SHOP_SIGN,						__MakePacketDesc<TPacketGCShopSign, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvShopSignPacket) },
+		{ HEADER_GC_EXCHANGE,						__MakePacketDesc<TPacketGCExchange, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvExchangePacket) },
+
+		{ HEADER_GC_PING,							__MakePacketDesc<TPacketGCPing, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvPingPacket) },
+
+		{ HEADER_GC_SCRIPT,							__MakePacketDesc<TPacketGCScript, DYNAMIC_SIZE_PACKET>(&CPythonNetworkStream::RecvScriptPacket) },
+		{ HEADER_GC_QUEST_CONFIRM,					__MakePacketDesc<TPacketGCQuestConfirm, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvQuestConfirmPacket) },
+
+		{ HEADER_GC_TARGET,							__MakePacketDesc<TPacketGCTarget, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvTargetPacket) },
+		{ HEADER_GC_MOUNT,							__MakePacketDesc<TPacketGCMount, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvMountPacket) },
+
+		{ HEADER_GC_CHANGE_SPEED,					__MakePacketDesc<TPacketGCChangeSpeed, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvChangeSpeedPacket) },
+
+		{ HEADER_GC_HANDSHAKE,						__MakePacketDesc<TPacketGCHandshake, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvHandshakePacket, LEAVE_GAME_PHASE) },
+		{ HEADER_GC_HANDSHAKE_OK,					__MakePacketDesc<TPacketGCBlank, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvHandshakeOKPacket, LEAVE_GAME_PHASE) },
+		{ HEADER_GC_BINDUDP,						__MakePacketDesc<TPacketGCBindUDP, STATIC_SIZE_PACKET>() },
+		{ HEADER_GC_OWNERSHIP,						__MakePacketDesc<TPacketGCOwnership, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvOwnerShipPacket) },
+		{ HEADER_GC_CREATE_FLY,						__MakePacketDesc<TPacketGCCreateFly, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvCreateFlyPacket) },
 #ifdef _IMPROVED_PACKET_ENCRYPTION_
-			Set(HEADER_GC_KEY_AGREEMENT, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketKeyAgreement), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_KEY_AGREEMENT_COMPLETED, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketKeyAgreementCompleted), STATIC_SIZE_PACKET));
+		{ HEADER_GC_KEY_AGREEMENT,					__MakePacketDesc<TPacketKeyAgreement, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvKeyAgreementPacket, LEAVE_GAME_PHASE) },
+		{ HEADER_GC_KEY_AGREEMENT_COMPLETED,		__MakePacketDesc<TPacketKeyAgreementCompleted, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvKeyAgreementCompletedPacket, LEAVE_GAME_PHASE) },
 #endif
-			Set(HEADER_GC_ADD_FLY_TARGETING, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCFlyTargeting), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_FLY_TARGETING, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCFlyTargeting), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_PHASE,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCPhase), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_SKILL_LEVEL,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCSkillLevel), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_SKILL_LEVEL_NEW,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCSkillLevelNew), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_MESSENGER,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCMessenger), DYNAMIC_SIZE_PACKET));
-			Set(HEADER_GC_GUILD,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCGuild), DYNAMIC_SIZE_PACKET));
-
-			Set(HEADER_GC_PARTY_INVITE,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCPartyInvite), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_PARTY_ADD,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCPartyAdd), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_PARTY_UPDATE,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCPartyUpdate), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_PARTY_REMOVE,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCPartyRemove), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_PARTY_LINK,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCPartyLink), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_PARTY_UNLINK,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCPartyUnlink), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_PARTY_PARAMETER,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCPartyParameter), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_SAFEBOX_SET,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCItemSet), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_SAFEBOX_DEL,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCItemDel), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_SAFEBOX_WRONG_PASSWORD,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCSafeboxWrongPassword), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_SAFEBOX_SIZE,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCSafeboxSize), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_SAFEBOX_MONEY_CHANGE,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCSafeboxMoneyChange), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_FISHING,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCFishing), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_DUNGEON, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCDungeon), DYNAMIC_SIZE_PACKET));
-			//Set(HEADER_GC_SLOW_TIMER, CNetworkPacketHeaderMap::TPacketType(sizeof(BYTE), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_TIME, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCTime), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_WALK_MODE, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCWalkMode), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_CHANGE_SKILL_GROUP, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCChangeSkillGroup), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_REFINE_INFORMATION, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCRefineInformation), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_REFINE_INFORMATION_NEW, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCRefineInformationNew), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_SEPCIAL_EFFECT, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCSpecialEffect), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_NPC_POSITION, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCNPCPosition), DYNAMIC_SIZE_PACKET));
-			Set(HEADER_GC_CHANGE_NAME, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCChangeName), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_CHINA_MATRIX_CARD, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCChinaMatrixCard), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_RUNUP_MATRIX_QUIZ, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCRunupMatrixQuiz), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_LOGIN_KEY, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCLoginKey), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_AUTH_SUCCESS, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCAuthSuccess), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_CHANNEL, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCChannel), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_VIEW_EQUIP, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCViewEquip), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_LAND_LIST, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCLandList), DYNAMIC_SIZE_PACKET));
-
-			//Set(HEADER_GC_TARGET_CREATE, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCTargetCreate), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_TARGET_UPDATE, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCTargetUpdate), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_TARGET_DELETE, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCTargetDelete), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_TARGET_CREATE_NEW, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCTargetCreateNew), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_AFFECT_ADD, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCAffectAdd), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_AFFECT_REMOVE, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCAffectRemove), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_MALL_OPEN, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCMallOpen), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_MALL_SET, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCItemSet), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_MALL_DEL, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCItemDel), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_LOVER_INFO, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCLoverInfo), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_LOVE_POINT_UPDATE, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCLovePointUpdate), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_DIG_MOTION, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCDigMotion), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_DAMAGE_INFO, CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCDamageInfo), STATIC_SIZE_PACKET));
-
-			Set(HEADER_GC_HYBRIDCRYPT_KEYS,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCHybridCryptKeys), DYNAMIC_SIZE_PACKET));
-			Set(HEADER_GC_HYBRIDCRYPT_SDB,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCHybridSDB), DYNAMIC_SIZE_PACKET));
-			Set(HEADER_GC_SPECIFIC_EFFECT,	CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCSpecificEffect), STATIC_SIZE_PACKET));
-			Set(HEADER_GC_DRAGON_SOUL_REFINE,		CNetworkPacketHeaderMap::TPacketType(sizeof(TPacketGCDragonSoulRefine), STATIC_SIZE_PACKET));
-			
-		}
-};
+		{ HEADER_GC_ADD_FLY_TARGETING,				__MakePacketDesc<TPacketGCFlyTargeting, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvAddFlyTargetingPacket) },
+		{ HEADER_GC_FLY_TARGETING,					__MakePacketDesc<TPacketGCFlyTargeting, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvFlyTargetingPacket) },
+
+		{ HEADER_GC_PHASE,							__MakePacketDesc<TPacketGCPhase, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvPhasePacket, LEAVE_GAME_PHASE) },
+		{ HEADER_GC_SKILL_LEVEL,					__MakePacketDesc<TPacketGCSkillLevel, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvSkillLevel) },
+		{ HEADER_GC_SKILL_LEVEL_NEW,				__MakePacketDesc<TPacketGCSkillLevelNew, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvSkillLevelNew) },
+
+		{ HEADER_GC_MESSENGER,						__MakePacketDesc<TPacketGCMessenger, DYNAMIC_SIZE_PACKET>(&CPythonNetworkStream::RecvMessenger) },
+		{ HEADER_GC_GUILD,							__MakePacketDesc<TPacketGCGuild, DYNAMIC_SIZE_PACKET>(&CPythonNetworkStream::RecvGuild) },
+
+		{ HEADER_GC_PARTY_INVITE,					__MakePacketDesc<TPacketGCPartyInvite, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvPartyInvite) },
+		{ HEADER_GC_PARTY_ADD,						__MakePacketDesc<TPacketGCPartyAdd, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvPartyAdd) },
+		{ HEADER_GC_PARTY_UPDATE,					__MakePacketDesc<TPacketGCPartyUpdate, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvPartyUpdate) },
+		{ HEADER_GC_PARTY_REMOVE,					__MakePacketDesc<TPacketGCPartyRemove, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvPartyRemove) },
+		{ HEADER_GC_PARTY_LINK,						__MakePacketDesc<TPacketGCPartyLink, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvPartyLink) },
+		{ HEADER_GC_PARTY_UNLINK,					__MakePacketDesc<TPacketGCPartyUnlink, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvPartyUnlink) },
+		{ HEADER_GC_PARTY_PARAMETER,				__MakePacketDesc<TPacketGCPartyParameter, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvPartyParameter) },
+
+		{ HEADER_GC_SAFEBOX_SET,					__MakePacketDesc<TPacketGCItemSet, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvSafeBoxSetPacket) },
+		{ HEADER_GC_SAFEBOX_DEL,					__MakePacketDesc<TPacketGCItemDel, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvSafeBoxDelPacket) },
+		{ HEADER_GC_SAFEBOX_WRONG_PASSWORD,			__MakePacketDesc<TPacketGCSafeboxWrongPassword, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvSafeBoxWrongPasswordPacket) },
+		{ HEADER_GC_SAFEBOX_SIZE,					__MakePacketDesc<TPacketGCSafeboxSize, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvSafeBoxSizePacket) },
+		{ HEADER_GC_SAFEBOX_MONEY_CHANGE,			__MakePacketDesc<TPacketGCSafeboxMoneyChange, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvSafeBoxMoneyChangePacket) },
+
+		{ HEADER_GC_FISHING,						__MakePacketDesc<TPacketGCFishing, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvFishing) },
+		{ HEADER_GC_DUNGEON,						__MakePacketDesc<TPacketGCDungeon, DYNAMIC_SIZE_PACKET>(&CPythonNetworkStream::RecvDungeon) },
+		//{ HEADER_GC_SLOW_TIMER,					__MakePacketDesc<BYTE, STATIC_SIZE_PACKET>() },
+		{ HEADER_GC_TIME,							__MakePacketDesc<TPacketGCTime, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvTimePacket) },
+		{ HEADER_GC_WALK_MODE,						__MakePacketDesc<TPacketGCWalkMode, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvWalkModePacket) },
+		{ HEADER_GC_CHANGE_SKILL_GROUP,				__MakePacketDesc<TPacketGCChangeSkillGroup, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvChangeSkillGroupPacket) },
+		{ HEADER_GC_REFINE_INFORMATION,				__MakePacketDesc<TPacketGCRefineInformation, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvRefineInformationPacket) },
+		{ HEADER_GC_REFINE_INFORMATION_NEW,			__MakePacketDesc<TPacketGCRefineInformationNew, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvRefineInformationPacketNew) },
+		{ HEADER_GC_SEPCIAL_EFFECT,					__MakePacketDesc<TPacketGCSpecialEffect, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvSpecialEffect) },
+		{ HEADER_GC_NPC_POSITION,					__MakePacketDesc<TPacketGCNPCPosition, DYNAMIC_SIZE_PACKET>(&CPythonNetworkStream::RecvNPCList) },
+		{ HEADER_GC_CHANGE_NAME,					__MakePacketDesc<TPacketGCChangeName, STATIC_SIZE_PACKET>() },
+
+		{ HEADER_GC_CHINA_MATRIX_CARD,				__MakePacketDesc<TPacketGCChinaMatrixCard, STATIC_SIZE_PACKET>() },
+		{ HEADER_GC_RUNUP_MATRIX_QUIZ,				__MakePacketDesc<TPacketGCRunupMatrixQuiz, STATIC_SIZE_PACKET>() },
+		{ HEADER_GC_LOGIN_KEY,						__MakePacketDesc<TPacketGCLoginKey, STATIC_SIZE_PACKET>() },
+
+		{ HEADER_GC_AUTH_SUCCESS,					__MakePacketDesc<TPacketGCAuthSuccess, STATIC_SIZE_PACKET>() },
+		{ HEADER_GC_CHANNEL,						__MakePacketDesc<TPacketGCChannel, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvChannelPacket) },
+		{ HEADER_GC_VIEW_EQUIP,						__MakePacketDesc<TPacketGCViewEquip, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvViewEquipPacket) },
+		{ HEADER_GC_LAND_LIST,						__MakePacketDesc<TPacketGCLandList, DYNAMIC_SIZE_PACKET>(&CPythonNetworkStream::RecvLandPacket) },
+
+		//{ HEADER_GC_TARGET_CREATE,				__MakePacketDesc<TPacketGCTargetCreate, STATIC_SIZE_PACKET>() },
+		{ HEADER_GC_TARGET_UPDATE,					__MakePacketDesc<TPacketGCTargetUpdate, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvTargetUpdatePacket) },
+		{ HEADER_GC_TARGET_DELETE,					__MakePacketDesc<TPacketGCTargetDelete, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvTargetDeletePacket) },
+		{ HEADER_GC_TARGET_CREATE_NEW,				__MakePacketDesc<TPacketGCTargetCreateNew, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvTargetCreatePacketNew) },
+
+		{ HEADER_GC_AFFECT_ADD,						__MakePacketDesc<TPacketGCAffectAdd, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvAffectAddPacket) },
+		{ HEADER_GC_AFFECT_REMOVE,					__MakePacketDesc<TPacketGCAffectRemove, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvAffectRemovePacket) },
+
+		{ HEADER_GC_MALL_OPEN,						__MakePacketDesc<TPacketGCMallOpen, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvMallOpenPacket) },
+		{ HEADER_GC_MALL_SET,						__MakePacketDesc<TPacketGCItemSet, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvMallItemSetPacket) },
+		{ HEADER_GC_MALL_DEL,						__MakePacketDesc<TPacketGCItemDel, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvMallItemDelPacket) },
+
+		{ HEADER_GC_LOVER_INFO,						__MakePacketDesc<TPacketGCLoverInfo, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvLoverInfoPacket) },
+		{ HEADER_GC_LOVE_POINT_UPDATE,				__MakePacketDesc<TPacketGCLovePointUpdate, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvLovePointUpdatePacket) },
+
+		{ HEADER_GC_DIG_MOTION,						__MakePacketDesc<TPacketGCDigMotion, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvDigMotionPacket) },
+		{ HEADER_GC_DAMAGE_INFO,					__MakePacketDesc<TPacketGCDamageInfo, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvDamageInfoPacket) },
+
+		{ HEADER_GC_HYBRIDCRYPT_KEYS,				__MakePacketDesc<TPacketGCHybridCryptKeys, DYNAMIC_SIZE_PACKET>(&CPythonNetworkStream::RecvHybridCryptKeyPacket, LEAVE_GAME_PHASE) },
+		{ HEADER_GC_HYBRIDCRYPT_SDB,				__MakePacketDesc<TPacketGCHybridSDB, DYNAMIC_SIZE_PACKET>(&CPythonNetworkStream::RecvHybridCryptSDBPacket, LEAVE_GAME_PHASE) },
+		{ HEADER_GC_SPECIFIC_EFFECT,				__MakePacketDesc<TPacketGCSpecificEffect, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvSpecificEffect) },
+		{ HEADER_GC_DRAGON_SOUL_REFINE,				__MakePacketDesc<TPacketGCDragonSoulRefine, STATIC_SIZE_PACKET>(&CPythonNetworkStream::RecvDragonSoulRefine) },
+	};
+
+	std::array<TPacketDesc, 256> kArr_kDesc = {};
+
+	for (const TPacketEntry & c_rkEntry : c_akEntry)
+	{
+		// a header given twice stops the table from being constant, the constinit below fails to compile
+		if (kArr_kDesc[c_rkEntry.header].wSize)
+			throw "CPythonNetworkStream: packet header registered twice";
+
+		kArr_kDesc[c_rkEntry.header] = c_rkEntry.kDesc;
+	}
+
+	return kArr_kDesc;
+}
+
+constinit const std::array<CPythonNetworkStream::TPacketDesc, 256> CPythonNetworkStream::ms_kArr_kPacketDesc = CPythonNetworkStream::__BuildPacketDescTable();
 
 static std::vector <uint8_t> gs_vecLastHeaders;
 
@@ -493,8 +514,6 @@ bool CPythonNetworkStream::CheckPacket(TPacketHeader * pRetHeader)
 {
 	*pRetHeader = 0;
 
-	static CMainPacketHeaderMap s_packetHeaderMap;
-
 	TPacketHeader header;
 
 	if (!Peek(sizeof(TPacketHeader), &header))
@@ -522,11 +541,11 @@ bool CPythonNetworkStream::CheckPacket(TPacketHeader * pRetHeader)
 			return false;
 	}
 
-	CNetworkPacketHeaderMap::TPacketType PacketType;
+	const TPacketDesc & c_rkDesc = ms_kArr_kPacketDesc[header];
 
-	if (!s_packetHeaderMap.Get(header, &PacketType))
+	if (!c_rkDesc.wSize)
 	{
-		TraceError("Unknown packet header: %u(0x%X), Phase: %s, Last packets:", header, header, m_strPhase.c_str());
+		TraceError("Unknown packet header: %u(0x%X), Phase: %s, Last packets:", header, header, __GetPhaseName());
 		for (const auto& it : gs_vecLastHeaders)
 			TraceError("%u(0x%X)", it, it);
 
@@ -537,7 +556,7 @@ bool CPythonNetworkStream::CheckPacket(TPacketHeader * pRetHeader)
 	}
 
 	// Code for dynamic size packet
-	if (PacketType.isDynamicSizePacket)
+	if (c_rkDesc.isDynamicSize)
 	{
 		TDynamicSizePacketHeader DynamicSizePacketHeader;
 
@@ -554,11 +573,11 @@ bool CPythonNetworkStream::CheckPacket(TPacketHeader * pRetHeader)
 	}
 	else
 	{
-		if (!Peek(PacketType.iPacketSize))
+		if (!Peek(c_rkDesc.wSize))
 		{
 			TraceError("Not enough packet size: header %d packet size: %d, recv buffer size: %d last packets:",
 				header,
-				PacketType.iPacketSize,
+				c_rkDesc.wSize,
 				GetRecvBufferSize()
 			);
 
@@ -587,7 +606,7 @@ bool CPythonNetworkStream::CheckPacket(TPacketHeader * pRetHeader)
 
 bool CPythonNetworkStream::RecvErrorPacket(int header)
 {
-	TraceError("Phase %s does not handle this header (header: %u(0x%X)) Last packets: ", m_strPhase.c_str(), header, header);
+	TraceError("Phase %s does not handle this header (header: %u(0x%X)) Last packets: ", __GetPhaseName(), header, header);
 	for (const auto& it : gs_vecLastHeaders)
 		TraceError("%u(0x%X)", it, it);
 
@@ -675,11 +694,31 @@ bool CPythonNetworkStream::RecvDefaultPacket(int header)
 	if (!header)
 		return true;
 
-	TraceError("처리되지 않은 패킷 헤더 %d, state %s\n", header, m_strPhase.c_str());
+	TraceError("처리되지 않은 패킷 헤더 %d, state %s\n", header, __GetPhaseName());
 	ClearRecvBuffer();
 	return true;
 }
 
+const char * CPythonNetworkStream::__GetPhaseName() const
+{
+	switch (m_ePhase)
+	{
+		case PHASE_CLOSE:		return "OffLine";
+		case PHASE_HANDSHAKE:	return "HandShake";
+		case PHASE_LOGIN:		return "Login";
+		case PHASE_SELECT:		return "Select";
+		case PHASE_LOADING:		return "Loading";
+		case PHASE_GAME:		return "Game";
+	}
+
+	return "Unknown";
+}
+
+const CNetworkDispatchBudget::TStat & CPythonNetworkStream::GetDispatchStat() const
+{
+	return m_kDispatchBudget.GetStat();
+}
+
 bool CPythonNetworkStream::OnProcess()
 {
 	if (m_isStartGame)
@@ -708,10 +747,10 @@ bool CPythonNetworkStream::OnProcess()
 // Set
 void CPythonNetworkStream::SetOffLinePhase()
 {
-	if ("OffLine" != m_strPhase)
+	if (PHASE_CLOSE != m_ePhase)
 		m_phaseLeaveFunc.Run();
 
-	m_strPhase = "OffLine";
+	m_ePhase = PHASE_CLOSE;
 
 	Tracen("");
 	Tracen("## Network - OffLine Phase ##");	
@@ -898,7 +937,7 @@ CPythonNetworkStream::CPythonNetworkStream()
 	m_isStartGame = FALSE;
 	m_isEnableChatInsultFilter = FALSE;
 	m_bComboSkillFlag = FALSE;
-	m_strPhase = "OffLine";
+	m_ePhase = PHASE_CLOSE;
 	
 	__InitializeGamePhase();
 	__InitializeMarkAuth();
@@ -2,12 +2,14 @@
 
 #include "EterLib/FuncObject.h"
 #include "EterLib/NetStream.h"
-#include "EterLib/NetPacketHeaderMap.h"
+#include "EterLib/NetDispatchBudget.h"
 
 #include "InsultChecker.h"
 
 #include "packet.h"
 
+#include <array>
+
 class CInstanceBase;
 class CNetworkActorManager;
 struct SNetworkActorData;
@@ -297,6 +299,8 @@ class CPythonNetworkStream : public CNetworkStream, public CSingleton<CPythonNet
 		void SetGamePhase();
 		void ClosePhase();
 
+		const CNetworkDispatchBudget::TStat & GetDispatchStat() const;
+
 		// Login Phase
 		bool SendLoginPacket(const char * c_szName, const char * c_szPassword);
 		bool SendLoginPacketNew(const char * c_szName, const char * c_szPassword);
@@ -571,8 +575,33 @@ class CPythonNetworkStream : public CNetworkStream, public CSingleton<CPythonNet
 		void SetGameOffline();
 		BOOL IsGameOnline();
 
+	protected:
+		typedef bool (CPythonNetworkStream::*TRecvFunction)();
+
+		typedef struct SPacketDesc
+		{
+			uint16_t		wSize;					// 0 for the headers the server never sends
+			bool			isDynamicSize;
+			bool			isLeavingGamePhase;		// the game phase returns right after it, the phase may have changed
+			TRecvFunction	pfnGameRecv;			// NULL goes to RecvDefaultPacket in the game phase
+		} TPacketDesc;
+
+		typedef struct SPacketEntry
+		{
+			TPacketHeader	header;
+			TPacketDesc		kDesc;
+		} TPacketEntry;
+
+		template <typename TPacket, bool isDynamicSize>
+		static constexpr TPacketDesc __MakePacketDesc(TRecvFunction pfnGameRecv = NULL, bool isLeavingGamePhase = false);
+		static constexpr std::array<TPacketDesc, 256> __BuildPacketDescTable();
+
+		// indexed by the header, built at compile time
+		static const std::array<TPacketDesc, 256> ms_kArr_kPacketDesc;
+
 	protected:
 		bool CheckPacket(TPacketHeader * pRetHeader);
+		const char * __GetPhaseName() const;
 		
 		void __InitializeGamePhase();
 		void __InitializeMarkAuth();
@@ -639,7 +668,7 @@ class CPythonNetworkStream : public CNetworkStream, public CSingleton<CPythonNet
 		std::string	m_stID;
 		std::string	m_stPassword;
 		std::string	m_strLastCommand;
-		std::string	m_strPhase;
+		EPhase		m_ePhase;			// PHASE_CLOSE while offline
 		DWORD m_dwLoginKey;
 		BOOL m_isWaitLoginKey;
 
@@ -648,6 +677,8 @@ class CPythonNetworkStream : public CNetworkStream, public CSingleton<CPythonNet
 		CFuncObject<CPythonNetworkStream>	m_phaseProcessFunc;
 		CFuncObject<CPythonNetworkStream>	m_phaseLeaveFunc;
 
+		CNetworkDispatchBudget				m_kDispatchBudget;
+
 		PyObject*							m_poHandler;
 		PyObject*							m_apoPhaseWnd[PHASE_WINDOW_NUM];
 		PyObject*							m_poSerCommandParserWnd;
@@ -1,5 +1,6 @@
 #include "StdAfx.h"
 #include "PythonNetworkStream.h"
+#include "EterLib/NetReactor.h"
 //#include "PythonNetworkDatagram.h"
 #include "AccountConnector.h"
 #include "PythonGuild.h"
@@ -142,6 +143,30 @@ PyObject* netGetMainActorRace(PyObject* poSelf, PyObject* poArgs)
 	return Py_BuildValue("i", rkNetStream.GetMainActorRace());
 }
 
+// (frames, packets, cut frames, backlog bytes, max backlog bytes, behind ms, max behind ms, last dispatch us, max dispatch us)
+PyObject* netGetDispatchStat(PyObject* poSelf, PyObject* poArgs)
+{
+	const CNetworkDispatchBudget::TStat & c_rkStat = CPythonNetworkStream::Instance().GetDispatchStat();
+	return Py_BuildValue("(iiiiiiiii)", c_rkStat.dwFrameCount, c_rkStat.dwPacketCount, c_rkStat.dwCutFrameCount,
+		c_rkStat.dwBacklogSize, c_rkStat.dwMaxBacklogSize, c_rkStat.dwLatency, c_rkStat.dwMaxLatency,
+		c_rkStat.dwLastDispatchTime, c_rkStat.dwMaxDispatchTime);
+}
+
+PyObject* netGetSendStat(PyObject* poSelf, PyObject* poArgs)
+{
+	const CNetworkStream::TSendStat & c_rkStat = CPythonNetworkStream::Instance().GetSendStat();
+	return Py_BuildValue("(iiiiiLii)", c_rkStat.dwFrameCount, c_rkStat.dwSendCount, c_rkStat.dwLastFrameSendCount,
+		c_rkStat.dwMaxFrameSendCount, c_rkStat.dwWouldBlockCount, c_rkStat.ullSendSize, c_rkStat.dwLastSendSize,
+		c_rkStat.dwMaxSendSize);
+}
+
+PyObject* netGetReactorStat(PyObject* poSelf, PyObject* poArgs)
+{
+	const CNetworkReactor::TStat & c_rkStat = CNetworkReactor::Instance().GetStat();
+	return Py_BuildValue("(iiiiii)", c_rkStat.dwFrameCount, c_rkStat.dwPollCount, c_rkStat.dwSelfPollCount,
+		c_rkStat.dwLastFramePollCount, c_rkStat.dwMaxFramePollCount, c_rkStat.dwStreamCount);
+}
+
 PyObject* netGetMainActorEmpire(PyObject* poSelf, PyObject* poArgs)
 {
 	CPythonNetworkStream& rkNetStream=CPythonNetworkStream::Instance();
@@ -1721,6 +1746,9 @@ void initnet()
 		{ "GetEmpireID",						netGetEmpireID,							METH_VARARGS },
 		{ "GetMainActorVID",					netGetMainActorVID,						METH_VARARGS },
 		{ "GetMainActorRace",					netGetMainActorRace,					METH_VARARGS },
+		{ "GetDispatchStat",					netGetDispatchStat,						METH_VARARGS },
+		{ "GetSendStat",						netGetSendStat,							METH_VARARGS },
+		{ "GetReactorStat",						netGetReactorStat,						METH_VARARGS },
 		{ "GetMainActorEmpire",					netGetMainActorEmpire,					METH_VARARGS },
 		{ "GetMainActorSkillGroup",				netGetMainActorSkillGroup,				METH_VARARGS },
 		{ "GetAccountCharacterSlotDataInteger",	netGetAccountCharacterSlotDataInteger,	METH_VARARGS },
@@ -1,6 +1,7 @@
 #include "StdAfx.h"
 #include "PythonNetworkStream.h"
 #include "Packet.h"
+#include "EterBase/TimeProfiler.h"
 
 #include "PythonGuild.h"
 #include "PythonCharacterManager.h"
@@ -204,427 +205,44 @@ void CPythonNetworkStream::GamePhase()
 	kMap_kPacketInfo.clear();
 #endif
 
-	const DWORD MAX_RECV_COUNT = 4;
-	const DWORD SAFE_RECV_BUFSIZE = 8192;
-	DWORD dwRecvCount = 0;
+	// LoadingPhase hands the headers it doesn't know over to here, only the game phase itself is budgeted
+	bool isBudgeted = PHASE_GAME == m_ePhase;
+	if (isBudgeted)
+		m_kDispatchBudget.BeginFrame(GetRecvBufferSize());
 
     while (ret)
 	{
-		if(dwRecvCount++ >= MAX_RECV_COUNT-1 && GetRecvBufferSize() < SAFE_RECV_BUFSIZE
-			&& m_strPhase == "Game") //phase_game 이 아니어도 여기로 들어오는 경우가 있다.
+		if (isBudgeted && !m_kDispatchBudget.CanDispatch())
 			break;
 
 		if (!CheckPacket(&header))
 			break;
 
+		if (isBudgeted)
+			m_kDispatchBudget.OnDispatch();
+
 #ifdef __PERFORMANCE_CHECK__
 		DWORD timeBeginPacket=timeGetTime();
 #endif
 
-		switch (header)
-		{
-			case HEADER_GC_OBSERVER_ADD:
-				ret = RecvObserverAddPacket();
-				break;
-			case HEADER_GC_OBSERVER_REMOVE:
-				ret = RecvObserverRemovePacket();
-				break;
-			case HEADER_GC_OBSERVER_MOVE:
-				ret = RecvObserverMovePacket();
-				break;
-			case HEADER_GC_WARP:
-				ret = RecvWarpPacket();
-				break;
-
-			case HEADER_GC_PHASE:
-				ret = RecvPhasePacket();
-				return; // 도중에 Phase 가 바뀌면 일단 무조건 GamePhase 탈출 - [levites]
-				break;
-
-			case HEADER_GC_PVP:
-				ret = RecvPVPPacket();
-				break;
-
-			case HEADER_GC_DUEL_START:
-				ret = RecvDuelStartPacket();
-				break;
-
-			case HEADER_GC_CHARACTER_ADD:
- 				ret = RecvCharacterAppendPacket();
-				break;
-
-			case HEADER_GC_CHAR_ADDITIONAL_INFO:
-				ret = RecvCharacterAdditionalInfo();
-				break;
-
-			case HEADER_GC_CHARACTER_ADD2:
-				ret = RecvCharacterAppendPacketNew();
-				break;
-
-			case HEADER_GC_CHARACTER_UPDATE:
-				ret = RecvCharacterUpdatePacket();
-				break;
-
-			case HEADER_GC_CHARACTER_UPDATE2:
-				ret = RecvCharacterUpdatePacketNew();
-				break;
-
-			case HEADER_GC_CHARACTER_DEL:
-				ret = RecvCharacterDeletePacket();
-				break;
-
-			case HEADER_GC_CHAT:
-				ret = RecvChatPacket();
-				break;
+		const TPacketDesc & c_rkDesc = ms_kArr_kPacketDesc[header];
 
-			case HEADER_GC_SYNC_POSITION:
-				ret = RecvSyncPositionPacket();
-				break;
-
-			case HEADER_GC_OWNERSHIP:
-				ret = RecvOwnerShipPacket();
-				break;
-
-			case HEADER_GC_WHISPER:
-				ret = RecvWhisperPacket();
-				break;
-
-			case HEADER_GC_CHARACTER_MOVE:
-				ret = RecvCharacterMovePacket();
-				break;
-
-			// Position
-			case HEADER_GC_CHARACTER_POSITION:
-				ret = RecvCharacterPositionPacket();
-				break;
-
-			// Battle Packet
-			case HEADER_GC_STUN:
-				ret = RecvStunPacket();
-				break;
-
-			case HEADER_GC_DEAD:
-				ret = RecvDeadPacket();
-				break;
-
-			case HEADER_GC_PLAYER_POINT_CHANGE:
-				ret = RecvPointChange();
-				break;
-
-			// item packet.
-			case HEADER_GC_ITEM_DEL:
-				ret = RecvItemDelPacket();
-				break;
-
-			case HEADER_GC_ITEM_SET:
-				ret = RecvItemSetPacket();
-				break;
-
-			case HEADER_GC_ITEM_USE:
-				ret = RecvItemUsePacket();
-				break;
-
-			case HEADER_GC_ITEM_UPDATE:
-				ret = RecvItemUpdatePacket();
-				break;
-
-			case HEADER_GC_ITEM_GROUND_ADD:
-				ret = RecvItemGroundAddPacket();
-				break;
-
-			case HEADER_GC_ITEM_GROUND_DEL:
-				ret = RecvItemGroundDelPacket();
-				break;
-
-			case HEADER_GC_ITEM_OWNERSHIP:
-				ret = RecvItemOwnership();
-				break;
-
-			case HEADER_GC_QUICKSLOT_ADD:
-				ret = RecvQuickSlotAddPacket();
-				break;
-
-			case HEADER_GC_QUICKSLOT_DEL:
-				ret = RecvQuickSlotDelPacket();
-				break;
-
-			case HEADER_GC_QUICKSLOT_SWAP:
-				ret = RecvQuickSlotMovePacket();
-				break;
-
-			case HEADER_GC_MOTION:
-				ret = RecvMotionPacket();
-				break;
-
-			case HEADER_GC_SHOP:
-				ret = RecvShopPacket();
-				break;
-				
-			case HEADER_GC_SHOP_SIGN:
-				ret = RecvShopSignPacket();
-				break;
-
-			case HEADER_GC_EXCHANGE:
-				ret = RecvExchangePacket();
-				break;
-
-			case HEADER_GC_QUEST_INFO:
-				ret = RecvQuestInfoPacket();
-				break;
-
-			case HEADER_GC_REQUEST_MAKE_GUILD:
-				ret = RecvRequestMakeGuild();
-				break;
-
-			case HEADER_GC_PING:
-				ret = RecvPingPacket();
-				break;
-
-			case HEADER_GC_SCRIPT:
-				ret = RecvScriptPacket();
-				break;
-
-			case HEADER_GC_QUEST_CONFIRM:
-				ret = RecvQuestConfirmPacket();
-				break;
-
-			case HEADER_GC_TARGET:
-				ret = RecvTargetPacket();
-				break;
-
-			case HEADER_GC_DAMAGE_INFO:
-				ret = RecvDamageInfoPacket();
-				break;
-
-			case HEADER_GC_MOUNT:
-				ret = RecvMountPacket();
-				break;
-
-			case HEADER_GC_CHANGE_SPEED:
-				ret = RecvChangeSpeedPacket();
-				break;
-
-			case HEADER_GC_PLAYER_POINTS:
-				ret = __RecvPlayerPoints();
-				break;
-
-			case HEADER_GC_CREATE_FLY:
-				ret = RecvCreateFlyPacket();
-				break;
-
-			case HEADER_GC_FLY_TARGETING:
-				ret = RecvFlyTargetingPacket();
-				break;
-
-			case HEADER_GC_ADD_FLY_TARGETING:
-				ret = RecvAddFlyTargetingPacket();
-				break;
-
-			case HEADER_GC_SKILL_LEVEL:
-				ret = RecvSkillLevel();
-				break;
-
-			case HEADER_GC_SKILL_LEVEL_NEW:
-				ret = RecvSkillLevelNew();
-				break;
-
-			case HEADER_GC_MESSENGER:
-				ret = RecvMessenger();
-				break;
-
-			case HEADER_GC_GUILD:
-				ret = RecvGuild();
-				break;
-
-			case HEADER_GC_PARTY_INVITE:
-				ret = RecvPartyInvite();
-				break;
-
-			case HEADER_GC_PARTY_ADD:
-				ret = RecvPartyAdd();
-				break;
-
-			case HEADER_GC_PARTY_UPDATE:
-				ret = RecvPartyUpdate();
-				break;
-
-			case HEADER_GC_PARTY_REMOVE:
-				ret = RecvPartyRemove();
-				break;
-
-			case HEADER_GC_PARTY_LINK:
-				ret = RecvPartyLink();
-				break;
-
-			case HEADER_GC_PARTY_UNLINK:
-				ret = RecvPartyUnlink();
-				break;
-
-			case HEADER_GC_PARTY_PARAMETER:
-				ret = RecvPartyParameter();
-				break;
-
-			case HEADER_GC_SAFEBOX_SET:
-				ret = RecvSafeBoxSetPacket();
-				break;
-
-			case HEADER_GC_SAFEBOX_DEL:
-				ret = RecvSafeBoxDelPacket();
-				break;
-
-			case HEADER_GC_SAFEBOX_WRONG_PASSWORD:
-				ret = RecvSafeBoxWrongPasswordPacket();
-				break;
-
-			case HEADER_GC_SAFEBOX_SIZE:
-				ret = RecvSafeBoxSizePacket();
-				break;
-
-			case HEADER_GC_SAFEBOX_MONEY_CHANGE:
-				ret = RecvSafeBoxMoneyChangePacket();
-				break;
-
-			case HEADER_GC_FISHING:
-				ret = RecvFishing();
-				break;
-
-			case HEADER_GC_DUNGEON:
-				ret = RecvDungeon();
-				break;
-
-			case HEADER_GC_TIME:
-				ret = RecvTimePacket();
-				break;
-
-			case HEADER_GC_WALK_MODE:
-				ret = RecvWalkModePacket();
-				break;
-
-			case HEADER_GC_CHANGE_SKILL_GROUP:
-				ret = RecvChangeSkillGroupPacket();
-				break;
-
-			case HEADER_GC_REFINE_INFORMATION:
-				ret = RecvRefineInformationPacket();
-				break;
-
-			case HEADER_GC_REFINE_INFORMATION_NEW:
-				ret = RecvRefineInformationPacketNew();
-				break;
-
-			case HEADER_GC_SEPCIAL_EFFECT:
-				ret = RecvSpecialEffect();
-				break;
-
-			case HEADER_GC_NPC_POSITION:
-				ret = RecvNPCList();
-				break;
-
-			case HEADER_GC_CHANNEL:
-				ret = RecvChannelPacket();
-				break;
-
-			case HEADER_GC_VIEW_EQUIP:
-				ret = RecvViewEquipPacket();
-				break;
-
-			case HEADER_GC_LAND_LIST:
-				ret = RecvLandPacket();
-				break;
-
-			//case HEADER_GC_TARGET_CREATE:
-			//	ret = RecvTargetCreatePacket();
-			//	break;
-
-			case HEADER_GC_TARGET_CREATE_NEW:
-				ret = RecvTargetCreatePacketNew();
-				break;
-
-			case HEADER_GC_TARGET_UPDATE:
-				ret = RecvTargetUpdatePacket();
-				break;
-
-			case HEADER_GC_TARGET_DELETE:
-				ret = RecvTargetDeletePacket();
-				break;
-
-			case HEADER_GC_AFFECT_ADD:
-				ret = RecvAffectAddPacket();
-				break;
-
-			case HEADER_GC_AFFECT_REMOVE:
-				ret = RecvAffectRemovePacket();
-				break;
-
-			case HEADER_GC_MALL_OPEN:
-				ret = RecvMallOpenPacket();
-				break;
-
-			case HEADER_GC_MALL_SET:
-				ret = RecvMallItemSetPacket();
-				break;
-
-			case HEADER_GC_MALL_DEL:
-				ret = RecvMallItemDelPacket();
-				break;
-
-			case HEADER_GC_LOVER_INFO:
-				ret = RecvLoverInfoPacket();
-				break;
-
-			case HEADER_GC_LOVE_POINT_UPDATE:
-				ret = RecvLovePointUpdatePacket();
-				break;
-
-			case HEADER_GC_DIG_MOTION:
-				ret = RecvDigMotionPacket();
-				break;
-
-			case HEADER_GC_HANDSHAKE:
-				RecvHandshakePacket();
-				return;
-				break;
-
-			case HEADER_GC_HANDSHAKE_OK:
-				RecvHandshakeOKPacket();
-				return;
-				break;
-			
-			case HEADER_GC_HYBRIDCRYPT_KEYS:
-				RecvHybridCryptKeyPacket();
-				return;
-				break;
-
-			case HEADER_GC_HYBRIDCRYPT_SDB:
-				RecvHybridCryptSDBPacket();
-				return;
-				break;
-
-
-#ifdef _IMPROVED_PACKET_ENCRYPTION_
-			case HEADER_GC_KEY_AGREEMENT:
-				RecvKeyAgreementPacket();
-				return;
-				break;
-
-			case HEADER_GC_KEY_AGREEMENT_COMPLETED:
-				RecvKeyAgreementCompletedPacket();
-				return;
-				break;
-#endif
+		if (c_rkDesc.isLeavingGamePhase)
+		{
+			// closed before the handler, which may enter the game phase anew and reset the budget
+			if (isBudgeted)
+				m_kDispatchBudget.EndFrame(GetRecvBufferSize());
 
-			case HEADER_GC_SPECIFIC_EFFECT:
-				ret = RecvSpecificEffect();
-				break;
+			// the phase may be another one now, whatever follows isn't for the game phase any more
+			(this->*c_rkDesc.pfnGameRecv)();
+			return;
+		}
 
-			case HEADER_GC_DRAGON_SOUL_REFINE:
-				ret = RecvDragonSoulRefine();
-				break;
+		if (c_rkDesc.pfnGameRecv)
+			ret = (this->*c_rkDesc.pfnGameRecv)();
+		else
+			ret = RecvDefaultPacket(header);
 
-			default:
-				ret = RecvDefaultPacket(header);
-				break;
-		}
 #ifdef __PERFORMANCE_CHECK__
 		DWORD timeEndPacket=timeGetTime();
 
@@ -642,6 +260,9 @@ void CPythonNetworkStream::GamePhase()
 #endif
 	}
 
+	if (isBudgeted)
+		m_kDispatchBudget.EndFrame(GetRecvBufferSize());
+
 #ifdef __PERFORMANCE_CHECK__
 	DWORD timeEndDispatch=timeGetTime();
 	
@@ -848,14 +469,23 @@ void CPythonNetworkStream::__LeaveGamePhase()
 
 void CPythonNetworkStream::SetGamePhase()
 {
-	if ("Game"!=m_strPhase)
+	if (PHASE_GAME != m_ePhase)
 		m_phaseLeaveFunc.Run();
 
 	Tracen("");
 	Tracen("## Network - Game Phase ##");
 	Tracen("");
 
-	m_strPhase = "Game";
+	m_ePhase = PHASE_GAME;
+	m_kDispatchBudget.Reset();
+
+	// the boot ends with the first map the player stands on, later loads would only bury it
+	if (CTimeProfiler::IsRecording())
+	{
+		CTimeProfiler::Stop();
+		CTimeProfiler::SaveChromeTrace("log/boot_trace.json");
+		CTimeProfiler::TraceSummary(5, 3);
+	}
 
 	m_dwChangingPhaseTime = ELTimer_GetMSec();
 	m_phaseProcessFunc.Set(this, &CPythonNetworkStream::GamePhase);
@@ -90,14 +90,14 @@ void CPythonNetworkStream::HandShakePhase()
 
 void CPythonNetworkStream::SetHandShakePhase()
 {
-	if ("HandShake"!=m_strPhase)
+	if (PHASE_HANDSHAKE != m_ePhase)
 		m_phaseLeaveFunc.Run();
 
 	Tracen("");
 	Tracen("## Network - Hand Shake Phase ##");
 	Tracen("");
 
-	m_strPhase = "HandShake";
+	m_ePhase = PHASE_HANDSHAKE;
 
 	m_dwChangingPhaseTime = ELTimer_GetMSec();
 	m_phaseProcessFunc.Set(this, &CPythonNetworkStream::HandShakePhase);
@@ -164,14 +164,14 @@ void CPythonNetworkStream::LoadingPhase()
 
 void CPythonNetworkStream::SetLoadingPhase()
 {
-	if ("Loading"!=m_strPhase)
+	if (PHASE_LOADING != m_ePhase)
 		m_phaseLeaveFunc.Run();
 
 	Tracen("");
 	Tracen("## Network - Loading Phase ##");
 	Tracen("");
 
-	m_strPhase = "Loading";	
+	m_ePhase = PHASE_LOADING;	
 
 	m_dwChangingPhaseTime = ELTimer_GetMSec();
 	m_phaseProcessFunc.Set(this, &CPythonNetworkStream::LoadingPhase);
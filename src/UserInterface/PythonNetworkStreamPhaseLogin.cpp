@@ -85,14 +85,14 @@ void CPythonNetworkStream::SetLoginPhase()
 	SetSecurityMode(true, key);
 #endif
 
-	if ("Login" != m_strPhase)
+	if (PHASE_LOGIN != m_ePhase)
 		m_phaseLeaveFunc.Run();
 
 	Tracen("");
 	Tracen("## Network - Login Phase ##");
 	Tracen("");
 
-	m_strPhase = "Login";	
+	m_ePhase = PHASE_LOGIN;	
 
 	m_phaseProcessFunc.Set(this, &CPythonNetworkStream::LoginPhase);
 	m_phaseLeaveFunc.Set(this, &CPythonNetworkStream::__LeaveLoginPhase);
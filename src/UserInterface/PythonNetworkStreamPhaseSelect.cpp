@@ -8,14 +8,14 @@ extern DWORD g_adwDecryptKey[4];
 // Select Character ---------------------------------------------------------------------------
 void CPythonNetworkStream::SetSelectPhase()
 {
-	if ("Select" != m_strPhase)
+	if (PHASE_SELECT != m_ePhase)
 		m_phaseLeaveFunc.Run();
 
 	Tracen("");
 	Tracen("## Network - Select Phase ##");
 	Tracen("");
 
-	m_strPhase = "Select";	
+	m_ePhase = PHASE_SELECT;	
 
 #ifndef _IMPROVED_PACKET_ENCRYPTION_
 	SetSecurityMode(true, (const char *) g_adwEncryptKey, (const char *) g_adwDecryptKey);
@@ -22,48 +22,43 @@ bool CPythonNonPlayer::LoadNonPlayerData(const char * c_szFileName)
 	if (!CPackManager::Instance().GetFile(c_szFileName, file))
 		return false;
 
-	DWORD dwFourCC, dwElements, dwDataSize;
-	memcpy(&dwFourCC, file.data(), sizeof(DWORD));
-
-	if (dwFourCC != MAKEFOURCC('M', 'M', 'P', 'T'))
+	// only runs when the cache file is missing or stale, the rows are read back from it otherwise
+	auto fnDecode = [c_szFileName](const BYTE * c_pbSource, DWORD dwSourceSize, std::vector<BYTE> & rvecRows)
 	{
-		TraceError("CPythonNonPlayer::LoadNonPlayerData: invalid Mob proto type %s", c_szFileName);
-		return false;
-	}
+		DWORD dwFourCC, dwElements;
 
-	memcpy(&dwElements, file.data() + sizeof(DWORD), sizeof(DWORD));
-	memcpy(&dwDataSize, file.data() + sizeof(DWORD) * 2, sizeof(DWORD));
+		if (dwSourceSize < sizeof(DWORD) * 3)
+			return false;
 
-	BYTE * pbData = new BYTE[dwDataSize];
-	memcpy(pbData, file.data() + sizeof(DWORD) * 3, dwDataSize);
-	/////
+		memcpy(&dwFourCC, c_pbSource, sizeof(DWORD));
 
-	CLZObject zObj;
+		if (dwFourCC != MAKEFOURCC('M', 'M', 'P', 'T'))
+		{
+			TraceError("CPythonNonPlayer::LoadNonPlayerData: invalid Mob proto type %s", c_szFileName);
+			return false;
+		}
 
-	if (!CLZO::Instance().Decompress(zObj, pbData, s_adwMobProtoKey))
-	{
-		delete [] pbData;
-		return false;
-	}
+		memcpy(&dwElements, c_pbSource + sizeof(DWORD), sizeof(DWORD));
 
-	if ((zObj.GetSize() % sizeof(TMobTable)) != 0)
-	{
-		TraceError("CPythonNonPlayer::LoadNonPlayerData: invalid size %u check data format.", zObj.GetSize());
-		return false;
-	}
+		CLZObject zObj;
 
-	TMobTable * pTable = (TMobTable *) zObj.GetBuffer();
-    for (DWORD i = 0; i < dwElements; ++i, ++pTable)
-	{
-		TMobTable * pNonPlayerData = new TMobTable;
+		if (!CLZO::Instance().Decompress(zObj, c_pbSource + sizeof(DWORD) * 3, s_adwMobProtoKey))
+			return false;
 
-		memcpy(pNonPlayerData, pTable, sizeof(TMobTable));
+		if ((zObj.GetSize() % sizeof(TMobTable)) != 0 || zObj.GetSize() < dwElements * sizeof(TMobTable))
+		{
+			TraceError("CPythonNonPlayer::LoadNonPlayerData: invalid size %u check data format.", zObj.GetSize());
+			return false;
+		}
 
-		//TraceError("%d : %s type[%d] color[%d]", pNonPlayerData->dwVnum, pNonPlayerData->szLocaleName, pNonPlayerData->bType, pNonPlayerData->dwMonsterColor);
-		m_NonPlayerDataMap.insert(TNonPlayerDataMap::value_type(pNonPlayerData->dwVnum, pNonPlayerData));
-	}
+		rvecRows.assign(zObj.GetBuffer(), zObj.GetBuffer() + dwElements * sizeof(TMobTable));
+		return true;
+	};
 
-	delete [] pbData;
+	if (!m_kMobProto.Load(c_szFileName, file.data(), file.size(), sizeof(TMobTable), s_adwMobProtoKey, fnDecode))
+		return false;
+
+	Tracef("CPythonNonPlayer::LoadNonPlayerData: %u mobs\n", m_kMobProto.GetCount());
 	return true;
 }
 
@@ -94,12 +89,7 @@ bool CPythonNonPlayer::GetInstanceType(DWORD dwVnum, BYTE* pbType)
 
 const CPythonNonPlayer::TMobTable * CPythonNonPlayer::GetTable(DWORD dwVnum)
 {
-	TNonPlayerDataMap::iterator itor = m_NonPlayerDataMap.find(dwVnum);
-
-	if (itor == m_NonPlayerDataMap.end())
-		return NULL;
-
-	return itor->second;
+	return (const TMobTable *) m_kMobProto.Find(dwVnum);
 }
 
 BYTE CPythonNonPlayer::GetEventType(DWORD dwVnum)
@@ -178,11 +168,7 @@ void CPythonNonPlayer::Clear()
 
 void CPythonNonPlayer::Destroy()
 {
-	for (TNonPlayerDataMap::iterator itor=m_NonPlayerDataMap.begin(); itor!=m_NonPlayerDataMap.end(); ++itor)
-	{
-		delete itor->second;
-	}
-	m_NonPlayerDataMap.clear();
+	m_kMobProto.Destroy();
 }
 
 CPythonNonPlayer::CPythonNonPlayer()
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "EterBase/ProtoCache.h"
+
 /*
  *	NPC 데이터 프로토 타잎을 관리 한다.
  */
@@ -115,7 +117,6 @@ class CPythonNonPlayer : public CSingleton<CPythonNonPlayer>
 #pragma pack(pop)
 
 		typedef std::list<TMobTable *> TMobTableList;
-		typedef std::map<DWORD, TMobTable *> TNonPlayerDataMap;
 
 	public:
 		CPythonNonPlayer(void);
@@ -138,5 +139,5 @@ class CPythonNonPlayer : public CSingleton<CPythonNonPlayer>
 		void				GetMatchableMobList(int iLevel, int iInterval, TMobTableList * pMobTableList);
 
 	protected:
-		TNonPlayerDataMap	m_NonPlayerDataMap;
+		CProtoCache			m_kMobProto;	// rows sorted by vnum, read from the proto cache file
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "StdAfx.h"
 #include "EterLib/Profiler.h"
+#include "EterBase/TimeProfiler.h"
 
 PyObject * profilerPush(PyObject * poSelf, PyObject * poArgs)
 {
@@ -7,6 +8,8 @@ PyObject * profilerPush(PyObject * poSelf, PyObject * poArgs)
 	if (!PyTuple_GetString(poArgs, 0, &szName))
 		return Py_BuildException();
 
+	// scripts mark their share of the boot with Push/Pop pairs
+	CTimeProfiler::Begin(szName);
 	return Py_BuildNone();
 }
 
@@ -16,6 +19,7 @@ PyObject * profilerPop(PyObject * poSelf, PyObject * poArgs)
 	if (!PyTuple_GetString(poArgs, 0, &szName))
 		return Py_BuildException();
 
+	CTimeProfiler::End();
 	return Py_BuildNone();
 }
 
@@ -424,8 +424,8 @@ bool CPythonSystem::LoadConfig()
 			m_Config.isSaveID = atoi(value);
 		else if (!stricmp(command, "SAVE_ID"))
 			strncpy(m_Config.SaveID, value, 20);
-		else if (!stricmp(command, "PRE_LOADING_DELAY_TIME"))
-			g_iLoadingDelayTime = atoi(value);
+		else if (!stricmp(command, "RESOURCE_MEMORY_BUDGET"))
+			g_iResourceMemoryBudget = atoi(value);
 		else if (!stricmp(command, "WINDOWED"))
 		{
 			m_Config.bWindowed = atoi(value) == 1 ? true : false;
@@ -473,6 +473,8 @@ bool CPythonSystem::LoadConfig()
 	
 	m_OldConfig = m_Config;
 
+	CResourceManager::Instance().SetMemoryBudget(size_t(std::max(0, g_iResourceMemoryBudget)) * 1024 * 1024);
+
 	fclose(fp);
 
 //	Tracef("LoadConfig: Resolution: %dx%d %dBPP %dHZ Software Cursor: %d, Music/Voice Volume: %d/%d Gamma: %d\n",
@@ -507,7 +509,6 @@ bool CPythonSystem::SaveConfig()
 				"GAMMA						%d\n"
 				"IS_SAVE_ID					%d\n"
 				"SAVE_ID					%s\n"
-				"PRE_LOADING_DELAY_TIME		%d\n"
 				"DECOMPRESSED_TEXTURE		%d\n",
 				m_Config.width,
 				m_Config.height,
@@ -521,7 +522,6 @@ bool CPythonSystem::SaveConfig()
 				m_Config.gamma,
 				m_Config.isSaveID,
 				m_Config.SaveID,
-				g_iLoadingDelayTime,
 				m_Config.bDecompressDDS);
 
 	if (m_Config.bWindowed == 1)
@@ -538,6 +538,7 @@ bool CPythonSystem::SaveConfig()
 	fprintf(fp, "USE_DEFAULT_IME		%d\n", m_Config.bUseDefaultIME);
 	fprintf(fp, "SOFTWARE_TILING		%d\n", m_Config.bSoftwareTiling);
 	fprintf(fp, "SHADOW_LEVEL			%d\n", m_Config.iShadowLevel);
+	fprintf(fp, "RESOURCE_MEMORY_BUDGET	%d\n", g_iResourceMemoryBudget);
 	fprintf(fp, "\n");
 
 	fclose(fp);
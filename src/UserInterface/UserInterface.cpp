@@ -11,6 +11,7 @@
 
 #include "eterLib/Util.h"
 #include "EterBase/lzo.h"
+#include "EterBase/TimeProfiler.h"
 
 #include "PackLib/PackManager.h"
 #include <filesystem>
@@ -250,9 +251,22 @@ bool PackInitialize(const char * c_pszFolder)
 		"uiloading",
 	};
 
-	CPackManager::instance().AddPack(std::format("{}/root.pck", c_pszFolder));
+	TIME_PROFILE_SCOPE("PackInitialize");
+
+	// a missing locale pack is normal, one that is there but can't be read (left from an older build) is not
+	auto AddPack = [](const std::string& path) {
+		std::string error;
+		if (!CPackManager::instance().AddPack(path, &error) && std::filesystem::exists(path))
+			TraceError("Pack %s rejected: %s", path.c_str(), error.c_str());
+	};
+
+	{
+		TIME_PROFILE_SCOPE("CPackManager::AddPack", "root");
+		AddPack(std::format("{}/root.pck", c_pszFolder));
+	}
 	for (const std::string& packFileName : packFiles) {
-		CPackManager::instance().AddPack(std::format("{}/{}.pck", c_pszFolder, packFileName));
+		TIME_PROFILE_SCOPE("CPackManager::AddPack", packFileName.c_str());
+		AddPack(std::format("{}/{}.pck", c_pszFolder, packFileName));
 	}
 
 	NANOEND
@@ -261,6 +275,8 @@ bool PackInitialize(const char * c_pszFolder)
 
 bool RunMainScript(CPythonLauncher& pyLauncher, const char* lpCmdLine)
 {
+	CTimeProfiler::Begin("RunMainScript::InitModules");
+
 	initpack();
 	initdbg();
 	initime();
@@ -297,6 +313,8 @@ bool RunMainScript(CPythonLauncher& pyLauncher, const char* lpCmdLine)
 	initguild();
 	initServerStateChecker();
 
+	CTimeProfiler::End();
+
 	NANOBEGIN
 
 	// RegisterDebugFlag
@@ -363,6 +381,9 @@ bool RunMainScript(CPythonLauncher& pyLauncher, const char* lpCmdLine)
 		{
 			system("pause");
 		}
+		// runs until the client quits, the profiler closes this span when it stops after the first map
+		TIME_PROFILE_SCOPE("system.py");
+
 		if (!pyLauncher.RunFile("system.py"))
 		{
 			TraceError("RunMain Error");
@@ -387,6 +408,10 @@ bool Main(HINSTANCE hInstance, LPSTR lpCmdLine)
 
 	SetLogLevel(1);
 
+	// the boot timeline, saved once the player enters the game (CPythonNetworkStream::SetGamePhase)
+	CTimeProfiler::Start();
+	CTimeProfiler::SetThreadName("main");
+
 #ifdef LOCALE_SERVICE_VIETNAM_MILD
 	extern BOOL USE_VIETNAM_CONVERT_WEAPON_VNUM;
 	USE_VIETNAM_CONVERT_WEAPON_VNUM = true;
@@ -403,8 +428,12 @@ bool Main(HINSTANCE hInstance, LPSTR lpCmdLine)
 		return false;
 	}
 
-	if (!Setup(lpCmdLine))
-		return false;
+	{
+		TIME_PROFILE_SCOPE("Setup");
+
+		if (!Setup(lpCmdLine))
+			return false;
+	}
 
 #ifdef _DEBUG
 	OpenConsoleWindow();
@@ -422,12 +451,22 @@ bool Main(HINSTANCE hInstance, LPSTR lpCmdLine)
 		return false;
 	}
 
+#ifndef _DISTRIBUTE
+	// loose files in "overlay" replace their pack entries and are reloaded when edited
+	packMgr.SetOverlay("overlay", true);
+#endif
+
+	packMgr.StartAsyncLoading(std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u));
+
 	// Locale is already loaded in ApplicationStringTable_Initialize via LocaleService_LoadConfig
 	// No need to call LocaleService_LoadGlobal which shows locale selection dialog
 
 	CPythonApplication * app = new CPythonApplication;
 
-	app->Initialize(hInstance);
+	{
+		TIME_PROFILE_SCOPE("CPythonApplication::Initialize");
+		app->Initialize(hInstance);
+	}
 
 	bool ret=false;
 	{
@@ -435,7 +474,13 @@ bool Main(HINSTANCE hInstance, LPSTR lpCmdLine)
 		CPythonExceptionSender pyExceptionSender;
 		SetExceptionSender(&pyExceptionSender);
 
-		if (pyLauncher.Create())
+		bool bCreated;
+		{
+			TIME_PROFILE_SCOPE("CPythonLauncher::Create");
+			bCreated = pyLauncher.Create();
+		}
+
+		if (bCreated)
 		{
 			ret=RunMainScript(pyLauncher, lpCmdLine);	//게임 실행중엔 함수가 끝나지 않는다.
 		}
@@ -449,6 +494,8 @@ bool Main(HINSTANCE hInstance, LPSTR lpCmdLine)
 		pyLauncher.Clear();
 	}
 
+	packMgr.StopAsyncLoading();
+
 	app->Destroy();
 	delete app;
 	